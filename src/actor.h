@@ -614,6 +614,17 @@ struct FLinkContext
 	msecnode_t *render_list = nullptr;
 };
 
+// Sector and subsector for the position an actor is expected to be linked at
+// during the current tic. Filled in by the parallel pre-pass in P_Ticker and
+// only trusted by LinkToWorld if the generation and position match exactly.
+struct FLinkPrediction
+{
+	DVector2 Pos = { 0, 0 };
+	sector_t *Sector = nullptr;
+	subsector_t *Subsector = nullptr;
+	int Generation = 0;		// 0 never matches P_LinkPredictionGeneration
+};
+
 struct FDropItem
 {
 	FDropItem *Next;
@@ -624,6 +635,10 @@ struct FDropItem
 
 const double MinVel = EQUAL_EPSILON;
 
+// Incremental state hash, see p_statehash.cpp
+extern int P_StateHashStamp;
+void P_StateHashTouch(AActor *actor);
+
 // Map Object definition.
 class AActor : public DThinker
 {
@@ -1251,6 +1266,23 @@ public:
 	int PrevPortalGroup;
 	TArray<TObjPtr<AActor*> > AttachedLights;
 
+	// Precomputed link position for this tic. Not serialized.
+	FLinkPrediction LinkPrediction;
+
+	// Contribution to the incremental state hash and the tic it was queued
+	// for rehashing in. Not serialized.
+	uint32_t StateHash = 0;
+	int StateHashStamp = 0;
+	int StateHashIndex = 0;
+	// Health and whether the actor was moving when StateHash was computed.
+	int StateHashHealth = 0;
+	bool StateHashMoving = false;
+
+	void TouchStateHash()
+	{
+		if (StateHashStamp != P_StateHashStamp) P_StateHashTouch(this);
+	}
+
 	// ThingIDs
 	static void ClearTIDHashes ();
 	void AddToHash ();
@@ -1407,25 +1439,30 @@ public:
 	void SetZ(double newz, bool moving = true)
 	{
 		__Pos.Z = newz;
+		TouchStateHash();
 	}
 	void AddZ(double newz, bool moving = true)
 	{
 		__Pos.Z += newz;
 		if (!moving) Prev.Z = Z();
+		TouchStateHash();
 	}
 
 	void SetXY(const DVector2 &npos)
 	{
 		__Pos.X = npos.X;
 		__Pos.Y = npos.Y;
+		TouchStateHash();
 	}
 	void SetXYZ(double xx, double yy, double zz)
 	{
 		__Pos = { xx,yy,zz };
+		TouchStateHash();
 	}
 	void SetXYZ(const DVector3 &npos)
 	{
 		__Pos = npos;
+		TouchStateHash();
 	}
 
 	double VelXYToSpeed() const
@@ -842,6 +842,39 @@ void AddToConsole (int printlevel, const char *text)
 }
 
 /* Adds a string to the console and also to the notify buffer */
+static thread_local FCapturedOutput *CapturedOutput;
+
+//==========================================================================
+//
+// C_CaptureOutput
+//
+// Redirects all output of the calling thread into the given list until
+// this is called again with NULL.
+//
+//==========================================================================
+
+void C_CaptureOutput (FCapturedOutput *output)
+{
+	CapturedOutput = output;
+}
+
+//==========================================================================
+//
+// C_ReplayOutput
+//
+// Prints and clears previously captured output. Main thread only.
+//
+//==========================================================================
+
+void C_ReplayOutput (FCapturedOutput &output)
+{
+	for (auto &line : output)
+	{
+		PrintString (line.PrintLevel, line.Text);
+	}
+	output.Clear();
+}
+
 int PrintString (int printlevel, const char *outline)
 {
 	if (printlevel < msglevel || *outline == '\0')
@@ -849,6 +882,12 @@ int PrintString (int printlevel, const char *outline)
 		return 0;
 	}
 
+	if (CapturedOutput != NULL)
+	{
+		CapturedOutput->Push({ printlevel, outline });
+		return (int)strlen (outline);
+	}
+
 	if (printlevel != PRINT_LOG)
 	{
 		I_PrintStr (outline);
@@ -36,6 +36,7 @@
 
 #include <stdarg.h>
 #include "basictypes.h"
+#include "zstring.h"
 
 struct event_t;
 
@@ -67,6 +68,18 @@ void AddToConsole (int printlevel, const char *string);
 int PrintString (int printlevel, const char *string);
 int VPrintf (int printlevel, const char *format, va_list parms) GCCFORMAT(2);
 
+// Console output from a worker thread is collected here instead of being
+// printed directly, so that the main thread can print it later in order.
+struct FCapturedPrint
+{
+	int PrintLevel;
+	FString Text;
+};
+typedef TArray<FCapturedPrint> FCapturedOutput;
+
+void C_CaptureOutput (FCapturedOutput *output);
+void C_ReplayOutput (FCapturedOutput &output);
+
 void C_DrawConsole (bool hw2d);
 void C_ToggleConsole (void);
 void C_FullConsole (void);
@@ -1033,6 +1033,12 @@ void D_DoomLoop ()
 	{
 		try
 		{
+			if (fastdemo)
+			{
+				G_FastDemoTicker ();
+				continue;
+			}
+
 			// frame syncronous IO operations
 			if (gametic > lasttic)
 			{
@@ -1066,6 +1072,7 @@ void D_DoomLoop ()
 			// Update display, next frame, with current state.
 			I_StartTic ();
 			D_Display ();
+			GC::IdleStep ();
 			if (wantToRestart)
 			{
 				wantToRestart = false;
@@ -2673,6 +2680,14 @@ void D_DoomMain (void)
 				throw CNoRunExit();
 			}
 
+			v = Args->CheckValue("-fastdemo");
+			if (v != NULL)
+			{
+				// Headless playback keeps the dummy frame buffer from V_Init and never opens a window.
+				G_FastDemo (v);
+				D_DoomLoop ();	// never returns
+			}
+
 			V_Init2();
 			gl_PatchMenu();
 			UpdateJoystickMenu(NULL);
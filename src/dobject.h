@@ -184,6 +184,7 @@ protected: \
 #define _X_VMEXPORT_false(cls)		nullptr
 
 #include "dobjgc.h"
+#include "dobjpool.h"
 
 class DObject
 {
@@ -273,18 +274,18 @@ private:
 
 	void *operator new(size_t len, nonew&)
 	{
-		return M_Malloc(len);
+		return M_AllocObject(len);
 	}
 public:
 
 	void operator delete (void *mem, nonew&)
 	{
-		M_Free(mem);
+		M_FreeObject(mem);
 	}
 
 	void operator delete (void *mem)
 	{
-		M_Free(mem);
+		M_FreeObject(mem);
 	}
 
 	// GC fiddling
@@ -351,7 +352,7 @@ protected:
 
 	void operator delete (void *mem, EInPlace *)
 	{
-		M_Free (mem);
+		M_FreeObject (mem);
 	}
 
 	template<typename T, typename... Args>
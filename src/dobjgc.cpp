@@ -78,6 +78,10 @@
 #include "intermission/intermission.h"
 #include "g_levellocals.h"
 #include "events.h"
+#include "i_time.h"
+#include "parallel_for.h"
+
+#include <atomic>
 
 // MACROS ------------------------------------------------------------------
 
@@ -110,6 +114,20 @@
 #define GCSWEEPCOST		10
 #define GCFINALIZECOST	100
 
+// Number of single steps between clock checks in a time-limited step.
+#define GCTIMECHECK		8
+
+// Allocation headroom given to the game tic after collector work was done
+// between tics, and the fraction of the threshold at which such work starts.
+#define GCIDLESLACK		(GCSTEPSIZE*32)
+#define GCIDLESTART		8
+
+// The thinker lists are marked on worker threads in batches of this many
+// thinkers when a level has at least PARALLELMARKMIN of them.
+#define PARALLELMARKMIN		2048
+#define PARALLELMARKBATCH	2048
+#define PARALLELMARKCHUNK	128
+
 // TYPES -------------------------------------------------------------------
 
 // This object is responsible for marking sectors during the propagate
@@ -136,6 +154,9 @@ IMPLEMENT_CLASS(DSectorMarker, false, false)
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
 
+CVAR(Float, gc_pausebudget, 1.f, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)	// milliseconds per collector slice, 0 = unlimited
+CVAR(Bool, gc_parallelmark, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 extern DThinker *NextToThink;
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
@@ -161,6 +182,28 @@ bool FinalGC;
 
 static DSectorMarker *SectorMarker;
 
+// Thinkers still waiting to be marked by MarkThinkerBatch this cycle.
+static TArray<DThinker *> ThinkerSnapshot;
+static unsigned ThinkerSnapshotPos;
+static TArray<DObject *> ThinkerBatch;
+
+// Objects greyed by a worker thread are collected here and moved to the
+// main gray list once the batch is done.
+struct FLocalGray
+{
+	DObject *Head;
+	DObject *Tail;
+	size_t Work;
+};
+static thread_local FLocalGray *LocalGray;
+
+// Timing for the stat display, in nanoseconds.
+static uint64_t LastSliceTime, PeakSliceTime;
+// Time the Step calls have used since the last IdleStep. They all share one budget.
+static uint64_t StepTimeUsed;
+static uint64_t MarkTime, SweepTime, LastMarkTime, LastSweepTime, LastPeakSliceTime;
+static unsigned ParallelBatches, LastParallelBatches;
+
 // CODE --------------------------------------------------------------------
 
 //==========================================================================
@@ -266,6 +309,51 @@ static DObject **SweepList(DObject **p, size_t count, size_t *finalize_count)
 	return p;
 }
 
+//==========================================================================
+//
+// MarkParallel
+//
+// Marks a single object gray from a worker thread. Several workers may see
+// the same white object, so the color change is done atomically and only
+// the one that wins puts it on its own gray list. Other workers may be
+// changing the flags at the same time, so they are only ever read through
+// the same atomic.
+//
+//==========================================================================
+
+static void MarkParallel(DObject **obj)
+{
+	DObject *lobj = *obj;
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(lobj->ObjectFlags), "ObjectFlags cannot be accessed atomically");
+	auto &flags = *reinterpret_cast<std::atomic<uint32_t> *>(&lobj->ObjectFlags);
+	uint32_t old = flags.load(std::memory_order_relaxed);
+
+	assert(!(old & OF_Released));
+	if (old & OF_Released)
+	{
+		return;
+	}
+	if (old & OF_EuthanizeMe)
+	{
+		*obj = (DObject *)NULL;
+		return;
+	}
+	do
+	{
+		if (!(old & OF_WhiteBits))
+		{
+			return;
+		}
+	} while (!flags.compare_exchange_weak(old, old & ~OF_WhiteBits, std::memory_order_relaxed));
+
+	lobj->GCNext = LocalGray->Head;
+	LocalGray->Head = lobj;
+	if (LocalGray->Tail == nullptr)
+	{
+		LocalGray->Tail = lobj;
+	}
+}
+
 //==========================================================================
 //
 // Mark
@@ -278,6 +366,11 @@ void Mark(DObject **obj)
 {
 	DObject *lobj = *obj;
 
+	if (lobj != nullptr && LocalGray != nullptr)
+	{
+		MarkParallel(obj);
+		return;
+	}
 	assert(lobj == nullptr || !(lobj->ObjectFlags & OF_Released));
 	if (lobj != nullptr && !(lobj->ObjectFlags & OF_Released))
 	{
@@ -294,6 +387,21 @@ void Mark(DObject **obj)
 	}
 }
 
+//==========================================================================
+//
+// MarkFlags
+//
+//==========================================================================
+
+uint32_t MarkFlags(const DObject *obj)
+{
+	if (LocalGray != nullptr)
+	{
+		return reinterpret_cast<const std::atomic<uint32_t> *>(&obj->ObjectFlags)->load(std::memory_order_relaxed);
+	}
+	return obj->ObjectFlags;
+}
+
 //==========================================================================
 //
 // MarkArray
@@ -382,11 +490,92 @@ static void MarkRoot()
 			}
 		}
 	}
+	// Big thinker lists get marked in parallel batches before the gray list
+	// is propagated.
+	ThinkerSnapshot.Clear();
+	ThinkerSnapshotPos = 0;
+	if (gc_parallelmark && !PClass::bShutdown)
+	{
+		DThinker::CollectThinkers(ThinkerSnapshot);
+		if (ThinkerSnapshot.Size() < PARALLELMARKMIN)
+		{
+			ThinkerSnapshot.Clear();
+		}
+	}
 	// Time to propagate the marks.
 	State = GCS_Propagate;
 	StepCount = 0;
 }
 
+//==========================================================================
+//
+// MarkThinkerBatch
+//
+// Marks the next batch of thinkers from the snapshot taken by MarkRoot.
+// The main thread turns every white thinker of the batch black first, so
+// the NextThinker/PrevThinker links between them need no further work,
+// then the workers propagate them. Whatever they grey ends up on the
+// regular gray list and is handled incrementally as usual. The snapshot
+// stays valid between steps because nothing is freed before the sweep.
+//
+//==========================================================================
+
+static size_t MarkThinkerBatch()
+{
+	unsigned end = MIN(ThinkerSnapshot.Size(), ThinkerSnapshotPos + PARALLELMARKBATCH);
+	size_t work = 0;
+
+	ThinkerBatch.Clear();
+	for (; ThinkerSnapshotPos < end; ThinkerSnapshotPos++)
+	{
+		DThinker *thinker = ThinkerSnapshot[ThinkerSnapshotPos];
+		// Thinkers destroyed since the snapshot was taken are left for the sweep.
+		if (!thinker->IsWhite() || (thinker->ObjectFlags & OF_EuthanizeMe))
+		{
+			continue;
+		}
+		thinker->White2Gray();
+		thinker->Gray2Black();
+		PClass *cls = thinker->GetClass();
+		// These are built lazily and must not be built by the workers.
+		if (cls->FlatPointers == nullptr) cls->BuildFlatPointers();
+		if (cls->ArrayPointers == nullptr) cls->BuildArrayPointers();
+		ThinkerBatch.Push(thinker);
+	}
+	if (ThinkerSnapshotPos >= ThinkerSnapshot.Size())
+	{
+		ThinkerSnapshot.Clear();
+		ThinkerSnapshotPos = 0;
+	}
+
+	const unsigned chunks = (ThinkerBatch.Size() + PARALLELMARKCHUNK - 1) / PARALLELMARKCHUNK;
+	FLocalGray grays[PARALLELMARKBATCH / PARALLELMARKCHUNK] = {};
+
+	parallel_for(int(chunks), [&](int chunk)
+	{
+		FLocalGray *local = &grays[chunk];
+		unsigned last = MIN<unsigned>(ThinkerBatch.Size(), (chunk + 1) * PARALLELMARKCHUNK);
+		LocalGray = local;
+		for (unsigned i = chunk * PARALLELMARKCHUNK; i < last; i++)
+		{
+			local->Work += ThinkerBatch[i]->PropagateMark();
+		}
+		LocalGray = nullptr;
+	});
+
+	for (unsigned i = 0; i < chunks; i++)
+	{
+		if (grays[i].Head != nullptr)
+		{
+			grays[i].Tail->GCNext = Gray;
+			Gray = grays[i].Head;
+		}
+		work += grays[i].Work;
+	}
+	ParallelBatches++;
+	return work;
+}
+
 //==========================================================================
 //
 // Atomic
@@ -398,6 +587,7 @@ static void MarkRoot()
 
 static void Atomic()
 {
+	assert(ThinkerSnapshot.Size() == 0);
 	// Flip current white
 	CurrentWhite = OtherWhite();
 	SweepPos = &Root;
@@ -422,7 +612,11 @@ static size_t SingleStep()
 		return 0;
 
 	case GCS_Propagate:
-		if (Gray != NULL)
+		if (ThinkerSnapshot.Size() > 0)
+		{
+			return MarkThinkerBatch();
+		}
+		else if (Gray != NULL)
 		{
 			return PropagateMark();
 		}
@@ -456,29 +650,96 @@ static size_t SingleStep()
 	}
 }
 
+//==========================================================================
+//
+// TimedSteps
+//
+// Performs single steps until lim is used up, the collection is finished
+// or gc_pausebudget runs out. With idle set, lim is ignored and only the
+// budget ends the slice early. Without it, the budget is what is left of
+// the one shared by all Step calls of the current frame, and it can only
+// end the slice once minwork has been done, so that the collector never
+// falls behind the allocations no matter how long the frame gets. Returns
+// when the collector pauses, so at most one collection is finished per call.
+//
+//==========================================================================
+
+static void TimedSteps(size_t lim, size_t minwork, bool idle)
+{
+	uint64_t budget = gc_pausebudget > 0 ? uint64_t(gc_pausebudget * 1000000.) : 0;
+	if (budget != 0 && !idle)
+	{ // Once the budget is used up, each step only does its minimum work.
+		budget = budget > StepTimeUsed ? budget - StepTimeUsed : 1;
+	}
+	const size_t startlim = lim;
+	const uint64_t start = I_nsTime();
+	uint64_t phasestart = start, now = start;
+	int checks = 0;
+	size_t olim;
+
+	do
+	{
+		EGCState oldstate = State;
+		olim = lim;
+		lim -= SingleStep();
+		if ((State > GCS_Propagate) != (oldstate > GCS_Propagate) || State == GCS_Pause)
+		{
+			now = I_nsTime();
+			(oldstate > GCS_Propagate ? SweepTime : MarkTime) += now - phasestart;
+			phasestart = now;
+		}
+		else if (budget != 0 && ++checks % GCTIMECHECK == 0)
+		{
+			now = I_nsTime();
+		}
+		if (budget != 0 && now - start >= budget && startlim - lim >= minwork)
+		{
+			break;
+		}
+	} while ((idle || olim > lim) && State != GCS_Pause);
+
+	now = I_nsTime();
+	if (State != GCS_Pause)
+	{
+		(State > GCS_Propagate ? SweepTime : MarkTime) += now - phasestart;
+	}
+	LastSliceTime = now - start;
+	PeakSliceTime = MAX(PeakSliceTime, LastSliceTime);
+	if (!idle)
+	{
+		StepTimeUsed += LastSliceTime;
+	}
+	if (State == GCS_Pause)
+	{ // Collection finished; keep its totals for the stat display.
+		LastMarkTime = MarkTime;
+		LastSweepTime = SweepTime;
+		LastPeakSliceTime = PeakSliceTime;
+		LastParallelBatches = ParallelBatches;
+		MarkTime = SweepTime = PeakSliceTime = 0;
+		ParallelBatches = 0;
+	}
+}
+
 //==========================================================================
 //
 // Step
 //
 // Performs enough single steps to cover GCSTEPSIZE * StepMul% bytes of
-// memory.
+// memory. If the frame's time budget runs out, the step still covers the
+// debt, i.e. GCSTEPSIZE plus what was allocated past the threshold, up to
+// the full lim once the collector is far enough behind.
 //
 //==========================================================================
 
 void Step()
 {
 	size_t lim = (GCSTEPSIZE/100) * StepMul;
-	size_t olim;
 	if (lim == 0)
 	{
 		lim = (~(size_t)0) / 2;		// no limit
 	}
 	Dept += AllocBytes - Threshold;
-	do
-	{
-		olim = lim;
-		lim -= SingleStep();
-	} while (olim > lim && State != GCS_Pause);
+	TimedSteps(lim, MIN<size_t>(lim, GCSTEPSIZE + Dept), false);
 	if (State != GCS_Pause)
 	{
 		if (Dept < GCSTEPSIZE)
@@ -499,6 +760,41 @@ void Step()
 	StepCount++;
 }
 
+//==========================================================================
+//
+// IdleStep
+//
+// Called once per frame after the tics have run. Moves a pending collection
+// along for up to gc_pausebudget milliseconds, so most of the work happens
+// outside the game tic instead of in the CheckGC calls between thinkers.
+// A new collection is started a bit before the threshold is reached.
+// The Step calls of the next frame get a fresh budget.
+//
+//==========================================================================
+
+void IdleStep()
+{
+	StepTimeUsed = 0;
+	if (gc_pausebudget <= 0 || Threshold >= (~(size_t)0) / 2)
+	{ // Unlimited slices would stall the frame; a stopped collector stays stopped.
+		return;
+	}
+	if (State == GCS_Pause && AllocBytes < Threshold - Threshold / GCIDLESTART)
+	{
+		return;
+	}
+	TimedSteps(0, 0, true);
+	if (State != GCS_Pause)
+	{
+		Threshold = MAX(Threshold, AllocBytes + GCIDLESLACK);
+	}
+	else
+	{
+		SetThreshold();
+	}
+	StepCount++;
+}
+
 //==========================================================================
 //
 // FullGC
@@ -515,6 +811,8 @@ void FullGC()
 		SweepPos = &Root;
 		// Reset other collector lists
 		Gray = NULL;
+		ThinkerSnapshot.Clear();
+		ThinkerSnapshotPos = 0;
 		State = GCS_Sweep;
 	}
 	// Finish any pending sweep phase
@@ -745,6 +1043,13 @@ ADD_STAT(gc)
 	{
 		out.AppendFormat("  %zuK", (GC::Dept + 1023) >> 10);
 	}
+	out.AppendFormat("\nSlice:%6.3f ms  Peak:%6.3f ms  Last cycle: Mark:%7.3f ms  Sweep:%7.3f ms  Peak:%6.3f ms  Batches: %u",
+		GC::LastSliceTime / 1e6,
+		GC::PeakSliceTime / 1e6,
+		GC::LastMarkTime / 1e6,
+		GC::LastSweepTime / 1e6,
+		GC::LastPeakSliceTime / 1e6,
+		GC::LastParallelBatches);
 	return out;
 }
 
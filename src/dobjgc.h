@@ -81,6 +81,9 @@ namespace GC
 	// Does one collection step.
 	void Step();
 
+	// Does time-limited collection work between tics.
+	void IdleStep();
+
 	// Does a complete collection.
 	void FullGC();
 
@@ -123,6 +126,10 @@ namespace GC
 	// Marks an array of objects.
 	void MarkArray(DObject **objs, size_t count);
 
+	// Reads an object's flags from inside PropagateMark. Safe to use while
+	// the thinkers are being marked in parallel.
+	uint32_t MarkFlags(const DObject *obj);
+
 	// For cleanup
 	void DelSoftRootHead();
 
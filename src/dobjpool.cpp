@@ -0,0 +1,325 @@
+/*
+** dobjpool.cpp
+** Slab allocator for DObjects
+**
+**---------------------------------------------------------------------------
+** Copyright 2018 GZDoom maintainers
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** Actors and other thinkers are created and destroyed all the time, so
+** their memory comes from slabs instead of the general heap. There is one
+** pool per 16 byte size class; a slab holds objects of a single size, so
+** spawning and freeing are a free list push or pop, and objects of the
+** same class end up next to each other. Every object is preceded by a
+** header that points to its slab, which lets M_FreeObject work without
+** knowing the size and also takes objects that were allocated while
+** obj_pool was off.
+**
+*/
+
+#include <stdlib.h>
+#include "dobject.h"
+#include "c_cvars.h"
+#include "c_dispatch.h"
+#include "stats.h"
+#include "templates.h"
+
+// MACROS ------------------------------------------------------------------
+
+#define POOLGRANULARITY	16
+#define POOLMAXSIZE		8192	// bigger objects come from the heap
+#define SLABSIZE		65536
+#define SLABMINOBJECTS	8
+
+// TYPES -------------------------------------------------------------------
+
+struct FObjectSlab;
+struct FObjectPool;
+
+union FSlotHeader
+{
+	FObjectSlab *Slab;		// nullptr for heap allocated objects
+	FSlotHeader *NextFree;	// only while the slot is unused
+	uint8_t Align[POOLGRANULARITY];
+};
+
+struct FObjectSlab
+{
+	FObjectPool *Pool;
+	FObjectSlab *Prev, *Next;	// links in the pool's list of slabs with free slots
+	FSlotHeader *FreeList;
+	uint8_t *Fresh;				// next never used slot
+	uint8_t *End;
+	unsigned Used;
+};
+
+struct FObjectPool
+{
+	size_t SlotSize;
+	unsigned SlabSlots;
+	FObjectSlab *Partial;		// slabs that have at least one free slot
+	unsigned Slabs;
+	unsigned Live, PeakLive;
+	uint64_t Allocs, Frees;
+
+	void *Alloc();
+	void Free(FSlotHeader *slot);
+
+private:
+	void Link(FObjectSlab *slab);
+	void Unlink(FObjectSlab *slab);
+};
+
+// EXTERNAL DATA DECLARATIONS ----------------------------------------------
+
+CVAR(Bool, obj_pool, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+// PRIVATE DATA DEFINITIONS ------------------------------------------------
+
+static FObjectPool *Pools[POOLMAXSIZE / POOLGRANULARITY + 1];
+static const size_t SlabHeaderSize = (sizeof(FObjectSlab) + POOLGRANULARITY - 1) & ~size_t(POOLGRANULARITY - 1);
+
+// CODE --------------------------------------------------------------------
+
+//==========================================================================
+//
+// FObjectPool :: Link / Unlink
+//
+//==========================================================================
+
+void FObjectPool::Link(FObjectSlab *slab)
+{
+	slab->Prev = nullptr;
+	slab->Next = Partial;
+	if (Partial != nullptr) Partial->Prev = slab;
+	Partial = slab;
+}
+
+void FObjectPool::Unlink(FObjectSlab *slab)
+{
+	if (slab->Prev != nullptr) slab->Prev->Next = slab->Next;
+	else Partial = slab->Next;
+	if (slab->Next != nullptr) slab->Next->Prev = slab->Prev;
+	slab->Prev = slab->Next = nullptr;
+}
+
+//==========================================================================
+//
+// FObjectPool :: Alloc
+//
+// Takes a slot from the first slab with room, preferring recently freed
+// slots over fresh ones.
+//
+//==========================================================================
+
+void *FObjectPool::Alloc()
+{
+	FObjectSlab *slab = Partial;
+	if (slab == nullptr)
+	{
+		size_t size = SlabHeaderSize + SlotSize * SlabSlots;
+		slab = (FObjectSlab *)malloc(size);
+		if (slab == nullptr)
+		{
+			I_FatalError("Could not allocate %zu bytes for an object slab", size);
+		}
+		slab->Pool = this;
+		slab->FreeList = nullptr;
+		slab->Fresh = (uint8_t *)slab + SlabHeaderSize;
+		slab->End = (uint8_t *)slab + size;
+		slab->Used = 0;
+		Link(slab);
+		Slabs++;
+	}
+
+	FSlotHeader *slot = slab->FreeList;
+	if (slot != nullptr)
+	{
+		slab->FreeList = slot->NextFree;
+	}
+	else
+	{
+		assert(slab->Fresh < slab->End);
+		slot = (FSlotHeader *)slab->Fresh;
+		slab->Fresh += SlotSize;
+	}
+	slot->Slab = slab;
+	if (++slab->Used == SlabSlots)
+	{
+		Unlink(slab);
+	}
+
+	Allocs++;
+	PeakLive = MAX(PeakLive, ++Live);
+	GC::AllocBytes += SlotSize;
+	return slot + 1;
+}
+
+//==========================================================================
+//
+// FObjectPool :: Free
+//
+// Returns a slot to its slab. A slab that becomes empty is given back to
+// the system unless it is the only one left with free slots, so a pool
+// that keeps spawning and destroying a handful of objects does not keep
+// allocating new slabs.
+//
+//==========================================================================
+
+void FObjectPool::Free(FSlotHeader *slot)
+{
+	FObjectSlab *slab = slot->Slab;
+	assert(slab->Pool == this && slab->Used > 0);
+
+	if (slab->Used == SlabSlots)
+	{
+		Link(slab);
+	}
+	slot->NextFree = slab->FreeList;
+	slab->FreeList = slot;
+
+	Frees++;
+	Live--;
+	GC::AllocBytes -= SlotSize;
+	if (--slab->Used == 0 && (slab != Partial || slab->Next != nullptr))
+	{
+		Unlink(slab);
+		free(slab);
+		Slabs--;
+	}
+}
+
+//==========================================================================
+//
+// M_AllocObject
+//
+//==========================================================================
+
+void *M_AllocObject(size_t size)
+{
+	if (obj_pool && size <= POOLMAXSIZE)
+	{
+		unsigned index = unsigned((size + POOLGRANULARITY - 1) / POOLGRANULARITY);
+		FObjectPool *pool = Pools[index];
+		if (pool == nullptr)
+		{
+			pool = Pools[index] = (FObjectPool *)calloc(1, sizeof(FObjectPool));
+			pool->SlotSize = sizeof(FSlotHeader) + index * POOLGRANULARITY;
+			pool->SlabSlots = unsigned(MAX<size_t>(SLABMINOBJECTS, (SLABSIZE - SlabHeaderSize) / pool->SlotSize));
+		}
+		return pool->Alloc();
+	}
+	FSlotHeader *header = (FSlotHeader *)M_Malloc(sizeof(FSlotHeader) + size);
+	header->Slab = nullptr;
+	return header + 1;
+}
+
+//==========================================================================
+//
+// M_FreeObject
+//
+//==========================================================================
+
+void M_FreeObject(void *mem)
+{
+	if (mem != nullptr)
+	{
+		FSlotHeader *header = (FSlotHeader *)mem - 1;
+		if (header->Slab == nullptr)
+		{
+			M_Free(header);
+		}
+		else
+		{
+			header->Slab->Pool->Free(header);
+		}
+	}
+}
+
+//==========================================================================
+//
+// STAT objpool
+//
+//==========================================================================
+
+ADD_STAT(objpool)
+{
+	unsigned pools = 0, slabs = 0, live = 0;
+	size_t memory = 0, used = 0;
+	uint64_t allocs = 0;
+
+	for (auto pool : Pools)
+	{
+		if (pool != nullptr)
+		{
+			pools++;
+			slabs += pool->Slabs;
+			live += pool->Live;
+			memory += pool->Slabs * (SlabHeaderSize + pool->SlotSize * pool->SlabSlots);
+			used += pool->Live * pool->SlotSize;
+			allocs += pool->Allocs;
+		}
+	}
+	FString out;
+	out.Format("Pools: %u  Slabs: %u  Objects: %u  Used: %zuK of %zuK  Allocs: %llu",
+		pools, slabs, live, (used + 1023) >> 10, (memory + 1023) >> 10, (unsigned long long)allocs);
+	return out;
+}
+
+//==========================================================================
+//
+// CCMD dumpobjpools
+//
+// Lists every pool with the classes that allocate from it.
+//
+//==========================================================================
+
+CCMD(dumpobjpools)
+{
+	for (unsigned i = 0; i < countof(Pools); i++)
+	{
+		FObjectPool *pool = Pools[i];
+		if (pool == nullptr) continue;
+
+		Printf("%5zu bytes: %4u slabs  %6u live  %6u peak  %8llu allocs  %8llu frees\n",
+			i * POOLGRANULARITY, pool->Slabs, pool->Live, pool->PeakLive,
+			(unsigned long long)pool->Allocs, (unsigned long long)pool->Frees);
+
+		FString classes;
+		for (auto cls : PClass::AllClasses)
+		{
+			if (cls->Size != TentativeClass && (cls->Size + POOLGRANULARITY - 1) / POOLGRANULARITY == i)
+			{
+				classes.AppendFormat(" %s", cls->TypeName.GetChars());
+			}
+		}
+		if (classes.IsNotEmpty())
+		{
+			Printf("            %s\n", classes.GetChars());
+		}
+	}
+}
@@ -0,0 +1,11 @@
+#ifndef __DOBJPOOL_H__
+#define __DOBJPOOL_H__
+
+#include <stddef.h>
+
+// Memory for DObjects. Objects up to a few kilobytes come from slabs that
+// are shared by all classes of the same size, bigger ones from the heap.
+void *M_AllocObject(size_t size);
+void M_FreeObject(void *mem);
+
+#endif
@@ -124,6 +124,7 @@ extern	bool			viewactive;
 
 extern	bool	 		nodrawers;
 extern	bool	 		noblit;
+extern	bool			fastdemo;
 
 extern	int 			viewwindowx;
 extern	int 			viewwindowy;
@@ -35,6 +35,7 @@
 #include "serializer.h"
 #include "doomstat.h"
 #include "vm.h"
+#include "p_statehash.h"
 
 IMPLEMENT_CLASS(DSectorEffect, false, false)
 
@@ -162,6 +163,11 @@ EMoveResult sector_t::MoveFloor(double speed, double dest, int crush, int direct
 	double		move;
 	//double		destheight;	//jff 02/04/98 used to keep floors/ceilings
 							// from moving thru each other
+
+	// Opening or closing the sector changes which of its lines block light.
+	for (auto line : Lines) level.LineChanged(line);
+	P_StateHashSector(this);
+
 	lastpos = floorplane.fD();
 	switch (direction)
 	{
@@ -298,6 +304,9 @@ EMoveResult sector_t::MoveCeiling(double speed, double dest, int crush, int dire
 	//double		destheight;	//jff 02/04/98 used to keep floors/ceilings
 	// from moving thru each other
 
+	for (auto line : Lines) level.LineChanged(line);
+	P_StateHashSector(this);
+
 	lastpos = ceilingplane.fD();
 	switch (direction)
 	{
@@ -44,7 +44,7 @@
 
 
 static int ThinkCount;
-static cycle_t ThinkCycles;
+cycle_t ThinkCycles;
 extern cycle_t BotSupportCycles;
 extern cycle_t ActionCycles;
 extern int BotWTG;
@@ -415,6 +415,30 @@ void DThinker::MarkRoots()
 	GC::Mark(Thinkers[MAX_STATNUM+1].Sentinel);
 }
 
+//==========================================================================
+//
+// Collects every thinker in every list so that the collector can mark
+// them in batches instead of discovering them one link at a time.
+//
+//==========================================================================
+
+void DThinker::CollectThinkers(TArray<DThinker *> &list)
+{
+	auto collect = [&](FThinkerList &thinkers)
+	{
+		for (DThinker *node = thinkers.GetHead(); node != nullptr && node != thinkers.Sentinel; node = node->NextThinker)
+		{
+			list.Push(node);
+		}
+	};
+	for (int i = 0; i <= MAX_STATNUM; ++i)
+	{
+		collect(Thinkers[i]);
+		collect(FreshThinkers[i]);
+	}
+	collect(Thinkers[MAX_STATNUM+1]);
+}
+
 //==========================================================================
 //
 // Destroy every thinker
@@ -675,8 +699,8 @@ size_t DThinker::PropagateMark()
 	// Do not choke on partially initialized objects (as happens when loading a savegame fails)
 	if (NextThinker != nullptr || PrevThinker != nullptr)
 	{
-		assert(NextThinker != nullptr && !(NextThinker->ObjectFlags & OF_EuthanizeMe));
-		assert(PrevThinker != nullptr && !(PrevThinker->ObjectFlags & OF_EuthanizeMe));
+		assert(NextThinker != nullptr && !(GC::MarkFlags(NextThinker) & OF_EuthanizeMe));
+		assert(PrevThinker != nullptr && !(GC::MarkFlags(PrevThinker) & OF_EuthanizeMe));
 	}
 	GC::Mark(NextThinker);
 	GC::Mark(PrevThinker);
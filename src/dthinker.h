@@ -87,6 +87,7 @@ public:
 	}
 	static void SerializeThinkers(FSerializer &arc, bool keepPlayers);
 	static void MarkRoots();
+	static void CollectThinkers(TArray<DThinker *> &list);
 
 	static DThinker *FirstThinker (int statnum);
 	static bool bSerialOverride;
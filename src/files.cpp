@@ -36,6 +36,13 @@
 // This also pulls in windows.h
 #include "LzmaDec.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "files.h"
 #include "i_system.h"
 #include "templates.h"
@@ -609,6 +616,90 @@ char *MemoryArrayReader::Gets(char *strbuf, int len)
     return GetsFromBuffer((char*)&buf[0], strbuf, len);
 }
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a read-only memory mapping of a file. The mapping stays
+// valid until the reader is closed, so anything pointing into GetBuffer()
+// must not outlive it.
+//
+//==========================================================================
+
+MappedFileReader::MappedFileReader ()
+: MemoryReader(NULL, 0), MapHandle(NULL)
+{
+}
+
+MappedFileReader::~MappedFileReader ()
+{
+	Close();
+}
+
+bool MappedFileReader::Open (const char *filename)
+{
+	const char *view = NULL;
+	long size = 0;
+
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER filesize;
+	// Empty files cannot be mapped and the size must fit into a long.
+	if (GetFileSizeEx(file, &filesize) && filesize.QuadPart > 0 && filesize.QuadPart <= 0x7fffffff)
+	{
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping != NULL)
+		{
+			view = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view != NULL) MapHandle = mapping;
+			else CloseHandle(mapping);
+		}
+		size = (long)filesize.QuadPart;
+	}
+	// The mapping holds its own reference to the file.
+	CloseHandle(file);
+#else
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && info.st_size <= 0x7fffffff)
+	{
+		void *p = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) view = (const char *)p;
+		size = (long)info.st_size;
+	}
+	// The mapping stays valid after the descriptor is closed.
+	close(fd);
+#endif
+
+	if (view == NULL) return false;
+	bufptr = view;
+	Length = size;
+	FilePos = 0;
+	return true;
+}
+
+void MappedFileReader::Close ()
+{
+	if (bufptr != NULL)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(bufptr);
+		CloseHandle((HANDLE)MapHandle);
+#else
+		munmap((void *)bufptr, (size_t)Length);
+#endif
+	}
+	bufptr = NULL;
+	MapHandle = NULL;
+	Length = FilePos = 0;
+}
+
 //==========================================================================
 //
 // FileWriter (the motivation here is to have a buffer writing subclass)
@@ -374,6 +374,21 @@ protected:
 	const char * bufptr;
 };
 
+// Maps an entire file into memory. Resource files opened through this
+// can hand out their uncompressed lumps as direct pointers into the mapping.
+class MappedFileReader : public MemoryReader
+{
+public:
+	MappedFileReader ();
+	~MappedFileReader ();
+
+	bool Open (const char *filename);
+	void Close ();
+
+private:
+	void *MapHandle;
+};
+
 class MemoryArrayReader : public FileReader
 {
 public:
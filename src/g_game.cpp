@@ -45,6 +45,8 @@
 #include "menu/menu.h"
 #include "m_random.h"
 #include "m_crc32.h"
+#include "p_statehash.h"
+#include "stats.h"
 #include "i_system.h"
 #include "p_saveg.h"
 #include "p_tick.h"
@@ -119,6 +121,8 @@ void	G_DoAutoSave ();
 void STAT_Serialize(FSerializer &file);
 bool WriteZip(const char *filename, TArray<FString> &filenames, TArray<FCompressedBuffer> &content);
 
+extern cycle_t ThinkCycles, ActionCycles, ACSTime;
+
 FIntCVar gameskill ("skill", 2, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
@@ -163,6 +167,7 @@ bool			insave;					// Game is saving - used to block exit commands
 bool			timingdemo; 			// if true, exit with report on completion 
 bool 			nodrawers;				// for comparative timing purposes 
 bool 			noblit; 				// for comparative timing purposes 
+bool			fastdemo;				// headless demo playback at full speed
 
 bool	 		viewactive;
 
@@ -176,6 +181,11 @@ int 			consoleplayer;			// player taking events
 int 			gametic;
 
 CVAR(Bool, demo_compress, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);
+CVAR(Bool, demo_statehash, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG);	// record per-tic state hashes for desync checks
+CVAR(Bool, net_statehash, false, CVAR_SERVERINFO);	// use the state hash for the netgame consistency check
+static TArray<uint32_t> DemoHashes;		// per-tic state hashes of the demo being recorded or played back
+static unsigned int DemoHashTic;
+static bool DemoDesynced;
 FString			newdemoname;
 FString			newdemomap;
 FString			demoname;
@@ -1162,6 +1172,22 @@ void G_Ticker ()
 	//Added by MC: For some of that bot stuff. The main bot function.
 	bglobal.Main ();
 
+	// Demos store the state hash of every tic, so playback can tell exactly where it went out of sync.
+	if (demorecording && demo_statehash)
+	{
+		DemoHashes.Push (P_GetStateHash ());
+	}
+	else if (demoplayback && DemoHashTic < DemoHashes.Size())
+	{
+		uint32_t hash = P_GetStateHash ();
+		if (hash != DemoHashes[DemoHashTic] && !DemoDesynced)
+		{
+			Printf (TEXTCOLOR_RED "Demo desynced at tic %u (state hash %08x, recorded %08x)\n", DemoHashTic, hash, DemoHashes[DemoHashTic]);
+			DemoDesynced = true;
+		}
+		DemoHashTic++;
+	}
+
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
 		if (playeringame[i])
@@ -1204,7 +1230,12 @@ void G_Ticker ()
 				{
 					players[i].inconsistant = gametic - BACKUPTICS*ticdup;
 				}
-				if (players[i].mo)
+				if (net_statehash)
+				{
+					uint32_t hash = P_GetStateHash ();
+					consistancy[i][buf] = short(hash ^ (hash >> 16));
+				}
+				else if (players[i].mo)
 				{
 					uint32_t sum = rngsum + int((players[i].mo->X() + players[i].mo->Y() + players[i].mo->Z())*257) + players[i].mo->Angles.Yaw.BAMs() + players[i].mo->Angles.Pitch.BAMs();
 					sum ^= players[i].health;
@@ -2527,6 +2558,7 @@ void G_BeginRecording (const char *startmap)
 		startmap = level.MapName;
 	}
 	demo_p = demobuffer;
+	DemoHashes.Clear();
 
 	WriteLong (FORM_ID, &demo_p);			// Write FORM ID
 	demo_p += 4;							// Leave space for len
@@ -2635,10 +2667,14 @@ bool G_ProcessIFFDemo (FString &mapname)
 	bool bodyHit = false;
 	int numPlayers = 0;
 	int id, len, i;
+	int bodylen = 0;
 	uLong uncompSize = 0;
 	uint8_t *nextchunk;
 
 	demoplayback = true;
+	DemoHashes.Clear();
+	DemoHashTic = 0;
+	DemoDesynced = false;
 
 	for (i = 0; i < MAXPLAYERS; i++)
 		playeringame[i] = 0;
@@ -2728,6 +2764,7 @@ bool G_ProcessIFFDemo (FString &mapname)
 
 		case BODY_ID:
 			bodyHit = true;
+			bodylen = len;
 			zdembodyend = demo_p + len;
 			break;
 
@@ -2762,6 +2799,22 @@ bool G_ProcessIFFDemo (FString &mapname)
 	if (numPlayers > 1)
 		multiplayer = netgame = true;
 
+	// The state hashes follow the BODY, where older versions stop reading.
+	uint8_t *hashchunk = demo_p + bodylen + (bodylen & 1);
+	if (hashchunk + 12 <= zdemformend && ReadLong (&hashchunk) == HASH_ID)
+	{
+		len = ReadLong (&hashchunk);
+		unsigned int count = ReadLong (&hashchunk);
+		if (len >= 4 && hashchunk + len - 4 <= zdemformend && count <= unsigned(len - 4) / 4)
+		{
+			DemoHashes.Resize(count);
+			for (unsigned int j = 0; j < count; j++)
+			{
+				DemoHashes[j] = ReadLong (&hashchunk);
+			}
+		}
+	}
+
 	if (uncompSize > 0)
 	{
 		uint8_t *uncompressed = (uint8_t*)M_Malloc(uncompSize);
@@ -2876,6 +2929,130 @@ void G_TimeDemo (const char* name)
 	gameaction = (gameaction == ga_loadgame) ? ga_loadgameplaydemo : ga_playdemo;
 }
 
+//
+// G_FastDemo
+//
+// Plays a demo through the playsim as fast as the CPU allows. Nothing is
+// drawn, no video mode is set and sound goes to the null renderer, so
+// this runs on build servers without a display. At the end it reports
+// tics per second, where the time went and a checksum of the state of
+// every tic. -demohashes <file> also writes the per-tic checksums out,
+// so two runs can be diffed to find the first tic they disagree on.
+//
+
+static struct FFastDemoStats
+{
+	FILE *HashFile;
+	uint64_t StartTime;
+	int Tics;
+	double TickerMS, ThinkerMS, ActionMS, ACSMS, GCMS, HashMS;
+	uint32_t Checksum;
+} FastDemo;
+
+void G_FastDemo (const char* name)
+{
+	nodrawers = true;
+	noblit = true;
+	fastdemo = true;
+	singledemo = true;
+	singletics = true;
+
+	memset(&FastDemo, 0, sizeof(FastDemo));
+	const char *hashname = Args->CheckValue ("-demohashes");
+	if (hashname != NULL)
+	{
+		FastDemo.HashFile = fopen (hashname, "w");
+		if (FastDemo.HashFile == NULL)
+		{
+			Printf ("Could not open %s for writing\n", hashname);
+		}
+	}
+
+	defdemoname = name;
+	gameaction = ga_playdemo;
+}
+
+//
+// G_FastDemoTicker
+//
+// Runs one tic for G_FastDemo in place of the regular game loop.
+// Input, sound and display updates are left out.
+//
+void G_FastDemoTicker ()
+{
+	cycle_t ticker, gc, hash;
+
+	ticker.Reset();
+	gc.Reset();
+	hash.Reset();
+	ThinkCycles.Reset();
+	ActionCycles.Reset();
+	ACSTime.Reset();
+
+	ticker.Clock();
+	G_Ticker ();
+	ticker.Unclock();
+
+	gametic++;
+	maketic++;
+	gc.Clock();
+	GC::CheckGC ();
+	GC::IdleStep ();
+	gc.Unclock();
+	Net_NewMakeTic ();
+
+	// The clock starts with the first tic of the first level, so the demo's startup is not counted.
+	if (FastDemo.StartTime == 0)
+	{
+		if (gamestate == GS_LEVEL)
+		{
+			FastDemo.StartTime = I_nsTime ();
+		}
+		return;
+	}
+
+	hash.Clock();
+	uint32_t tichash = P_GetStateHash ();
+	FastDemo.Checksum = AddCRC32 (FastDemo.Checksum, (const uint8_t *)&tichash, sizeof(tichash));
+	if (FastDemo.HashFile != NULL)
+	{
+		fprintf (FastDemo.HashFile, "%d %08x\n", gametic, tichash);
+	}
+	hash.Unclock();
+
+	FastDemo.Tics++;
+	FastDemo.TickerMS += ticker.TimeMS();
+	FastDemo.ThinkerMS += ThinkCycles.TimeMS();
+	FastDemo.ActionMS += ActionCycles.TimeMS();
+	FastDemo.ACSMS += ACSTime.TimeMS();
+	FastDemo.GCMS += gc.TimeMS();
+	FastDemo.HashMS += hash.TimeMS();
+}
+
+static void G_FastDemoReport ()
+{
+	double seconds = FastDemo.StartTime != 0 ? (I_nsTime () - FastDemo.StartTime) * 1e-9 : 0;
+	double ticrate = FastDemo.Tics / MAX(seconds, 1e-9);
+	int tics = MAX(FastDemo.Tics, 1);
+
+	Printf ("Played %d gametics in %.3f seconds (%.1f tics/s, %.1fx realtime)\n",
+		FastDemo.Tics, seconds, ticrate, ticrate / TICRATE);
+	Printf ("  Ticker:   %10.2f ms  %7.3f ms/tic\n", FastDemo.TickerMS, FastDemo.TickerMS / tics);
+	Printf ("  Thinkers: %10.2f ms  %7.3f ms/tic\n", FastDemo.ThinkerMS, FastDemo.ThinkerMS / tics);
+	Printf ("  Actions:  %10.2f ms  %7.3f ms/tic  (part of thinkers)\n", FastDemo.ActionMS, FastDemo.ActionMS / tics);
+	Printf ("  ACS:      %10.2f ms  %7.3f ms/tic  (part of thinkers)\n", FastDemo.ACSMS, FastDemo.ACSMS / tics);
+	Printf ("  Other:    %10.2f ms  %7.3f ms/tic  (ticker minus thinkers)\n", FastDemo.TickerMS - FastDemo.ThinkerMS, (FastDemo.TickerMS - FastDemo.ThinkerMS) / tics);
+	Printf ("  GC:       %10.2f ms  %7.3f ms/tic\n", FastDemo.GCMS, FastDemo.GCMS / tics);
+	Printf ("  Hashing:  %10.2f ms  %7.3f ms/tic\n", FastDemo.HashMS, FastDemo.HashMS / tics);
+	Printf ("State checksum: %08x\n", FastDemo.Checksum);
+
+	if (FastDemo.HashFile != NULL)
+	{
+		fclose (FastDemo.HashFile);
+		FastDemo.HashFile = NULL;
+	}
+}
+
 
 /*
 ===================
@@ -2921,7 +3098,12 @@ bool G_CheckDemoStatus (void)
 		}
 		if (singledemo || timingdemo)
 		{
-			if (timingdemo)
+			if (fastdemo)
+			{
+				G_FastDemoReport ();
+				exit (0);
+			}
+			else if (timingdemo)
 			{
 				// Trying to get back to a stable state after timing a demo
 				// seems to cause problems. I don't feel like fixing that
@@ -2972,6 +3154,27 @@ bool G_CheckDemoStatus (void)
 			delete[] compressed;
 		}
 		FinishChunk (&demo_p);
+
+		if (DemoHashes.Size() > 0)
+		{
+			size_t needed = (demo_p - demobuffer) + 16 + DemoHashes.Size() * 4;
+			if (needed > maxdemosize)
+			{
+				ptrdiff_t pos = demo_p - demobuffer;
+				maxdemosize = needed;
+				demobuffer = (uint8_t *)M_Realloc (demobuffer, maxdemosize);
+				demo_p = demobuffer + pos;
+			}
+			StartChunk (HASH_ID, &demo_p);
+			WriteLong (DemoHashes.Size(), &demo_p);
+			for (auto hash : DemoHashes)
+			{
+				WriteLong (hash, &demo_p);
+			}
+			FinishChunk (&demo_p);
+			DemoHashes.Clear();
+		}
+
 		formlen = demobuffer + 4;
 		WriteLong (int(demo_p - demobuffer - 8), &formlen);
 
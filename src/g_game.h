@@ -61,6 +61,8 @@ void G_BeginRecording (const char *startmap);
 
 void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
+void G_FastDemo (const char* name);
+void G_FastDemoTicker (void);
 bool G_CheckDemoStatus (void);
 
 void G_WorldDone (void);
@@ -83,6 +83,7 @@ struct FLevelLocals
 	TArray<uint8_t> rejectmatrix;
 
 	TArray<FSectorPortal> sectorPortals;
+	TArray<int> ChangedLines;	// lines that moved or changed height since the renderer last checked
 	TArray<zone_t>	Zones;
 
 	FBlockmap blockmap;
@@ -162,6 +163,13 @@ struct FLevelLocals
 	{
 		return headgamenode;
 	}
+
+	// Once the list is as long as the level has lines there is no point in
+	// keeping track of individual lines anymore and all of them need checking.
+	void LineChanged(line_t *line)
+	{
+		if (ChangedLines.Size() < lines.Size()) ChangedLines.Push(line->Index());
+	}
 };
 
 extern FLevelLocals level;
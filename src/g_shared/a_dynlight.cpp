@@ -76,6 +76,12 @@
 #include "gl/system//gl_interface.h"
 #include "vm.h"
 
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
 extern int currentrenderer;
 
 
@@ -86,6 +92,7 @@ CUSTOM_CVAR (Bool, gl_lights, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG | CVAR_NOIN
 }
 
 CVAR (Bool, gl_attachedlights, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR (Bool, r_multithreadedlights, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 //==========================================================================
 //
@@ -572,31 +579,87 @@ double ADynamicLight::DistToSeg(const DVector3 &pos, seg_t *seg)
 // Collect all touched sidedefs and subsectors
 // to sidedefs and sector parts.
 //
+// The walk only reads the level so that it can run on any thread.
+// Its results get linked into the world on the main thread afterward.
+//
 //==========================================================================
+
 struct LightLinkEntry
 {
 	subsector_t *sub;
 	DVector3 pos;
 };
-static TArray<LightLinkEntry> collected_ss;
 
-void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSec, float radius)
+struct FLightLinks
+{
+	TArray<subsector_t *> subsectors;
+	TArray<subsector_t *> sectors;		// the subsector through which the sector was reached
+	TArray<side_t *> sides;
+	bool shadowmapped;
+};
+
+//==========================================================================
+//
+// Per-thread state of the walk. This replaces validcount which
+// cannot be shared between threads.
+//
+//==========================================================================
+
+class FLightLinkWalker
+{
+public:
+	TArray<LightLinkEntry> collected_ss;
+
+	void Begin()
+	{
+		Grow(subsectormarks, level.subsectors.Size());
+		Grow(sectormarks, level.sectors.Size());
+		Grow(linemarks, level.lines.Size());
+		stamp++;
+	}
+
+	bool IsMarked(subsector_t *sub) const { return subsectormarks[sub->Index()] == stamp; }
+	bool IsMarked(sector_t *sec) const { return sectormarks[sec->Index()] == stamp; }
+	bool IsMarked(line_t *line) const { return linemarks[line->Index()] == stamp; }
+	void Mark(subsector_t *sub) { subsectormarks[sub->Index()] = stamp; }
+	void Mark(sector_t *sec) { sectormarks[sec->Index()] = stamp; }
+	void Mark(line_t *line) { linemarks[line->Index()] = stamp; }
+
+private:
+	static void Grow(TArray<int> &marks, unsigned int size)
+	{
+		unsigned int oldsize = marks.Size();
+		if (oldsize < size)
+		{
+			marks.Resize(size);
+			for (unsigned int i = oldsize; i < size; i++) marks[i] = 0;
+		}
+	}
+
+	TArray<int> subsectormarks;
+	TArray<int> sectormarks;
+	TArray<int> linemarks;
+	int stamp = 0;
+};
+
+void ADynamicLight::CollectWithinRadius(FLightLinkWalker &walker, FLightLinks &links, const DVector3 &opos, subsector_t *subSec, float radius)
 {
 	if (!subSec) return;
+	auto &collected_ss = walker.collected_ss;
 	collected_ss.Clear();
 	collected_ss.Push({ subSec, opos });
-	subSec->validcount = ::validcount;
+	walker.Mark(subSec);
 
 	bool hitonesidedback = false;
 	for (unsigned i = 0; i < collected_ss.Size(); i++)
 	{
 		subSec = collected_ss[i].sub;
 
-		touching_subsectors = AddLightNode(&subSec->lighthead, subSec, this, touching_subsectors);
-		if (subSec->sector->validcount != ::validcount)
+		links.subsectors.Push(subSec);
+		if (!walker.IsMarked(subSec->sector))
 		{
-			touching_sector = AddLightNode(&subSec->render_sector->lighthead, subSec->sector, this, touching_sector);
-			subSec->sector->validcount = ::validcount;
+			links.sectors.Push(subSec);
+			walker.Mark(subSec->sector);
 		}
 
 		for (unsigned int j = 0; j < subSec->numlines; ++j)
@@ -608,13 +671,13 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 			// If out of range we do not need to bother with this seg.
 			if (DistToSeg(pos, seg) <= radius)
 			{
-				if (seg->sidedef && seg->linedef && seg->linedef->validcount != ::validcount)
+				if (seg->sidedef && seg->linedef && !walker.IsMarked(seg->linedef))
 				{
 					// light is in front of the seg
 					if ((pos.Y - seg->v1->fY()) * (seg->v2->fX() - seg->v1->fX()) + (seg->v1->fX() - pos.X) * (seg->v2->fY() - seg->v1->fY()) <= 0)
 					{
-						seg->linedef->validcount = validcount;
-						touching_sides = AddLightNode(&seg->sidedef->lighthead, seg->sidedef, this, touching_sides);
+						walker.Mark(seg->linedef);
+						links.sides.Push(seg->sidedef);
 					}
 					else if (seg->linedef->sidedef[0] == seg->sidedef && seg->linedef->sidedef[1] == nullptr)
 					{
@@ -627,12 +690,12 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 					if (port && port->mType == PORTT_LINKED)
 					{
 						line_t *other = port->mDestination;
-						if (other->validcount != ::validcount)
+						if (!walker.IsMarked(other))
 						{
 							subsector_t *othersub = R_PointInSubsector(other->v1->fPos() + other->Delta() / 2);
-							if (othersub->validcount != ::validcount)
+							if (!walker.IsMarked(othersub))
 							{
-								othersub->validcount = ::validcount;
+								walker.Mark(othersub);
 								collected_ss.Push({ othersub, PosRelative(other) });
 							}
 						}
@@ -643,9 +706,9 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 				if (partner)
 				{
 					subsector_t *sub = partner->Subsector;
-					if (sub != NULL && sub->validcount != ::validcount)
+					if (sub != NULL && !walker.IsMarked(sub))
 					{
-						sub->validcount = ::validcount;
+						walker.Mark(sub);
 						collected_ss.Push({ sub, pos });
 					}
 				}
@@ -659,9 +722,9 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 			{
 				DVector2 refpos = other->v1->fPos() + other->Delta() / 2 + sec->GetPortalDisplacement(sector_t::ceiling);
 				subsector_t *othersub = R_PointInSubsector(refpos);
-				if (othersub->validcount != ::validcount)
+				if (!walker.IsMarked(othersub))
 				{
-					othersub->validcount = ::validcount;
+					walker.Mark(othersub);
 					collected_ss.Push({ othersub, PosRelative(othersub->sector) });
 				}
 			}
@@ -673,15 +736,37 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 			{
 				DVector2 refpos = other->v1->fPos() + other->Delta() / 2 + sec->GetPortalDisplacement(sector_t::floor);
 				subsector_t *othersub = R_PointInSubsector(refpos);
-				if (othersub->validcount != ::validcount)
+				if (!walker.IsMarked(othersub))
 				{
-					othersub->validcount = ::validcount;
+					walker.Mark(othersub);
 					collected_ss.Push({ othersub, PosRelative(othersub->sector) });
 				}
 			}
 		}
 	}
-	shadowmapped = hitonesidedback && !(lightflags & LF_NOSHADOWMAP);
+	links.shadowmapped = hitonesidedback && !(lightflags & LF_NOSHADOWMAP);
+}
+
+//==========================================================================
+//
+// Finds everything the light touches at its current position
+//
+//==========================================================================
+
+void ADynamicLight::CollectLinks(FLightLinkWalker &walker, FLightLinks &links)
+{
+	links.subsectors.Clear();
+	links.sectors.Clear();
+	links.sides.Clear();
+	links.shadowmapped = shadowmapped;
+
+	if (radius>0)
+	{
+		// passing in radius*radius allows us to do a distance check without any calls to sqrt
+		subsector_t * subSec = R_PointInSubsector(Pos());
+		walker.Begin();
+		CollectWithinRadius(walker, links, Pos(), subSec, float(radius*radius));
+	}
 }
 
 //==========================================================================
@@ -690,7 +775,7 @@ void ADynamicLight::CollectWithinRadius(const DVector3 &opos, subsector_t *subSe
 //
 //==========================================================================
 
-void ADynamicLight::LinkLight()
+void ADynamicLight::ApplyLinks(const FLightLinks &links)
 {
 	// mark the old light nodes
 	FLightNode * node;
@@ -714,14 +799,19 @@ void ADynamicLight::LinkLight()
 		node = node->nextTarget;
 	}
 
-	if (radius>0)
+	for (auto sub : links.subsectors)
 	{
-		// passing in radius*radius allows us to do a distance check without any calls to sqrt
-		subsector_t * subSec = R_PointInSubsector(Pos());
-		::validcount++;
-		CollectWithinRadius(Pos(), subSec, float(radius*radius));
-
+		touching_subsectors = AddLightNode(&sub->lighthead, sub, this, touching_subsectors);
+	}
+	for (auto sub : links.sectors)
+	{
+		touching_sector = AddLightNode(&sub->render_sector->lighthead, sub->sector, this, touching_sector);
 	}
+	for (auto side : links.sides)
+	{
+		touching_sides = AddLightNode(&side->lighthead, side, this, touching_sides);
+	}
+	shadowmapped = links.shadowmapped;
 		
 	// Now delete any nodes that won't be used. These are the ones where
 	// m_thing is still NULL.
@@ -760,6 +850,184 @@ void ADynamicLight::LinkLight()
 	}
 }
 
+//==========================================================================
+//
+// Relinking is deferred until the next frame gets rendered, so that a
+// light which moves several times in between only gets linked once and
+// the walks of all moved lights can be done in one go.
+//
+//==========================================================================
+
+static int PendingLinks;
+
+void ADynamicLight::LinkLight()
+{
+	if (!needslink)
+	{
+		needslink = true;
+		PendingLinks++;
+	}
+}
+
+//==========================================================================
+//
+// Runs the radius walks of all moved lights on worker threads.
+// Linking the results is cheap and stays on the main thread
+// because the light lists are shared between all lights.
+//
+//==========================================================================
+
+class FLightLinker
+{
+public:
+	void LinkLights(TArray<ADynamicLight *> &lights);
+	void StopThreads();
+
+private:
+	enum { MAX_THREADS = 8, MIN_PARALLEL_LIGHTS = 16 };
+
+	void StartThreads();
+	void WorkerMain(FLightLinkWalker *walker);
+	void Collect(FLightLinkWalker &walker);
+
+	TArray<ADynamicLight *> *mLights = nullptr;
+	TArray<FLightLinks> mLinks;
+	std::atomic<unsigned int> mNext;
+
+	FLightLinkWalker mWalkers[MAX_THREADS + 1];	// the last one belongs to the main thread
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mStartCondition;
+	std::condition_variable mDoneCondition;
+	int mGeneration = 0;
+	int mRunning = 0;
+	bool mStarted = false;
+	bool mShutdown = false;
+};
+
+static FLightLinker LightLinker;
+
+static void StopLightLinker()
+{
+	LightLinker.StopThreads();
+}
+
+void FLightLinker::StartThreads()
+{
+	mStarted = true;
+	int numthreads = clamp<int>((int)std::thread::hardware_concurrency() - 1, 0, MAX_THREADS);
+	for (int i = 0; i < numthreads; i++)
+	{
+		FLightLinkWalker *walker = &mWalkers[i];
+		mThreads.push_back(std::thread([=]() { WorkerMain(walker); }));
+	}
+	atterm(StopLightLinker);
+}
+
+void FLightLinker::StopThreads()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mShutdown = true;
+	lock.unlock();
+	mStartCondition.notify_all();
+	for (auto &thread : mThreads) thread.join();
+	mThreads.clear();
+}
+
+void FLightLinker::WorkerMain(FLightLinkWalker *walker)
+{
+	int generation = 0;
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mStartCondition.wait(lock, [&]() { return mShutdown || mGeneration != generation; });
+		if (mShutdown)
+			break;
+		generation = mGeneration;
+		lock.unlock();
+
+		Collect(*walker);
+
+		lock.lock();
+		mRunning--;
+		lock.unlock();
+		mDoneCondition.notify_all();
+	}
+}
+
+void FLightLinker::Collect(FLightLinkWalker &walker)
+{
+	auto &lights = *mLights;
+	while (true)
+	{
+		unsigned int i = mNext.fetch_add(1);
+		if (i >= lights.Size())
+			break;
+		lights[i]->CollectLinks(walker, mLinks[i]);
+	}
+}
+
+void FLightLinker::LinkLights(TArray<ADynamicLight *> &lights)
+{
+	mLights = &lights;
+	if (mLinks.Size() < lights.Size()) mLinks.Resize(lights.Size());
+	mNext.store(0);
+
+	if (r_multithreadedlights && lights.Size() >= MIN_PARALLEL_LIGHTS)
+	{
+		if (!mStarted) StartThreads();
+	}
+	if (r_multithreadedlights && lights.Size() >= MIN_PARALLEL_LIGHTS && mThreads.size() > 0)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mRunning = (int)mThreads.size();
+		mGeneration++;
+		lock.unlock();
+		mStartCondition.notify_all();
+
+		Collect(mWalkers[MAX_THREADS]);
+
+		lock.lock();
+		mDoneCondition.wait(lock, [&]() { return mRunning == 0; });
+	}
+	else
+	{
+		Collect(mWalkers[MAX_THREADS]);
+	}
+
+	for (unsigned int i = 0; i < lights.Size(); i++)
+	{
+		lights[i]->ApplyLinks(mLinks[i]);
+	}
+}
+
+//==========================================================================
+//
+// Called before a frame gets rendered
+//
+//==========================================================================
+
+void ADynamicLight::LinkPendingLights()
+{
+	static TArray<ADynamicLight *> lights;
+
+	if (PendingLinks == 0) return;
+	PendingLinks = 0;
+
+	TThinkerIterator<ADynamicLight> it(STAT_DLIGHT);
+	ADynamicLight *light;
+	while ((light = it.Next()) != nullptr)
+	{
+		if (light->needslink)
+		{
+			light->needslink = false;
+			lights.Push(light);
+		}
+	}
+	if (lights.Size() > 0) LightLinker.LinkLights(lights);
+	lights.Clear();
+}
+
 
 //==========================================================================
 //
@@ -9,6 +9,9 @@ EXTERN_CVAR(Bool, gl_attachedlights)
 class ADynamicLight;
 class FSerializer;
 class FLightDefaults;
+class FLightLinker;
+class FLightLinkWalker;
+struct FLightLinks;
 
 
 enum
@@ -76,6 +79,7 @@ struct FLightNode
 class ADynamicLight : public AActor
 {
 	friend class FLightDefaults;
+	friend class FLightLinker;
 	DECLARE_CLASS(ADynamicLight, AActor)
 public:
 	virtual void Tick();
@@ -87,6 +91,7 @@ public:
 	float GetRadius() const { return (IsActive() ? m_currentRadius * 2.f : 0.f); }
 	void LinkLight();
 	void UnlinkLight();
+	static void LinkPendingLights();
 	size_t PointerSubstitution(DObject *old, DObject *notOld);
 
 	void BeginPlay();
@@ -109,7 +114,9 @@ public:
 
 private:
 	double DistToSeg(const DVector3 &pos, seg_t *seg);
-	void CollectWithinRadius(const DVector3 &pos, subsector_t *subSec, float radius);
+	void CollectWithinRadius(FLightLinkWalker &walker, FLightLinks &links, const DVector3 &pos, subsector_t *subSec, float radius);
+	void CollectLinks(FLightLinkWalker &walker, FLightLinks &links);
+	void ApplyLinks(const FLightLinks &links);
 
 protected:
 	DVector3 m_off;
@@ -127,6 +134,7 @@ public:
 	bool visibletoplayer;
 	bool swapped;
 	bool shadowmapped;
+	bool needslink;
 	int bufferindex;
 	LightFlags lightflags;
 	DAngle SpotInnerAngle = 10.0;
@@ -60,14 +60,52 @@ FVertexBuffer::~FVertexBuffer()
 }
 
 
+//==========================================================================
+//
+// With persistent buffers the vertices get streamed into a ring that has
+// one section per frame in flight, instead of reallocating the buffer's
+// storage for each batch.
+//
+//==========================================================================
+
+static const unsigned int SIMPLE_SECTION_SIZE = 16384;
+
+FSimpleVertexBuffer::~FSimpleVertexBuffer()
+{
+	if (mMap != nullptr)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void FSimpleVertexBuffer::CreateStorage(unsigned int size)
+{
+	// Buffer storage is immutable so growing requires a new buffer.
+	// The old one stays alive until the GPU is done with it.
+	if (mMap != nullptr)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glDeleteBuffers(1, &vbo_id);
+		glGenBuffers(1, &vbo_id);
+	}
+	unsigned int bytesize = size * sizeof(FSimpleVertex);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+	glBufferStorage(GL_ARRAY_BUFFER, bytesize, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+	mMap = (FSimpleVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytesize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+	mSize = size;
+}
+
 void FSimpleVertexBuffer::BindVBO()
 {
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 	if (!gl.legacyMode)
 	{
-		glVertexAttribPointer(VATTR_VERTEX, 3, GL_FLOAT, false, sizeof(FSimpleVertex), &VSiO->x);
-		glVertexAttribPointer(VATTR_TEXCOORD, 2, GL_FLOAT, false, sizeof(FSimpleVertex), &VSiO->u);
-		glVertexAttribPointer(VATTR_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(FSimpleVertex), &VSiO->color);
+		glVertexAttribPointer(VATTR_VERTEX, 3, GL_FLOAT, false, sizeof(FSimpleVertex), &VSiO[mBase].x);
+		glVertexAttribPointer(VATTR_TEXCOORD, 2, GL_FLOAT, false, sizeof(FSimpleVertex), &VSiO[mBase].u);
+		glVertexAttribPointer(VATTR_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(FSimpleVertex), &VSiO[mBase].color);
 		glEnableVertexAttribArray(VATTR_VERTEX);
 		glEnableVertexAttribArray(VATTR_TEXCOORD);
 		glEnableVertexAttribArray(VATTR_COLOR);
@@ -76,9 +114,9 @@ void FSimpleVertexBuffer::BindVBO()
 	}
 	else
 	{
-		glVertexPointer(3, GL_FLOAT, sizeof(FSimpleVertex), &VSiO->x);
-		glTexCoordPointer(2, GL_FLOAT, sizeof(FSimpleVertex), &VSiO->u);
-		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(FSimpleVertex), &VSiO->color);
+		glVertexPointer(3, GL_FLOAT, sizeof(FSimpleVertex), &VSiO[mBase].x);
+		glTexCoordPointer(2, GL_FLOAT, sizeof(FSimpleVertex), &VSiO[mBase].u);
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(FSimpleVertex), &VSiO[mBase].color);
 		glEnableClientState(GL_VERTEX_ARRAY);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 		glEnableClientState(GL_COLOR_ARRAY);
@@ -114,10 +152,36 @@ void FSimpleVertexBuffer::EnableColorArray(bool on)
 
 void FSimpleVertexBuffer::set(FSimpleVertex *verts, int count)
 {
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+	if (gl.buffermethod == BM_PERSISTENT)
+	{
+		const unsigned int numframes = FGLRenderer::NUM_STREAM_FRAMES;
+		if (mMap == nullptr) CreateStorage(SIMPLE_SECTION_SIZE * numframes);
+
+		unsigned int section = mSize / numframes;
+		if (mFrame != GLRenderer->mStreamFrame)
+		{
+			mFrame = GLRenderer->mStreamFrame;
+			mWritePos = mFrame * section;
+		}
+		if (mWritePos + count > (mFrame + 1) * section)
+		{
+			// A new buffer is not in use by the GPU, so only the current frame's section needs to be valid.
+			while ((unsigned int)count > section) section *= 2;
+			CreateStorage(section * 2 * numframes);
+			section = mSize / numframes;
+			mWritePos = mFrame * section;
+		}
+		memcpy(&mMap[mWritePos], verts, count * sizeof(*verts));
+		mBase = mWritePos;
+		mWritePos += count;
+	}
+	else
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
+		glBufferData(GL_ARRAY_BUFFER, count * sizeof(*verts), verts, GL_STREAM_DRAW);
+	}
 	gl_RenderState.ResetVertexBuffer();
 	gl_RenderState.SetVertexBuffer(this);
-	glBufferData(GL_ARRAY_BUFFER, count * sizeof(*verts), verts, GL_STREAM_DRAW);
 }
 
 //==========================================================================
@@ -129,11 +193,14 @@ void FSimpleVertexBuffer::set(FSimpleVertex *verts, int count)
 FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 : FVertexBuffer(!gl.legacyMode)
 {
+	// Every frame in flight gets a section as large as the whole buffer was before it got split.
+	mBufferSize = gl.legacyMode ? BUFFER_SIZE : BUFFER_SIZE * FGLRenderer::NUM_STREAM_FRAMES;
+
 	switch (gl.buffermethod)
 	{
 	case BM_PERSISTENT:
 	{
-		unsigned int bytesize = BUFFER_SIZE * sizeof(FFlatVertex);
+		unsigned int bytesize = mBufferSize * sizeof(FFlatVertex);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 		glBufferStorage(GL_ARRAY_BUFFER, bytesize, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 		map = (FFlatVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytesize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
@@ -143,7 +210,7 @@ FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 
 	case BM_DEFERRED:
 	{
-		unsigned int bytesize = BUFFER_SIZE * sizeof(FFlatVertex);
+		unsigned int bytesize = mBufferSize * sizeof(FFlatVertex);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 		glBufferData(GL_ARRAY_BUFFER, bytesize, NULL, GL_STREAM_DRAW);
 		map = nullptr;
@@ -153,12 +220,14 @@ FFlatVertexBuffer::FFlatVertexBuffer(int width, int height)
 
 	default:
 	{
-		map = new FFlatVertex[BUFFER_SIZE];
+		map = new FFlatVertex[mBufferSize];
 		DPrintf(DMSG_NOTIFY, "Using client array buffer\n");
 		break;
 	}
 	}
 	mIndex = mCurIndex = 0;
+	mFrameStart = 0;
+	mFrameEnd = BUFFER_SIZE_TO_USE;
 	mNumReserved = NUM_RESERVED;
 	vbo_shadowdata.Resize(mNumReserved);
 
@@ -213,6 +282,13 @@ FFlatVertexBuffer::~FFlatVertexBuffer()
 		delete[] map;
 	}
 	map = nullptr;
+	if (mIndirectBuffer != 0)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+		glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		glDeleteBuffers(1, &mIndirectBuffer);
+	}
 }
 
 void FFlatVertexBuffer::OutputResized(int width, int height)
@@ -227,6 +303,138 @@ void FFlatVertexBuffer::OutputResized(int width, int height)
 	Unmap();
 }
 
+//==========================================================================
+//
+// Starts a new frame. The dynamic part of the buffer behind the static
+// flat data is split into one section per frame in flight so that the
+// GPU never reads from a part that is currently being written.
+//
+//==========================================================================
+
+void FFlatVertexBuffer::Reset()
+{
+	if (gl.legacyMode)
+	{
+		mFrameStart = mIndex;
+		mFrameEnd = BUFFER_SIZE_TO_USE;
+	}
+	else
+	{
+		unsigned int section = (mBufferSize - mIndex) / FGLRenderer::NUM_STREAM_FRAMES;
+		mFrameStart = mIndex + GLRenderer->mStreamFrame * section;
+		mFrameEnd = mFrameStart + section - (BUFFER_SIZE - BUFFER_SIZE_TO_USE);
+	}
+	mCurIndex = mFrameStart;
+}
+
+//==========================================================================
+//
+// The current frame's section is full and writing starts over at its
+// beginning. Draws from that section that were already issued must have
+// finished first or they would pick up the new data.
+//
+//==========================================================================
+
+void FFlatVertexBuffer::WrapFrame()
+{
+	if (!gl.legacyMode)
+	{
+		static bool warned;
+		if (!warned)
+		{
+			DPrintf(DMSG_WARNING, "Vertex buffer full, waiting for the GPU to catch up\n");
+			warned = true;
+		}
+		glFinish();
+	}
+	mCurIndex = mFrameStart;
+}
+
+//==========================================================================
+//
+// Gets room for 'count' indirect draw commands in this frame's section
+// of the indirect buffer and returns the index of the first one.
+//
+//==========================================================================
+
+static const unsigned int INDIRECT_SECTION_SIZE = 4096;
+
+unsigned int FFlatVertexBuffer::AllocIndirect(unsigned int count)
+{
+	const unsigned int numframes = FGLRenderer::NUM_STREAM_FRAMES;
+	unsigned int section = mIndirectSize / numframes;
+
+	if (mIndirectFrame != GLRenderer->mStreamFrame)
+	{
+		mIndirectFrame = GLRenderer->mStreamFrame;
+		mIndirectPos = mIndirectFrame * section;
+	}
+	if (mIndirectMap == nullptr || mIndirectPos + count > (mIndirectFrame + 1) * section)
+	{
+		// A new buffer is not in use by the GPU, so only the current frame's section needs to be valid.
+		if (section == 0) section = INDIRECT_SECTION_SIZE;
+		while (count > section) section *= 2;
+		if (mIndirectMap != nullptr)
+		{
+			section *= 2;
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+			glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER);
+			glDeleteBuffers(1, &mIndirectBuffer);
+		}
+		mIndirectSize = section * numframes;
+		unsigned int bytesize = mIndirectSize * sizeof(FDrawArraysCommand);
+		glGenBuffers(1, &mIndirectBuffer);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+		glBufferStorage(GL_DRAW_INDIRECT_BUFFER, bytesize, NULL, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+		mIndirectMap = (FDrawArraysCommand*)glMapBufferRange(GL_DRAW_INDIRECT_BUFFER, 0, bytesize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+		mIndirectPos = mIndirectFrame * section;
+	}
+	unsigned int pos = mIndirectPos;
+	mIndirectPos += count;
+	return pos;
+}
+
+//==========================================================================
+//
+// Submits everything collected since BeginBatch.
+// The render state must not have changed in between.
+//
+//==========================================================================
+
+void FFlatVertexBuffer::EndBatch()
+{
+	mBatching = false;
+	unsigned int count = mBatchFirst.Size();
+	if (count == 0) return;
+
+	drawcalls.Clock();
+	if (count == 1)
+	{
+		glDrawArrays(mBatchPrimType, mBatchFirst[0], mBatchCount[0]);
+	}
+	else if (gl.flags & RFL_MULTI_DRAW_INDIRECT)
+	{
+		unsigned int index = AllocIndirect(count);
+		FDrawArraysCommand *cmd = &mIndirectMap[index];
+		for (unsigned int i = 0; i < count; i++)
+		{
+			cmd[i].count = mBatchCount[i];
+			cmd[i].instanceCount = 1;
+			cmd[i].first = mBatchFirst[i];
+			cmd[i].baseInstance = 0;
+		}
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+		glMultiDrawArraysIndirect(mBatchPrimType, (void*)(intptr_t)(index * sizeof(FDrawArraysCommand)), count, 0);
+	}
+	else
+	{
+		glMultiDrawArrays(mBatchPrimType, &mBatchFirst[0], &mBatchCount[0], count);
+	}
+	drawcalls.Unclock();
+	mBatchFirst.Clear();
+	mBatchCount.Clear();
+}
+
 void FFlatVertexBuffer::BindVBO()
 {
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
@@ -254,7 +462,7 @@ void FFlatVertexBuffer::Map()
 {
 	if (gl.buffermethod == BM_DEFERRED)
 	{
-		unsigned int bytesize = BUFFER_SIZE * sizeof(FFlatVertex);
+		unsigned int bytesize = mBufferSize * sizeof(FFlatVertex);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 		gl_RenderState.ResetVertexBuffer();
 		map = (FFlatVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, bytesize, GL_MAP_WRITE_BIT|GL_MAP_UNSYNCHRONIZED_BIT);
@@ -265,7 +473,7 @@ void FFlatVertexBuffer::Unmap()
 {
 	if (gl.buffermethod == BM_DEFERRED)
 	{
-		unsigned int bytesize = BUFFER_SIZE * sizeof(FFlatVertex);
+		unsigned int bytesize = mBufferSize * sizeof(FFlatVertex);
 		glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 		gl_RenderState.ResetVertexBuffer();
 		glUnmapBuffer(GL_ARRAY_BUFFER);
@@ -450,7 +658,10 @@ void FFlatVertexBuffer::CreateVBO()
 {
 	vbo_shadowdata.Resize(mNumReserved);
 	CreateFlatVBO();
-	mCurIndex = mIndex = vbo_shadowdata.Size();
+	mIndex = vbo_shadowdata.Size();
+	Reset();
+	// The static data may overlap sections that are still in use by frames of the previous level.
+	if (!gl.legacyMode) glFinish();
 	Map();
 	memcpy(map, &vbo_shadowdata[0], vbo_shadowdata.Size() * sizeof(FFlatVertex));
 	Unmap();
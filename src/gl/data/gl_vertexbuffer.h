@@ -94,24 +94,59 @@ struct FSimpleVertex
 
 class FSimpleVertexBuffer : public FVertexBuffer
 {
-	TArray<FSimpleVertex> mBuffer;
+	FSimpleVertex *mMap = nullptr;	// persistent mapping, only with BM_PERSISTENT
+	unsigned int mSize = 0;			// in vertices, covering all frame sections
+	unsigned int mBase = 0;			// where the data of the last set() call starts
+	unsigned int mWritePos = 0;
+	int mFrame = -1;
+
+	void CreateStorage(unsigned int size);
+
 public:
 	FSimpleVertexBuffer()
 	{
 	}
+	~FSimpleVertexBuffer();
 	void BindVBO();
 	void set(FSimpleVertex *verts, int count);
 	void EnableColorArray(bool on);
 };
 
+struct FDrawArraysCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t first;
+	uint32_t baseInstance;
+};
+
 class FFlatVertexBuffer : public FVertexBuffer
 {
 	FFlatVertex *map;
 	unsigned int mIndex;
 	unsigned int mCurIndex;
 	unsigned int mNumReserved;
+	unsigned int mFrameStart;	// section of the dynamic part of the buffer used by the current frame
+	unsigned int mFrameEnd;
+	unsigned int mBufferSize;	// in vertices, BUFFER_SIZE for each frame section
+
+	// Draws collected between BeginBatch and EndBatch.
+	bool mBatching = false;
+	unsigned int mBatchPrimType;
+	TArray<int> mBatchFirst;
+	TArray<int> mBatchCount;
+
+	// Streaming buffer for the indirect draw commands, split into per-frame sections like the vertex data.
+	unsigned int mIndirectBuffer = 0;
+	FDrawArraysCommand *mIndirectMap = nullptr;
+	unsigned int mIndirectSize = 0;
+	unsigned int mIndirectPos = 0;
+	int mIndirectFrame = -1;
+
+	unsigned int AllocIndirect(unsigned int count);
 
 	void CheckPlanes(sector_t *sector);
+	void WrapFrame();
 
 	static const unsigned int BUFFER_SIZE = 2000000;
 	static const unsigned int BUFFER_SIZE_TO_USE = 1999500;
@@ -149,7 +184,7 @@ public:
 		FFlatVertex *p = GetBuffer();
 		*poffset = mCurIndex;
 		mCurIndex += num;
-		if (mCurIndex >= BUFFER_SIZE_TO_USE) mCurIndex = mIndex;
+		if (mCurIndex >= mFrameEnd) WrapFrame();
 		return p;
 	}
 
@@ -159,12 +194,20 @@ public:
 		unsigned int diff = newofs - mCurIndex;
 		*poffset = mCurIndex;
 		mCurIndex = newofs;
-		if (mCurIndex >= BUFFER_SIZE_TO_USE) mCurIndex = mIndex;
+		if (mCurIndex >= mFrameEnd) WrapFrame();
 		return diff;
 	}
 #ifdef __GL_PCH_H	// we need the system includes for this but we cannot include them ourselves without creating #define clashes. The affected files wouldn't try to draw anyway.
 	void RenderArray(unsigned int primtype, unsigned int offset, unsigned int count)
 	{
+		if (mBatching)
+		{
+			// all draws of a batch must use the same primitive type.
+			mBatchPrimType = primtype;
+			mBatchFirst.Push(offset);
+			mBatchCount.Push(count);
+			return;
+		}
 		drawcalls.Clock();
 		glDrawArrays(primtype, offset, count);
 		drawcalls.Unclock();
@@ -180,14 +223,21 @@ public:
 	}
 
 #endif
-	void Reset()
-	{
-		mCurIndex = mIndex;
-	}
+	void Reset();
 
 	void Map();
 	void Unmap();
 
+	void BeginBatch()
+	{
+		mBatching = true;
+	}
+	bool IsBatching() const
+	{
+		return mBatching;
+	}
+	void EndBatch();
+
 private:
 	int CreateSubsectorVertices(subsector_t *sub, const secplane_t &plane, int floor);
 	int CreateSectorVertices(sector_t *sec, const secplane_t &plane, int floor);
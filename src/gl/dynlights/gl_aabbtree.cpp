@@ -24,8 +24,10 @@
 #include "gl/shaders/gl_shader.h"
 #include "gl/dynlights/gl_aabbtree.h"
 #include "gl/system/gl_interface.h"
+#include "gl/renderer/gl_renderer.h"
 #include "r_state.h"
 #include "g_levellocals.h"
+#include "p_tags.h"
 
 LevelAABBTree::LevelAABBTree()
 {
@@ -42,7 +44,7 @@ LevelAABBTree::LevelAABBTree()
 	TArray<int> line_elements;
 	for (unsigned int i = 0; i < level.lines.Size(); i++)
 	{
-		if (!level.lines[i].backsector)
+		if (!level.lines[i].backsector || IsDynamicLine(level.lines[i]))
 		{
 			line_elements.Push(i);
 		}
@@ -55,17 +57,141 @@ LevelAABBTree::LevelAABBTree()
 	// Generate the AABB tree
 	GenerateTreeNode(&line_elements[0], (int)line_elements.Size(), &centroids[0], &work_buffer[0]);
 
+	// Find the parent of each node and the leaf of each line so that the tree can be refit later
+	line_leafs.Resize(level.lines.Size());
+	for (unsigned int i = 0; i < level.lines.Size(); i++)
+		line_leafs[i] = -1;
+	node_parents.Resize(nodes.Size());
+	for (unsigned int i = 0; i < nodes.Size(); i++)
+		node_parents[i] = -1;
+	for (unsigned int i = 0; i < nodes.Size(); i++)
+	{
+		const auto &node = nodes[i];
+		if (node.line_index != -1)
+		{
+			line_leafs[node.line_index] = i;
+		}
+		else
+		{
+			node_parents[node.left_node] = i;
+			node_parents[node.right_node] = i;
+		}
+	}
+
 	// Add the lines referenced by the leaf nodes
 	lines.Resize(level.lines.Size());
 	for (unsigned int i = 0; i < level.lines.Size(); i++)
 	{
-		const auto &line = level.lines[i];
-		auto &treeline = lines[i];
+		UpdateLine(i);
+	}
+
+	// Everything that happened before is already part of the tree
+	level.ChangedLines.Clear();
+}
+
+bool LevelAABBTree::IsDynamicLine(const line_t &line)
+{
+	// Closed doors and anything that can be moved by a tagged special.
+	// Adding all two-sided lines would make the tree a lot deeper than necessary.
+	if (gl_CheckClip(line.sidedef[0], line.frontsector, line.backsector))
+		return true;
+	return tagManager.SectorHasTags(line.frontsector) || tagManager.SectorHasTags(line.backsector);
+}
+
+void LevelAABBTree::UpdateLine(int line_index)
+{
+	const auto &line = level.lines[line_index];
+	auto &treeline = lines[line_index];
+
+	treeline.x = (float)line.v1->fX();
+	treeline.y = (float)line.v1->fY();
+	treeline.dx = (float)line.v2->fX() - treeline.x;
+	treeline.dy = (float)line.v2->fY() - treeline.y;
+
+	// A line without length can never be hit by a ray.
+	if (line.backsector && line_leafs[line_index] != -1 && !gl_CheckClip(line.sidedef[0], line.frontsector, line.backsector))
+	{
+		treeline.dx = 0.0f;
+		treeline.dy = 0.0f;
+	}
+}
+
+bool LevelAABBTree::Update()
+{
+	nodes_changed_start = nodes.Size();
+	nodes_changed_end = 0;
+	lines_changed_start = lines.Size();
+	lines_changed_end = 0;
+
+	auto &changed = level.ChangedLines;
+	if (changed.Size() == 0 || nodes.Size() == 0)
+	{
+		changed.Clear();
+		return false;
+	}
+
+	if (changed.Size() >= level.lines.Size())
+	{
+		for (unsigned int i = 0; i < level.lines.Size(); i++)
+			RefitLine(i);
+	}
+	else
+	{
+		for (unsigned int i = 0; i < changed.Size(); i++)
+			RefitLine(changed[i]);
+	}
+	changed.Clear();
+
+	return nodes_changed_start < nodes_changed_end || lines_changed_start < lines_changed_end;
+}
+
+void LevelAABBTree::RefitLine(int line_index)
+{
+	int node_index = line_leafs[line_index];
+	if (node_index == -1)
+		return;
+
+	AABBTreeLine oldline = lines[line_index];
+	UpdateLine(line_index);
+	const AABBTreeLine &treeline = lines[line_index];
+	if (treeline.x != oldline.x || treeline.y != oldline.y || treeline.dx != oldline.dx || treeline.dy != oldline.dy)
+	{
+		lines_changed_start = MIN(lines_changed_start, line_index);
+		lines_changed_end = MAX(lines_changed_end, line_index + 1);
+	}
+
+	// The leaf always covers the full line, even while it is collapsed, so opening and closing alone does not change any nodes.
+	const auto &line = level.lines[line_index];
+	float left = (float)MIN(line.v1->fX(), line.v2->fX());
+	float top = (float)MIN(line.v1->fY(), line.v2->fY());
+	float right = (float)MAX(line.v1->fX(), line.v2->fX());
+	float bottom = (float)MAX(line.v1->fY(), line.v2->fY());
+
+	while (node_index != -1)
+	{
+		auto &node = nodes[node_index];
+		if (node.line_index == -1)
+		{
+			const auto &left_node = nodes[node.left_node];
+			const auto &right_node = nodes[node.right_node];
+			left = MIN(left_node.aabb_left, right_node.aabb_left);
+			top = MIN(left_node.aabb_top, right_node.aabb_top);
+			right = MAX(left_node.aabb_right, right_node.aabb_right);
+			bottom = MAX(left_node.aabb_bottom, right_node.aabb_bottom);
+		}
+
+		// Parents of an unchanged node do not need to be looked at.
+		if (node.aabb_left == left && node.aabb_top == top && node.aabb_right == right && node.aabb_bottom == bottom)
+			break;
+
+		node.aabb_left = left;
+		node.aabb_top = top;
+		node.aabb_right = right;
+		node.aabb_bottom = bottom;
+		nodes_changed_start = MIN(nodes_changed_start, node_index);
+		nodes_changed_end = MAX(nodes_changed_end, node_index + 1);
 
-		treeline.x = (float)line.v1->fX();
-		treeline.y = (float)line.v1->fY();
-		treeline.dx = (float)line.v2->fX() - treeline.x;
-		treeline.dy = (float)line.v2->fY() - treeline.y;
+		node_index = node_parents[node_index];
 	}
 }
 
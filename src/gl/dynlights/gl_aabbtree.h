@@ -3,6 +3,8 @@
 
 #include "vectors.h"
 
+struct line_t;
+
 // Node in a binary AABB tree
 struct AABBTreeNode
 {
@@ -47,6 +49,13 @@ public:
 	// Shoot a ray from ray_start to ray_end and return the closest hit as a fractional value between 0 and 1. Returns 1 if no line was hit.
 	double RayTest(const DVector3 &ray_start, const DVector3 &ray_end);
 
+	// Refit the tree for the lines in level.ChangedLines. Returns true if any node or line changed.
+	bool Update();
+
+	// Nodes and lines changed by the last Update call. The end is exclusive.
+	int nodes_changed_start = 0, nodes_changed_end = 0;
+	int lines_changed_start = 0, lines_changed_end = 0;
+
 private:
 	// Test if a ray overlaps an AABB node or not
 	bool OverlapRayAABB(const DVector2 &ray_start2d, const DVector2 &ray_end2d, const AABBTreeNode &node);
@@ -56,4 +65,19 @@ private:
 
 	// Generate a tree node and its children recursively
 	int GenerateTreeNode(int *lines, int num_lines, const FVector2 *centroids, int *work_buffer);
+
+	// Test if a two-sided line can ever block and thus needs to be in the tree
+	static bool IsDynamicLine(const line_t &line);
+
+	// Copy the current position of a line. Two-sided lines become zero length while their opening is not closed.
+	void UpdateLine(int line_index);
+
+	// Update the leaf of a line and grow or shrink its parent nodes to match
+	void RefitLine(int line_index);
+
+	// Leaf node index for each line, or -1 if the line is not in the tree
+	TArray<int> line_leafs;
+
+	// Parent node index for each node, or -1 for the root
+	TArray<int> node_parents;
 };
@@ -30,6 +30,7 @@
 #include "gl/dynlights/gl_lightbuffer.h"
 #include "gl/dynlights/gl_dynlight.h"
 #include "gl/system/gl_interface.h"
+#include "gl/renderer/gl_renderer.h"
 #include "gl/utility//gl_clock.h"
 
 static const int INITIAL_BUFFER_SIZE = 160000;	// This means 80000 lights per frame and 160000*16 bytes == 2.56 MB.
@@ -67,6 +68,7 @@ FLightBuffer::FLightBuffer()
 		mBufferPointer = NULL;
 	}
 
+	mNeedsSync = false;
 	Clear();
 	mLastMappedIndex = UINT_MAX;
 }
@@ -79,7 +81,18 @@ FLightBuffer::~FLightBuffer()
 
 void FLightBuffer::Clear()
 {
-	mIndex = 0;
+	if (mNeedsSync)
+	{
+		// The buffer got reallocated during the last frame and its data may overlap any section of the new one.
+		glFinish();
+		mNeedsSync = false;
+	}
+
+	// Each frame in flight writes to its own section of the buffer.
+	unsigned int section = mBufferSize / 4 / FGLRenderer::NUM_STREAM_FRAMES;
+	if (mBlockAlign > 0) section -= section % mBlockAlign;
+	mIndex = GLRenderer->mStreamFrame * section;
+	mFrameEnd = mIndex + section;
 	mIndices.Clear();
 	mUploadIndex = 0;
 }
@@ -118,7 +131,7 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 
 	if (totalsize <= 1) return -1;
 
-	if (mIndex + totalsize > mBufferSize/4)
+	if (mIndex + totalsize > mFrameEnd)
 	{
 		// reallocate the buffer with twice the size
 		unsigned int newbuffer;
@@ -152,6 +165,10 @@ int FLightBuffer::UploadLights(FDynLightData &data)
 		glBindBuffer(GL_COPY_READ_BUFFER, 0);
 		glDeleteBuffers(1, &mBufferId);
 		mBufferId = newbuffer;
+
+		// nothing else is using the new buffer yet so this frame may fill all of it.
+		mFrameEnd = mBufferSize / 4;
+		mNeedsSync = true;
 	}
 
 	float *copyptr;
@@ -178,7 +195,8 @@ void FLightBuffer::Begin()
 	if (gl.lightmethod == LM_DEFERRED)
 	{
 		glBindBuffer(mBufferType, mBufferId);
-		mBufferPointer = (float*)glMapBufferRange(mBufferType, 0, mByteSize, GL_MAP_WRITE_BIT);
+		// The section being written is fenced off from the GPU so there is no need for the driver to synchronize.
+		mBufferPointer = (float*)glMapBufferRange(mBufferType, 0, mByteSize, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
 	}
 }
 
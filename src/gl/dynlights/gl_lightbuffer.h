@@ -12,12 +12,14 @@ class FLightBuffer
 
 	unsigned int mBufferType;
 	unsigned int mIndex;
+	unsigned int mFrameEnd;		// end of the buffer section the current frame writes to
 	unsigned int mUploadIndex;
 	unsigned int mLastMappedIndex;
 	unsigned int mBlockAlign;
 	unsigned int mBlockSize;
 	unsigned int mBufferSize;
 	unsigned int mByteSize;
+	bool mNeedsSync;
 
 public:
 
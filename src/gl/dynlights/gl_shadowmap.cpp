@@ -214,7 +214,11 @@ void FShadowMap::UploadAABBTree()
 		Clear();
 
 	if (mAABBTree)
+	{
+		if (mAABBTree->Update())
+			UploadAABBTreeChanges();
 		return;
+	}
 
 	mAABBTree.reset(new LevelAABBTree());
 
@@ -232,6 +236,30 @@ void FShadowMap::UploadAABBTree()
 	glBindBuffer(GL_SHADER_STORAGE_BUFFER, oldBinding);
 }
 
+void FShadowMap::UploadAABBTreeChanges()
+{
+	int oldBinding = 0;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_BINDING, &oldBinding);
+
+	int start = mAABBTree->nodes_changed_start;
+	int end = mAABBTree->nodes_changed_end;
+	if (start < end)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, mNodesBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(AABBTreeNode) * start, sizeof(AABBTreeNode) * (end - start), &mAABBTree->nodes[start]);
+	}
+
+	start = mAABBTree->lines_changed_start;
+	end = mAABBTree->lines_changed_end;
+	if (start < end)
+	{
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, mLinesBuffer);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(AABBTreeLine) * start, sizeof(AABBTreeLine) * (end - start), &mAABBTree->lines[start]);
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, oldBinding);
+}
+
 void FShadowMap::Clear()
 {
 	if (mLightList != 0)
@@ -33,6 +33,9 @@ private:
 	// Upload the AABB-tree to the GPU
 	void UploadAABBTree();
 
+	// Upload the parts of the AABB-tree that changed since the last frame
+	void UploadAABBTreeChanges();
+
 	// Upload light list to the GPU
 	void UploadLights();
 
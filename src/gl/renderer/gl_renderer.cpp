@@ -51,6 +51,7 @@
 #include "gl/data/gl_vertexbuffer.h"
 #include "gl/scene/gl_drawinfo.h"
 #include "gl/scene/gl_portal.h"
+#include "gl/scene/gl_bspworker.h"
 #include "gl/shaders/gl_shader.h"
 #include "gl/shaders/gl_ambientshader.h"
 #include "gl/shaders/gl_bloomshader.h"
@@ -107,6 +108,9 @@ FGLRenderer::FGLRenderer(OpenGLFrameBuffer *fb)
 	gllight = glpart2 = glpart = mirrortexture = nullptr;
 	mLights = nullptr;
 	m2DDrawer = nullptr;
+	mBSPWorker = nullptr;
+	for (auto &fence : mStreamFences) fence = nullptr;
+	mStreamFrame = 0;
 	mTonemapPalette = nullptr;
 	mBuffers = nullptr;
 	mPresentShader = nullptr;
@@ -182,6 +186,7 @@ void FGLRenderer::Initialize(int width, int height)
 	if (!gl.legacyMode) mLights = new FLightBuffer();
 	else mLights = NULL;
 	gl_RenderState.SetVertexBuffer(mVBO);
+	mBSPWorker = new FBSPWorker;
 	mFBID = 0;
 	mOldFBID = 0;
 
@@ -206,6 +211,8 @@ FGLRenderer::~FGLRenderer()
 	if (mVBO != NULL) delete mVBO;
 	if (mSkyVBO != NULL) delete mSkyVBO;
 	if (mLights != NULL) delete mLights;
+	if (mBSPWorker != nullptr) delete mBSPWorker;
+	for (auto fence : mStreamFences) if (fence != nullptr) glDeleteSync(fence);
 	if (glpart2) delete glpart2;
 	if (glpart) delete glpart;
 	if (gllight) delete gllight;
@@ -241,6 +248,35 @@ FGLRenderer::~FGLRenderer()
 	delete mFXAALumaShader;
 }
 
+//==========================================================================
+//
+// Called after a frame has been submitted. Fences the buffer sections
+// the frame wrote to and waits until the GPU is done with the sections
+// the next frame is going to overwrite.
+//
+//==========================================================================
+
+void FGLRenderer::NextStreamFrame()
+{
+	if (gl.legacyMode) return;
+
+	if (mStreamFences[mStreamFrame] != nullptr) glDeleteSync(mStreamFences[mStreamFrame]);
+	mStreamFences[mStreamFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	mStreamFrame = (mStreamFrame + 1) % NUM_STREAM_FRAMES;
+	GLsync fence = mStreamFences[mStreamFrame];
+	if (fence != nullptr)
+	{
+		GLenum result;
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		mStreamFences[mStreamFrame] = nullptr;
+	}
+}
+
 //==========================================================================
 //
 // Calculates the viewport values needed for 2D and 3D operations
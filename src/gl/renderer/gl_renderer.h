@@ -9,6 +9,7 @@
 #include "gl/dynlights/gl_shadowmap.h"
 
 struct particle_t;
+struct __GLsync;
 class FCanvasTexture;
 class FFlatVertexBuffer;
 class FSkyVertexBuffer;
@@ -17,6 +18,7 @@ struct FDrawInfo;
 class FShaderManager;
 class GLPortal;
 class FLightBuffer;
+class FBSPWorker;
 class FSamplerManager;
 class DPSprite;
 class FGLRenderBuffers;
@@ -145,6 +147,12 @@ public:
 	FSkyVertexBuffer *mSkyVBO;
 	FLightBuffer *mLights;
 	F2DDrawer *m2DDrawer;
+	FBSPWorker *mBSPWorker;
+
+	// The streaming buffers are split into one section per frame the GPU may still be working on.
+	enum { NUM_STREAM_FRAMES = 3 };
+	__GLsync *mStreamFences[NUM_STREAM_FRAMES];
+	int mStreamFrame;
 
 	GL_IRECT mScreenViewport;
 	GL_IRECT mSceneViewport;
@@ -188,6 +196,7 @@ public:
 	void CopyToBackbuffer(const GL_IRECT *bounds, bool applyGamma);
 	void DrawPresentTexture(const GL_IRECT &box, bool applyGamma);
 	void Flush();
+	void NextStreamFrame();
 
 
 	bool StartOffscreen();
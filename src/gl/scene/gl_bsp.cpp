@@ -48,6 +48,93 @@ EXTERN_CVAR(Bool, gl_render_segs)
 CVAR(Bool, gl_render_things, true, 0)
 CVAR(Bool, gl_render_walls, true, 0)
 CVAR(Bool, gl_render_flats, true, 0)
+CVAR(Bool, gl_multithread, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+//==========================================================================
+//
+// Hands a piece of visible geometry to the BSP worker or,
+// if that is disabled, processes it right away.
+//
+//==========================================================================
+
+void GLSceneDrawer::QueueJob(int type, subsector_t *sub, area_t frontarea, seg_t *seg, int backtype, FPortal *portal)
+{
+	FRenderJob job;
+	job.type = uint8_t(type);
+	job.backtype = uint8_t(backtype);
+	job.frontarea = uint8_t(frontarea);
+	job.area = uint8_t(in_area);
+	job.sub = sub;
+	job.seg = seg;
+	job.portal = portal;
+
+	if (multithread) GLRenderer->mBSPWorker->Push(job);
+	else ExecuteJob(job);
+}
+
+//==========================================================================
+//
+// Geometry processing for one job. This may run on the BSP worker so it
+// must not touch anything the traversal uses for clipping.
+//
+//==========================================================================
+
+void GLSceneDrawer::ExecuteJob(const FRenderJob &job)
+{
+	sector_t fake, backfake;
+	sector_t *front;
+
+	process_area = area_t(job.area);
+
+	switch (job.type)
+	{
+	case FRenderJob::WallJob:
+	{
+		SetupWall.Clock();
+		front = gl_FakeFlat(job.sub->sector, &fake, area_t(job.frontarea), false);
+		sector_t *back = nullptr;
+		if (job.backtype == FRenderJob::BackFront) back = front;
+		else if (job.backtype == FRenderJob::BackFake) back = gl_FakeFlat(job.seg->backsector, &backfake, area_t(job.area), true);
+
+		GLWall wall(this);
+		wall.sub = job.sub;
+		wall.Process(job.seg, front, back);
+		rendered_lines++;
+		SetupWall.Unclock();
+		break;
+	}
+
+	case FRenderJob::ParticleJob:
+		SetupSprite.Clock();
+		front = gl_FakeFlat(job.sub->sector, &fake, area_t(job.frontarea), false);
+		for (int i = ParticlesInSubsec[job.sub->Index()]; i != NO_PARTICLE; i = Particles[i].snext)
+		{
+			GLSprite sprite(this);
+			sprite.ProcessParticle(&Particles[i], front);
+		}
+		SetupSprite.Unclock();
+		break;
+
+	case FRenderJob::ThingJob:
+		front = gl_FakeFlat(job.sub->sector, &fake, area_t(job.frontarea), false);
+		RenderThings(job.sub, front);
+		break;
+
+	case FRenderJob::FlatJob:
+	{
+		SetupFlat.Clock();
+		front = gl_FakeFlat(job.sub->render_sector, &fake, area_t(job.frontarea), false);
+		GLFlat flat(this);
+		flat.ProcessSector(front);
+		SetupFlat.Unclock();
+		break;
+	}
+
+	case FRenderJob::PortalJob:
+		job.portal->GetRenderState()->AddSubsector(job.sub);
+		break;
+	}
+}
 
 void GLSceneDrawer::UnclipSubsector(subsector_t *sub)
 {
@@ -88,6 +175,7 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
 
 	sector_t * backsector = NULL;
 	sector_t bs;
+	int backtype = FRenderJob::BackNone;
 
 	if (portalclip)
 	{
@@ -143,6 +231,7 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
 				}
 			}
 			backsector=currentsector;
+			backtype = FRenderJob::BackFront;
 		}
 		else
 		{
@@ -150,6 +239,7 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
 			CheckViewArea(seg->v1, seg->v2, seg->frontsector, seg->backsector);
 
 			backsector = gl_FakeFlat(seg->backsector, &bs, in_area, true);
+			backtype = FRenderJob::BackFake;
 
 			if (gl_CheckClip(seg->sidedef, currentsector, backsector))
 			{
@@ -161,9 +251,15 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
 	{
 		// Backsector for polyobj segs is always the containing sector itself
 		backsector = currentsector;
+		backtype = FRenderJob::BackFront;
 	}
 
-	seg->linedef->flags |= ML_MAPPED;
+	if (!(seg->linedef->flags & ML_MAPPED))
+	{
+		// The worker reads the line flags so they may not be changed while it runs.
+		if (multithread) mappedlines.Push(seg->linedef);
+		else seg->linedef->flags |= ML_MAPPED;
+	}
 
 	if (ispoly || seg->linedef->validcount!=validcount) 
 	{
@@ -171,14 +267,7 @@ void GLSceneDrawer::AddLine (seg_t *seg, bool portalclip)
 
 		if (gl_render_walls)
 		{
-			SetupWall.Clock();
-
-			GLWall wall(this);
-			wall.sub = currentsubsector;
-			wall.Process(seg, currentsector, backsector);
-			rendered_lines++;
-
-			SetupWall.Unclock();
+			QueueJob(FRenderJob::WallJob, currentsubsector, currentarea, seg, backtype);
 		}
 	}
 }
@@ -407,7 +496,6 @@ void GLSceneDrawer::RenderThings(subsector_t * sub, sector_t * sector)
 
 void GLSceneDrawer::DoSubsector(subsector_t * sub)
 {
-	unsigned int i;
 	sector_t * sector;
 	sector_t * fakesector;
 	sector_t fake;
@@ -436,6 +524,7 @@ void GLSceneDrawer::DoSubsector(subsector_t * sub)
 	if (clipper.IsBlocked()) return;	// if we are inside a stacked sector portal which hasn't unclipped anything yet.
 
 	fakesector=gl_FakeFlat(sector, &fake, in_area, false);
+	currentarea = in_area;
 
 	if (GLRenderer->mClipPortal)
 	{
@@ -456,16 +545,9 @@ void GLSceneDrawer::DoSubsector(subsector_t * sub)
 
 	// [RH] Add particles
 	//int shade = LIGHT2SHADE((floorlightlevel + ceilinglightlevel)/2 + r_actualextralight);
-	if (gl_render_things)
+	if (gl_render_things && ParticlesInSubsec[sub->Index()] != NO_PARTICLE)
 	{
-		SetupSprite.Clock();
-
-		for (i = ParticlesInSubsec[sub->Index()]; i != NO_PARTICLE; i = Particles[i].snext)
-		{
-			GLSprite sprite(this);
-			sprite.ProcessParticle(&Particles[i], fakesector);
-		}
-		SetupSprite.Unclock();
+		QueueJob(FRenderJob::ParticleJob, sub, currentarea);
 	}
 
 	AddLines(sub, fakesector);
@@ -481,9 +563,14 @@ void GLSceneDrawer::DoSubsector(subsector_t * sub)
 
 		if (gl_render_things)
 		{
-			RenderThings(sub, fakesector);
+			QueueJob(FRenderJob::ThingJob, sub, currentarea);
+		}
+		if (!(sector->MoreFlags & SECF_DRAWN))
+		{
+			// Same for the sector flags.
+			if (multithread) drawnsectors.Push(sector);
+			else sector->MoreFlags |= SECF_DRAWN;
 		}
-		sector->MoreFlags |= SECF_DRAWN;
 	}
 
 	if (gl_render_flats)
@@ -497,23 +584,21 @@ void GLSceneDrawer::DoSubsector(subsector_t * sub)
 			// Due to the way a BSP works such a subsector can never be visible
 			if (!sector->heightsec || sector->heightsec->MoreFlags & SECF_IGNOREHEIGHTSEC || in_area!=area_default)
 			{
+				area_t flatarea = currentarea;
 				if (sector != sub->render_sector)
 				{
 					sector = sub->render_sector;
 					// the planes of this subsector are faked to belong to another sector
 					// This means we need the heightsec parts and light info of the render sector, not the actual one.
 					fakesector = gl_FakeFlat(sector, &fake, in_area, false);
+					flatarea = in_area;
 				}
 
-				uint8_t &srf = gl_drawinfo->sectorrenderflags[sub->render_sector->sectornum];
+				uint8_t &srf = gl_drawinfo->sectorprocessflags[sub->render_sector->sectornum];
 				if (!(srf & SSRF_PROCESSED))
 				{
 					srf |= SSRF_PROCESSED;
-
-					SetupFlat.Clock();
-					GLFlat flat(this);
-					flat.ProcessSector(fakesector);
-					SetupFlat.Unclock();
+					QueueJob(FRenderJob::FlatJob, sub, flatarea);
 				}
 				// mark subsector as processed - but mark for rendering only if it has an actual area.
 				gl_drawinfo->ss_renderflags[sub->Index()] = 
@@ -525,15 +610,13 @@ void GLSceneDrawer::DoSubsector(subsector_t * sub)
 				portal = fakesector->GetGLPortal(sector_t::ceiling);
 				if (portal != NULL)
 				{
-					GLSectorStackPortal *glportal = portal->GetRenderState();
-					glportal->AddSubsector(sub);
+					QueueJob(FRenderJob::PortalJob, sub, flatarea, nullptr, FRenderJob::BackNone, portal);
 				}
 
 				portal = fakesector->GetGLPortal(sector_t::floor);
 				if (portal != NULL)
 				{
-					GLSectorStackPortal *glportal = portal->GetRenderState();
-					glportal->AddSubsector(sub);
+					QueueJob(FRenderJob::PortalJob, sub, flatarea, nullptr, FRenderJob::BackNone, portal);
 				}
 			}
 		}
@@ -0,0 +1,169 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2018 GZDoom maintainers
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** gl_bspworker.cpp
+** Geometry processing thread for the BSP traversal
+**
+**/
+
+#include "gl/scene/gl_bspworker.h"
+#include "gl/scene/gl_scenedrawer.h"
+
+FBSPWorker::FBSPWorker()
+	: mReadIndex(0), mWriteIndex(0), mFinishing(false), mWorkerWaiting(false), mProducerWaiting(false)
+{
+}
+
+FBSPWorker::~FBSPWorker()
+{
+	if (mThread.joinable())
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mShutdown = true;
+		lock.unlock();
+		mCondition.notify_all();
+		mThread.join();
+	}
+}
+
+//==========================================================================
+//
+// Starts consuming jobs for a new scene
+//
+//==========================================================================
+
+void FBSPWorker::Begin(GLSceneDrawer *drawer)
+{
+	if (!mThread.joinable())
+	{
+		mThread = std::thread([=]() { WorkerMain(); });
+	}
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	mReadIndex.store(0, std::memory_order_relaxed);
+	mWriteIndex.store(0, std::memory_order_relaxed);
+	mFinishing.store(false, std::memory_order_relaxed);
+	mDrawer = drawer;
+	mActive = true;
+	lock.unlock();
+	mCondition.notify_all();
+}
+
+//==========================================================================
+//
+// Queues a job. Only ever called by the traversal thread.
+//
+//==========================================================================
+
+void FBSPWorker::Push(const FRenderJob &job)
+{
+	unsigned int write = mWriteIndex.load(std::memory_order_relaxed);
+	if (write - mReadIndex.load() == QUEUE_SIZE)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mProducerWaiting = true;
+		mCondition.wait(lock, [&]() { return write - mReadIndex.load() != QUEUE_SIZE; });
+		mProducerWaiting = false;
+	}
+	mJobs[write & (QUEUE_SIZE - 1)] = job;
+	mWriteIndex.store(write + 1);
+
+	// Waking up the worker for every single job would cost more than the job itself.
+	if ((write + 1) % WAKE_BATCH == 0 && mWorkerWaiting.load()) Wake();
+}
+
+//==========================================================================
+//
+// Wakes up whichever side is waiting for the other. Taking the lock makes
+// sure that the waiting side is either asleep or has not yet checked the
+// queue, so the notification cannot get lost.
+//
+//==========================================================================
+
+void FBSPWorker::Wake()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+	}
+	mCondition.notify_all();
+}
+
+//==========================================================================
+//
+// Waits until all queued jobs have been processed
+//
+//==========================================================================
+
+void FBSPWorker::Finish()
+{
+	mFinishing.store(true);
+	Wake();
+	std::unique_lock<std::mutex> lock(mMutex);
+	mCondition.wait(lock, [&]() { return !mActive; });
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void FBSPWorker::WorkerMain()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mCondition.wait(lock, [&]() { return mActive || mShutdown; });
+		if (mShutdown)
+			break;
+		GLSceneDrawer *drawer = mDrawer;
+		lock.unlock();
+
+		unsigned int read = 0;
+		while (true)
+		{
+			if (read != mWriteIndex.load())
+			{
+				drawer->ExecuteJob(mJobs[read & (QUEUE_SIZE - 1)]);
+				read++;
+				mReadIndex.store(read);
+				if (mProducerWaiting.load()) Wake();
+			}
+			else
+			{
+				// Sleep until a batch of jobs is ready or the traversal is done.
+				lock.lock();
+				mWorkerWaiting = true;
+				mCondition.wait(lock, [&]() { return read != mWriteIndex.load() || mFinishing.load(); });
+				mWorkerWaiting = false;
+				lock.unlock();
+				// Only finished once the remaining jobs are done.
+				if (read == mWriteIndex.load()) break;
+			}
+		}
+
+		lock.lock();
+		mActive = false;
+		lock.unlock();
+		mCondition.notify_all();
+	}
+}
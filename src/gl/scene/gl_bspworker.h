@@ -0,0 +1,97 @@
+#ifndef __GL_BSPWORKER_H
+#define __GL_BSPWORKER_H
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+
+struct seg_t;
+struct subsector_t;
+struct FPortal;
+class GLSceneDrawer;
+
+//==========================================================================
+//
+// A piece of geometry processing found visible by the BSP traversal.
+// Sectors are not stored because gl_FakeFlat copies only live on the
+// traversal's stack. They get recreated from the recorded view area.
+//
+//==========================================================================
+
+struct FRenderJob
+{
+	enum
+	{
+		WallJob,
+		ParticleJob,
+		ThingJob,
+		FlatJob,
+		PortalJob,
+	};
+
+	enum
+	{
+		BackNone,		// one-sided
+		BackFront,		// same sector on both sides or a polyobject seg
+		BackFake,		// gl_FakeFlat of seg->backsector
+	};
+
+	uint8_t type;
+	uint8_t backtype;
+	uint8_t frontarea;	// view area the front sector was faked with
+	uint8_t area;		// view area at the time the job was queued
+	subsector_t *sub;
+	seg_t *seg;
+	FPortal *portal;
+};
+
+//==========================================================================
+//
+// Runs the geometry processing for the BSP traversal on a second thread.
+// The traversal produces jobs in order and a single consumer executes
+// them in that same order, so the draw lists come out exactly as if
+// everything had been processed inline.
+//
+//==========================================================================
+
+class FBSPWorker
+{
+public:
+	FBSPWorker();
+	~FBSPWorker();
+
+	void Begin(GLSceneDrawer *drawer);
+	void Push(const FRenderJob &job);
+	void Finish();
+
+private:
+	void WorkerMain();
+	void Wake();
+
+	enum
+	{
+		QUEUE_SIZE = 8192,	// must be a power of two
+		WAKE_BATCH = 64,	// jobs queued before a sleeping worker gets woken up
+	};
+
+	// Everything the traversal wrote before pushing a job is visible to the
+	// worker once it has seen the new write index and vice versa for the
+	// read index.
+	FRenderJob mJobs[QUEUE_SIZE];
+	std::atomic<unsigned int> mReadIndex;
+	std::atomic<unsigned int> mWriteIndex;
+	std::atomic<bool> mFinishing;
+	std::atomic<bool> mWorkerWaiting;
+	std::atomic<bool> mProducerWaiting;
+
+	GLSceneDrawer *mDrawer = nullptr;
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mActive = false;
+	bool mShutdown = false;
+};
+
+#endif
@@ -49,6 +49,8 @@
 #include "gl/stereo3d/scoped_color_mask.h"
 #include "gl/renderer/gl_quaddrawer.h"
 
+CVAR(Bool, gl_multidraw, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
 FDrawInfo * gl_drawinfo;
 
 //==========================================================================
@@ -867,13 +869,61 @@ void GLDrawList::Draw(int pass, bool trans)
 void GLDrawList::DrawWalls(int pass)
 {
 	RenderWall.Clock();
-	for(unsigned i=0;i<drawitems.Size();i++)
+	if (gl_multidraw && !gl.legacyMode && (pass == GLPASS_PLAIN || pass == GLPASS_ALL))
 	{
-		walls[drawitems[i].index].Draw(pass);
+		DrawWallsBatched(pass);
+	}
+	else
+	{
+		for (unsigned i = 0; i < drawitems.Size(); i++)
+		{
+			walls[drawitems[i].index].Draw(pass);
+		}
 	}
 	RenderWall.Unclock();
 }
 
+//==========================================================================
+//
+// Consecutive walls that share all render state are collected and
+// submitted as one multi-draw. The first wall of a batch sets up
+// the state, the following ones only add their vertices.
+//
+//==========================================================================
+
+void GLDrawList::DrawWallsBatched(int pass)
+{
+	auto vbo = GLRenderer->mVBO;
+	GLWall *leader = nullptr;
+
+	for (unsigned i = 0; i < drawitems.Size(); i++)
+	{
+		GLWall &wall = walls[drawitems[i].index];
+
+		// Lights must be known before deciding whether the wall can be batched.
+		if (pass == GLPASS_ALL) wall.SetupLights();
+
+		bool batchable = wall.IsBatchable();
+		if (leader != nullptr)
+		{
+			if (batchable && wall.BatchesWith(*leader))
+			{
+				wall.RenderBatched();
+				continue;
+			}
+			vbo->EndBatch();
+			leader = nullptr;
+		}
+		if (batchable)
+		{
+			vbo->BeginBatch();
+			leader = &wall;
+		}
+		wall.Draw(GLPASS_PLAIN);
+	}
+	if (leader != nullptr) vbo->EndBatch();
+}
+
 //==========================================================================
 //
 //
@@ -882,13 +932,57 @@ void GLDrawList::DrawWalls(int pass)
 void GLDrawList::DrawFlats(int pass)
 {
 	RenderFlat.Clock();
-	for(unsigned i=0;i<drawitems.Size();i++)
+	if (gl_multidraw && !gl.legacyMode && (pass == GLPASS_PLAIN || pass == GLPASS_ALL))
 	{
-		flats[drawitems[i].index].Draw(pass, false);
+		DrawFlatsBatched(pass);
+	}
+	else
+	{
+		for (unsigned i = 0; i < drawitems.Size(); i++)
+		{
+			flats[drawitems[i].index].Draw(pass, false);
+		}
 	}
 	RenderFlat.Unclock();
 }
 
+//==========================================================================
+//
+// Same as above for flats. A batch also merges all subsectors of a flat
+// into a single call.
+//
+//==========================================================================
+
+void GLDrawList::DrawFlatsBatched(int pass)
+{
+	auto vbo = GLRenderer->mVBO;
+	GLFlat *leader = nullptr;
+
+	for (unsigned i = 0; i < drawitems.Size(); i++)
+	{
+		GLFlat &flat = flats[drawitems[i].index];
+
+		bool batchable = flat.IsBatchable(pass);
+		if (leader != nullptr)
+		{
+			if (batchable && flat.BatchesWith(*leader))
+			{
+				flat.DrawSubsectorList(false, false);
+				continue;
+			}
+			vbo->EndBatch();
+			leader = nullptr;
+		}
+		if (batchable)
+		{
+			vbo->BeginBatch();
+			leader = &flat;
+		}
+		flat.Draw(pass, false);
+	}
+	if (leader != nullptr) vbo->EndBatch();
+}
+
 //==========================================================================
 //
 //
@@ -918,7 +1012,8 @@ static int diwcmp (const void *a, const void *b)
 	GLWall * w2=&sortinfo->walls[di2->index];
 
 	if (w1->gltexture != w2->gltexture) return w1->gltexture - w2->gltexture;
-	return ((w1->flags & 3) - (w2->flags & 3));
+	if ((w1->flags & 3) != (w2->flags & 3)) return ((w1->flags & 3) - (w2->flags & 3));
+	return w1->lightlevel - w2->lightlevel;
 }
 
 static int difcmp (const void *a, const void *b)
@@ -929,7 +1024,8 @@ static int difcmp (const void *a, const void *b)
 	const GLDrawItem * di2 = (const GLDrawItem *)b;
 	GLFlat* w2=&sortinfo->flats[di2->index];
 
-	return w1->gltexture - w2->gltexture;
+	if (w1->gltexture != w2->gltexture) return w1->gltexture - w2->gltexture;
+	return w1->lightlevel - w2->lightlevel;
 }
 
 
@@ -1047,10 +1143,12 @@ void FDrawInfo::StartScene()
 	ClearBuffers();
 
 	sectorrenderflags.Resize(level.sectors.Size());
+	sectorprocessflags.Resize(level.sectors.Size());
 	ss_renderflags.Resize(level.subsectors.Size());
 	no_renderflags.Resize(level.subsectors.Size());
 
 	memset(&sectorrenderflags[0], 0, level.sectors.Size() * sizeof(sectorrenderflags[0]));
+	memset(&sectorprocessflags[0], 0, level.sectors.Size() * sizeof(sectorprocessflags[0]));
 	memset(&ss_renderflags[0], 0, level.subsectors.Size() * sizeof(ss_renderflags[0]));
 	memset(&no_renderflags[0], 0, level.nodes.Size() * sizeof(no_renderflags[0]));
 
@@ -156,7 +156,9 @@ public:
 	void DrawSorted();
 	void Draw(int pass, bool trans = false);
 	void DrawWalls(int pass);
+	void DrawWallsBatched(int pass);
 	void DrawFlats(int pass);
+	void DrawFlatsBatched(int pass);
 	void DrawDecals();
 	
 	GLDrawList * next;
@@ -208,7 +210,8 @@ struct FDrawInfo
 
 	GLSceneDrawer *mDrawer;
 
-	TArray<uint8_t> sectorrenderflags;
+	TArray<uint8_t> sectorrenderflags;	// written by the geometry processing, which may run on the BSP worker
+	TArray<uint8_t> sectorprocessflags;	// written by the BSP traversal
 	TArray<uint8_t> ss_renderflags;
 	TArray<uint8_t> no_renderflags;
 
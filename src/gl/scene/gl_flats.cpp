@@ -253,10 +253,15 @@ void GLFlat::ProcessLights(bool istrans)
 //==========================================================================
 
 void GLFlat::DrawSubsectors(int pass, bool processlights, bool istrans)
+{
+	gl_RenderState.Apply();
+	DrawSubsectorList(processlights, istrans);
+}
+
+void GLFlat::DrawSubsectorList(bool processlights, bool istrans)
 {
 	int dli = dynlightindex;
 
-	gl_RenderState.Apply();
 	if (vboindex >= 0)
 	{
 		int index = vboindex;
@@ -267,9 +272,7 @@ void GLFlat::DrawSubsectors(int pass, bool processlights, bool istrans)
 			if (gl_drawinfo->ss_renderflags[sub->Index()]&renderflags || istrans)
 			{
 				if (processlights) SetupSubsectorLights(GLPASS_ALL, sub, &dli);
-				drawcalls.Clock();
-				glDrawArrays(GL_TRIANGLE_FAN, index, sub->numlines);
-				drawcalls.Unclock();
+				GLRenderer->mVBO->RenderArray(GL_TRIANGLE_FAN, index, sub->numlines);
 				flatvertices += sub->numlines;
 				flatprimitives++;
 			}
@@ -446,6 +449,46 @@ void GLFlat::Draw(int pass, bool trans)	// trans only has meaning for GLPASS_LIG
 	}
 }
 
+//==========================================================================
+//
+// Flats that can be drawn as part of a batch: no per-subsector lights
+// and no special texture handling for skyboxes.
+//
+//==========================================================================
+
+bool GLFlat::IsBatchable(int pass)
+{
+	if (sector->special == GLSector_Skybox || dynlightindex > -1) return false;
+	if (pass == GLPASS_ALL)
+	{
+		// the lights get set up per subsector so a batch is only possible if none of them is lit.
+		for (int i = 0; i < sector->subsectorcount; i++)
+		{
+			if (sector->subsectors[i]->lighthead != nullptr) return false;
+		}
+		if (!(renderflags&SSRF_RENDER3DPLANES))
+		{
+			gl_subsectorrendernode * node = (renderflags&SSRF_RENDERFLOOR) ?
+				gl_drawinfo->GetOtherFloorPlanes(sector->sectornum) :
+				gl_drawinfo->GetOtherCeilingPlanes(sector->sectornum);
+
+			for (; node != nullptr; node = node->next)
+			{
+				if (node->sub->lighthead != nullptr) return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool GLFlat::BatchesWith(GLFlat &other)
+{
+	if (gltexture != other.gltexture || lightlevel != other.lightlevel || Colormap != other.Colormap) return false;
+	if (FlatColor != other.FlatColor || renderstyle != other.renderstyle) return false;
+	if (plane.Offs != other.plane.Offs || plane.Scale != other.plane.Scale || plane.Angle != other.plane.Angle) return false;
+	return plane.plane.Normal() == other.plane.plane.Normal();
+}
+
 
 //==========================================================================
 //
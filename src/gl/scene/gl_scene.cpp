@@ -80,6 +80,7 @@ CVAR(Bool, gl_no_skyclear, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR(Float, gl_mask_threshold, 0.5f,CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR(Float, gl_mask_sprite_threshold, 0.5f,CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 CVAR(Bool, gl_sort_textures, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+EXTERN_CVAR(Bool, gl_multidraw)
 
 EXTERN_CVAR (Bool, cl_capfps)
 EXTERN_CVAR (Bool, r_deathcamera)
@@ -87,6 +88,7 @@ EXTERN_CVAR (Float, underwater_fade_scalar)
 EXTERN_CVAR (Float, r_visibility)
 EXTERN_CVAR (Bool, gl_legacy_mode)
 EXTERN_CVAR (Bool, r_drawvoxels)
+EXTERN_CVAR (Bool, gl_multithread)
 
 extern bool NoInterpolateView;
 
@@ -274,7 +276,17 @@ void GLSceneDrawer::CreateScene()
 	GLRenderer->mVBO->Map();
 	SetView();
 	validcount++;	// used for processing sidedefs only once by the renderer.
+	multithread = gl_multithread;
+	if (multithread) GLRenderer->mBSPWorker->Begin(this);
 	RenderBSPNode (level.HeadNode());
+	if (multithread)
+	{
+		GLRenderer->mBSPWorker->Finish();
+		for (auto line : mappedlines) line->flags |= ML_MAPPED;
+		for (auto sec : drawnsectors) sec->MoreFlags |= SECF_DRAWN;
+		mappedlines.Clear();
+		drawnsectors.Clear();
+	}
 	if (GLRenderer->mCurrentPortal != NULL) GLRenderer->mCurrentPortal->RenderAttached();
 	Bsp.Unclock();
 
@@ -309,7 +321,8 @@ void GLSceneDrawer::RenderScene(int recursion)
 	gl_RenderState.EnableFog(true);
 	gl_RenderState.BlendFunc(GL_ONE,GL_ZERO);
 
-	if (gl_sort_textures)
+	// Batching only pays off if equal surfaces end up next to each other.
+	if (gl_sort_textures || (gl_multidraw && !gl.legacyMode))
 	{
 		gl_drawinfo->drawlists[GLDL_PLAINWALLS].SortWalls();
 		gl_drawinfo->drawlists[GLDL_PLAINFLATS].SortFlats();
@@ -6,6 +6,7 @@
 #include "gl_portal.h"
 #include "gl/renderer/gl_lightdata.h"
 #include "gl/renderer/gl_renderer.h"
+#include "gl/scene/gl_bspworker.h"
 
 class GLSceneDrawer
 {
@@ -13,6 +14,10 @@ class GLSceneDrawer
 	
 	subsector_t *currentsubsector;	// used by the line processing code.
 	sector_t *currentsector;
+	area_t currentarea;				// the view area currentsector was faked with.
+	bool multithread;				// geometry processing runs on the BSP worker thread.
+	TArray<line_t *> mappedlines;	// get ML_MAPPED once the worker is done
+	TArray<sector_t *> drawnsectors;	// get SECF_DRAWN once the worker is done
 
 	void RenderMultipassStuff();
 	
@@ -26,6 +31,7 @@ class GLSceneDrawer
 	void RenderThings(subsector_t * sub, sector_t * sector);
 	void DoSubsector(subsector_t * sub);
 	void RenderBSPNode(void *node);
+	void QueueJob(int type, subsector_t *sub, area_t frontarea, seg_t *seg = nullptr, int backtype = FRenderJob::BackNone, FPortal *portal = nullptr);
 
 	void RenderScene(int recursion);
 	void RenderTranslucent();
@@ -41,6 +47,9 @@ public:
 	Clipper clipper;
 	int		FixedColormap;
 	area_t	in_area;
+	area_t	process_area;	// in_area as it was when the geometry being processed was found visible
+
+	void ExecuteJob(const FRenderJob &job);
 
 	angle_t FrustumAngle();
 	void SetViewMatrix(float vx, float vy, float vz, bool mirror, bool planemirror);
@@ -769,7 +769,7 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal)
 
 	if (sector->sectornum != thing->Sector->sectornum && !thruportal)
 	{
-		rendersector = gl_FakeFlat(thing->Sector, &rs, mDrawer->in_area, false);
+		rendersector = gl_FakeFlat(thing->Sector, &rs, mDrawer->process_area, false);
 	}
 	else
 	{
@@ -956,7 +956,7 @@ void GLSprite::Process(AActor* thing, sector_t * sector, int thruportal)
 		Colormap = rendersector->Colormap;
 		if (fullbright)
 		{
-			if (rendersector == &level.sectors[rendersector->sectornum] || mDrawer->in_area != area_below)
+			if (rendersector == &level.sectors[rendersector->sectornum] || mDrawer->process_area != area_below)
 				// under water areas keep their color for fullbright objects
 			{
 				// Only make the light white but keep everything else (fog, desaturation and Boom colormap.)
@@ -1306,7 +1306,7 @@ void GLSceneDrawer::RenderActorsInPortal(FGLLinePortal *glport)
 					th->Prev += newpos - savedpos;
 
 					GLSprite spr(this);
-					spr.Process(th, gl_FakeFlat(th->Sector, &fakesector, in_area, false), 2);
+					spr.Process(th, gl_FakeFlat(th->Sector, &fakesector, process_area, false), 2);
 					th->Angles.Yaw = savedangle;
 					th->SetXYZ(savedpos);
 					th->Prev -= newpos - savedpos;
@@ -275,6 +275,10 @@ public:
 	void ProcessLowerMiniseg(seg_t *seg, sector_t *frontsector, sector_t *backsector);
 	void Draw(int pass);
 
+	bool IsBatchable();
+	bool BatchesWith(GLWall &other);
+	void RenderBatched();
+
 	float PointOnSide(float x,float y)
 	{
 		return -((y-glseg.y1)*(glseg.x2-glseg.x1)-(x-glseg.x1)*(glseg.y2-glseg.y1));
@@ -337,6 +341,7 @@ public:
 	void DrawSubsector(subsector_t * sub);
 	void DrawSkyboxSector(int pass, bool processlights);
 	void DrawSubsectors(int pass, bool processlights, bool istrans);
+	void DrawSubsectorList(bool processlights, bool istrans);
 	void ProcessLights(bool istrans);
 
 	void PutFlat(bool fog = false);
@@ -344,6 +349,9 @@ public:
 	void SetFrom3DFloor(F3DFloor *rover, bool top, bool underside);
 	void ProcessSector(sector_t * frontsector);
 	void Draw(int pass, bool trans);
+
+	bool IsBatchable(int pass);
+	bool BatchesWith(GLFlat &other);
 };
 
 
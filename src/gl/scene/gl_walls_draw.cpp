@@ -220,6 +220,46 @@ void GLWall::RenderWall(int textured)
 	vertexcount += vertcount;
 }
 
+//==========================================================================
+//
+// Walls that get drawn as part of a batch. Only plain walls that do not
+// need any per-wall render state besides their vertices qualify.
+//
+//==========================================================================
+
+bool GLWall::IsBatchable()
+{
+	if (gltexture == nullptr || lightlist != nullptr || (flags & GLWF_GLOW) || type == RENDERWALL_M2SNF) return false;
+	if (dynlightindex != -1) return false;
+	return gl.buffermethod != BM_DEFERRED || vertcount > 0;
+}
+
+bool GLWall::BatchesWith(GLWall &other)
+{
+	if (gltexture != other.gltexture || (flags & 3) != (other.flags & 3)) return false;
+	if (lightlevel != other.lightlevel || rellight != other.rellight || Colormap != other.Colormap) return false;
+	if (alpha != other.alpha || RenderStyle != other.RenderStyle) return false;
+	if (glseg.Normal() != other.glseg.Normal()) return false;
+
+	PalEntry top = seg->frontsector->SpecialColors[sector_t::walltop];
+	PalEntry bottom = seg->frontsector->SpecialColors[sector_t::wallbottom];
+	if (top != other.seg->frontsector->SpecialColors[sector_t::walltop] ||
+		bottom != other.seg->frontsector->SpecialColors[sector_t::wallbottom]) return false;
+
+	// the planes only matter for the gradient between the two colors.
+	return top == bottom || (topplane == other.topplane && bottomplane == other.bottomplane);
+}
+
+void GLWall::RenderBatched()
+{
+	if (gl.buffermethod != BM_DEFERRED)
+	{
+		MakeVertices(false);
+	}
+	GLRenderer->mVBO->RenderArray(GL_TRIANGLE_FAN, vertindex, vertcount);
+	vertexcount += vertcount;
+}
+
 //==========================================================================
 //
 // 
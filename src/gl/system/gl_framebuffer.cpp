@@ -214,7 +214,9 @@ void OpenGLFrameBuffer::Swap()
 	Finish.Clock();
 	if (swapbefore) glFinish();
 	SwapBuffers();
-	if (!swapbefore) glFinish();
+	// Outside legacy mode the streaming buffers are protected by fences so there is no need to wait for the GPU here.
+	if (!swapbefore && gl.legacyMode) glFinish();
+	GLRenderer->NextStreamFrame();
 	Finish.Unclock();
 	camtexcount = 0;
 	FHardwareTexture::UnbindAll();
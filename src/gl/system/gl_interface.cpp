@@ -265,6 +265,9 @@ void gl_LoadExtensions()
 
 			if (gl_version >= 4.3f || CheckExtension("GL_ARB_invalidate_subdata")) gl.flags |= RFL_INVALIDATE_BUFFER;
 			if (gl_version >= 4.3f || CheckExtension("GL_KHR_debug")) gl.flags |= RFL_DEBUG;
+			// The indirect commands get streamed through a persistently mapped buffer.
+			// The entry point only gets loaded if the driver lists the extension, even on GL 4.3 and later.
+			if (gl.buffermethod == BM_PERSISTENT && _ptrc_glMultiDrawArraysIndirect != NULL) gl.flags |= RFL_MULTI_DRAW_INDIRECT;
 
 			const char *lm = Args->CheckValue("-lightmethod");
 			if (lm != NULL)
@@ -24,7 +24,8 @@ enum RenderFlags
 	RFL_NO_CLIP_PLANES = 32,
 
 	RFL_INVALIDATE_BUFFER = 64,
-	RFL_DEBUG = 128
+	RFL_DEBUG = 128,
+	RFL_MULTI_DRAW_INDIRECT = 256
 };
 
 enum TexMode
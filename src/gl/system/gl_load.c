@@ -109,6 +109,8 @@ int ogl_ext_EXT_texture_sRGB = ogl_LOAD_FAILED;
 int ogl_ext_KHR_debug = ogl_LOAD_FAILED;
 int ogl_ext_ARB_invalidate_subdata = ogl_LOAD_FAILED;
 int ogl_ext_EXT_abgr = ogl_LOAD_FAILED;
+int ogl_ext_ARB_draw_indirect = ogl_LOAD_FAILED;
+int ogl_ext_ARB_multi_draw_indirect = ogl_LOAD_FAILED;
 
 void (CODEGEN_FUNCPTR *_ptrc_glBufferStorage)(GLenum target, GLsizeiptr size, const void * data, GLbitfield flags) = NULL;
 
@@ -281,6 +283,32 @@ static int Load_ARB_invalidate_subdata(void)
 	return numFailed;
 }
 
+void (CODEGEN_FUNCPTR *_ptrc_glDrawArraysIndirect)(GLenum mode, const void * indirect) = NULL;
+void (CODEGEN_FUNCPTR *_ptrc_glDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect) = NULL;
+
+static int Load_ARB_draw_indirect(void)
+{
+	int numFailed = 0;
+	_ptrc_glDrawArraysIndirect = (void (CODEGEN_FUNCPTR *)(GLenum, const void *))IntGetProcAddress("glDrawArraysIndirect");
+	if(!_ptrc_glDrawArraysIndirect) numFailed++;
+	_ptrc_glDrawElementsIndirect = (void (CODEGEN_FUNCPTR *)(GLenum, GLenum, const void *))IntGetProcAddress("glDrawElementsIndirect");
+	if(!_ptrc_glDrawElementsIndirect) numFailed++;
+	return numFailed;
+}
+
+void (CODEGEN_FUNCPTR *_ptrc_glMultiDrawArraysIndirect)(GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride) = NULL;
+void (CODEGEN_FUNCPTR *_ptrc_glMultiDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride) = NULL;
+
+static int Load_ARB_multi_draw_indirect(void)
+{
+	int numFailed = 0;
+	_ptrc_glMultiDrawArraysIndirect = (void (CODEGEN_FUNCPTR *)(GLenum, const void *, GLsizei, GLsizei))IntGetProcAddress("glMultiDrawArraysIndirect");
+	if(!_ptrc_glMultiDrawArraysIndirect) numFailed++;
+	_ptrc_glMultiDrawElementsIndirect = (void (CODEGEN_FUNCPTR *)(GLenum, GLenum, const void *, GLsizei, GLsizei))IntGetProcAddress("glMultiDrawElementsIndirect");
+	if(!_ptrc_glMultiDrawElementsIndirect) numFailed++;
+	return numFailed;
+}
+
 void (CODEGEN_FUNCPTR *_ptrc_glAccum)(GLenum op, GLfloat value) = NULL;
 void (CODEGEN_FUNCPTR *_ptrc_glAlphaFunc)(GLenum func, GLfloat ref) = NULL;
 void (CODEGEN_FUNCPTR *_ptrc_glBegin)(GLenum mode) = NULL;
@@ -2388,7 +2416,7 @@ typedef struct ogl_StrToExtMap_s
 	PFN_LOADFUNCPOINTERS LoadExtension;
 } ogl_StrToExtMap;
 
-static ogl_StrToExtMap ExtensionMap[12] = {
+static ogl_StrToExtMap ExtensionMap[14] = {
 	{"GL_APPLE_client_storage", &ogl_ext_APPLE_client_storage, NULL},
 	{"GL_ARB_buffer_storage", &ogl_ext_ARB_buffer_storage, Load_ARB_buffer_storage},
 	{"GL_ARB_shader_storage_buffer_object", &ogl_ext_ARB_shader_storage_buffer_object, Load_ARB_shader_storage_buffer_object},
@@ -2401,9 +2429,11 @@ static ogl_StrToExtMap ExtensionMap[12] = {
 	{"GL_KHR_debug", &ogl_ext_KHR_debug, Load_KHR_debug},
 	{"GL_ARB_invalidate_subdata", &ogl_ext_ARB_invalidate_subdata, Load_ARB_invalidate_subdata},
 	{"GL_EXT_abgr", &ogl_ext_EXT_abgr, NULL},
+	{"GL_ARB_draw_indirect", &ogl_ext_ARB_draw_indirect, Load_ARB_draw_indirect},
+	{"GL_ARB_multi_draw_indirect", &ogl_ext_ARB_multi_draw_indirect, Load_ARB_multi_draw_indirect},
 };
 
-static int g_extensionMapSize = 12;
+static int g_extensionMapSize = 14;
 
 static ogl_StrToExtMap *FindExtEntry(const char *extensionName)
 {
@@ -2432,6 +2462,8 @@ static void ClearExtensionVars(void)
 	ogl_ext_KHR_debug = ogl_LOAD_FAILED;
 	ogl_ext_ARB_invalidate_subdata = ogl_LOAD_FAILED;
 	ogl_ext_EXT_abgr = ogl_LOAD_FAILED;
+	ogl_ext_ARB_draw_indirect = ogl_LOAD_FAILED;
+	ogl_ext_ARB_multi_draw_indirect = ogl_LOAD_FAILED;
 }
 
 
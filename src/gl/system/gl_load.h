@@ -119,9 +119,14 @@ extern int ogl_ext_EXT_texture_sRGB;
 extern int ogl_ext_KHR_debug;
 extern int ogl_ext_ARB_invalidate_subdata;
 extern int ogl_ext_EXT_abgr;
+extern int ogl_ext_ARB_draw_indirect;
+extern int ogl_ext_ARB_multi_draw_indirect;
 
 #define GL_UNPACK_CLIENT_STORAGE_APPLE 0x85B2
 
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#define GL_DRAW_INDIRECT_BUFFER_BINDING 0x8F43
+
 #define GL_BUFFER_IMMUTABLE_STORAGE 0x821F
 #define GL_BUFFER_STORAGE_FLAGS 0x8220
 #define GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT 0x00004000
@@ -1660,6 +1665,22 @@ extern void (CODEGEN_FUNCPTR *_ptrc_glInvalidateTexSubImage)(GLuint texture, GLi
 #define glInvalidateTexSubImage _ptrc_glInvalidateTexSubImage
 #endif /*GL_ARB_invalidate_subdata*/ 
 
+#ifndef GL_ARB_draw_indirect
+#define GL_ARB_draw_indirect 1
+extern void (CODEGEN_FUNCPTR *_ptrc_glDrawArraysIndirect)(GLenum mode, const void * indirect);
+#define glDrawArraysIndirect _ptrc_glDrawArraysIndirect
+extern void (CODEGEN_FUNCPTR *_ptrc_glDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect);
+#define glDrawElementsIndirect _ptrc_glDrawElementsIndirect
+#endif /*GL_ARB_draw_indirect*/ 
+
+#ifndef GL_ARB_multi_draw_indirect
+#define GL_ARB_multi_draw_indirect 1
+extern void (CODEGEN_FUNCPTR *_ptrc_glMultiDrawArraysIndirect)(GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride);
+#define glMultiDrawArraysIndirect _ptrc_glMultiDrawArraysIndirect
+extern void (CODEGEN_FUNCPTR *_ptrc_glMultiDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride);
+#define glMultiDrawElementsIndirect _ptrc_glMultiDrawElementsIndirect
+#endif /*GL_ARB_multi_draw_indirect*/ 
+
 
 extern void (CODEGEN_FUNCPTR *_ptrc_glAccum)(GLenum op, GLfloat value);
 #define glAccum _ptrc_glAccum
@@ -285,6 +285,25 @@ uint32_t FRandom::StaticSumSeeds ()
 		pr_damagemobj.sfmt.u[0] + pr_damagemobj.idx;
 }
 
+//==========================================================================
+//
+// FRandom :: StaticHashState
+//
+// Adds the position of every RNG to a running CRC. Unlike StaticSumSeeds
+// this covers all RNGs, so it can pinpoint the first tic a demo desyncs.
+//
+//==========================================================================
+
+uint32_t FRandom::StaticHashState (uint32_t crc)
+{
+	for (FRandom *rng = FRandom::RNGList; rng != NULL; rng = rng->Next)
+	{
+		uint32_t state[3] = { rng->NameCRC, rng->sfmt.u[0], (uint32_t)rng->idx };
+		crc = AddCRC32(crc, (const uint8_t *)state, sizeof(state));
+	}
+	return crc;
+}
+
 //==========================================================================
 //
 // FRandom :: StaticWriteRNGState
@@ -174,6 +174,7 @@ public:
 	// Static interface
 	static void StaticClearRandom ();
 	static uint32_t StaticSumSeeds ();
+	static uint32_t StaticHashState (uint32_t crc);
 	static void StaticReadRNGState (FSerializer &arc);
 	static void StaticWriteRNGState (FSerializer &file);
 	static FRandom *StaticFindRNG(const char *name);
@@ -795,6 +795,7 @@ xx(BuiltinTypeCheck)
 xx(BuiltinRandom)
 xx(BuiltinFRandom)
 xx(BuiltinCallLineSpecial)
+xx(BuiltinInvalidateSightCache)
 xx(BuiltinNameToClass)
 xx(BuiltinFindMultiNameState)
 xx(BuiltinFindSingleNameState)
@@ -833,6 +834,8 @@ xx(Fixed)
 xx(Vector2)
 xx(Vector3)
 xx(let)
+xx(Line)
+xx(Flags)
 
 xx(Min)
 xx(Max)
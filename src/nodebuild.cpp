@@ -51,10 +51,12 @@
 #include "m_bbox.h"
 #include "c_console.h"
 #include "r_state.h"
+#include "parallel_for.h"
 
 const int MaxSegs = 64;
 const int SplitCost = 8;
 const int AAPreference = 16;
+const uint64_t ParallelHeuristicWork = 1 << 16;	// segs * candidates before splitter scoring is spread over threads
 
 #if 0
 #define D(x) x
@@ -453,6 +455,7 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 	uint32_t bestseg;
 	uint32_t seg;
 	bool nosplitters = false;
+	unsigned int setsize = 0;
 
 	bestvalue = 0;
 	bestseg = DWORD_MAX;
@@ -464,10 +467,14 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 
 	D(Printf (PRINT_LOG, "Processing set %d\n", set));
 
+	// Which segs get tried as splitters does not depend on their scores, so
+	// they can all be picked first and then be scored independently.
+	Candidates.Clear();
 	while (seg != DWORD_MAX)
 	{
 		FPrivSeg *pseg = &Segs[seg];
 
+		setsize++;
 		if (--stepleft <= 0)
 		{
 			int l = pseg->planenum >> 3;
@@ -481,30 +488,59 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 				}
 
 				stepleft = step;
-				SetNodeFromSeg (node, pseg);
+				Candidates.Push(seg);
+			}
+		}
 
-				int value = Heuristic (node, set, nosplit);
+		seg = pseg->next;
+	}
 
-				D(Printf (PRINT_LOG, "Seg %5d, ld %d (%5d,%5d)-(%5d,%5d) scores %d\n", seg, Segs[seg].linedef, node.x>>16, node.y>>16,
-					(node.x+node.dx)>>16, (node.y+node.dy)>>16, value));
+	CandidateScores.Resize(Candidates.Size());
+	if ((uint64_t)setsize * Candidates.Size() >= ParallelHeuristicWork)
+	{
+		parallel_for(int(Candidates.Size()), [&](int c)
+		{
+			node_t cnode;
+			TArray<int> touched, colinear;
 
-				if (value > bestvalue)
-				{
-					bestvalue = value;
-					bestseg = seg;
-				}
-				else if (value < 0)
-				{
-					nosplitters = true;
-				}
-			}
+			assert((unsigned)c < Candidates.Size());
+			SetNodeFromSeg (cnode, &Segs[Candidates[c]]);
+			CandidateScores[c] = Heuristic (cnode, set, nosplit, touched, colinear);
+		});
+	}
+	else
+	{
+		for (unsigned int c = 0; c < Candidates.Size(); ++c)
+		{
+			SetNodeFromSeg (node, &Segs[Candidates[c]]);
+			CandidateScores[c] = Heuristic (node, set, nosplit, Touched, Colinear);
 		}
+	}
 
-		seg = pseg->next;
+	// Pick the winner in the same order a serial search would have.
+	for (unsigned int c = 0; c < Candidates.Size(); ++c)
+	{
+		int value = CandidateScores[c];
+
+		D(Printf (PRINT_LOG, "Seg %5d, ld %d scores %d\n", Candidates[c], Segs[Candidates[c]].linedef, value));
+
+		if (value > bestvalue)
+		{
+			bestvalue = value;
+			bestseg = Candidates[c];
+		}
+		else if (value < 0)
+		{
+			nosplitters = true;
+		}
 	}
 
 	if (bestseg == DWORD_MAX)
 	{ // No lines split any others into two sets, so this is a convex region.
+		if (Candidates.Size() > 0)
+		{ // Leave the node like the serial search did.
+			SetNodeFromSeg (node, &Segs[Candidates.Last()]);
+		}
 	D(Printf (PRINT_LOG, "set %d, step %d, nosplit %d has no good splitter (%d)\n", set, step, nosplit, nosplitters));
 		return nosplitters ? -1 : 0;
 	}
@@ -523,6 +559,13 @@ int FNodeBuilder::SelectSplitter (uint32_t set, node_t &node, uint32_t &splitseg
 // in the set.
 
 int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
+{
+	return Heuristic (node, set, honorNoSplit, Touched, Colinear);
+}
+
+// This may run on several threads at once for different splitters, so it
+// must not touch anything in the builder but the two lists passed to it.
+int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit, TArray<int> &touched, TArray<int> &colinear)
 {
 	// Set the initial score above 0 so that near vertex anti-weighting is less likely to produce a negative score.
 	int score = 1000000;
@@ -537,8 +580,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	unsigned int max, m2, p, q;
 	double frac;
 
-	Touched.Clear ();
-	Colinear.Clear ();
+	touched.Clear ();
+	colinear.Clear ();
 
 	while (i != DWORD_MAX)
 	{
@@ -564,32 +607,32 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 			{
 				if ((sidev[0] | sidev[1]) != 0)
 				{
-					max = Touched.Size();
+					max = touched.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Touched[p] == test->loopnum)
+						if (touched[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Touched.Push (test->loopnum);
+						touched.Push (test->loopnum);
 					}
 				}
 				else
 				{
-					max = Colinear.Size();
+					max = colinear.Size();
 					for (p = 0; p < max; ++p)
 					{
-						if (Colinear[p] == test->loopnum)
+						if (colinear[p] == test->loopnum)
 						{
 							break;
 						}
 					}
 					if (p == max)
 					{
-						Colinear.Push (test->loopnum);
+						colinear.Push (test->loopnum);
 					}
 				}
 			}
@@ -706,8 +749,8 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 	// seg of that sector must be crossing the container's corner and does not
 	// actually split the container.
 
-	max = Touched.Size ();
-	m2 = Colinear.Size ();
+	max = touched.Size ();
+	m2 = colinear.Size ();
 
 	// If honorNoSplit is false, then both these lists will be empty.
 
@@ -720,10 +763,10 @@ int FNodeBuilder::Heuristic (node_t &node, uint32_t set, bool honorNoSplit)
 
 	for (p = 0; p < max; ++p)
 	{
-		int look = Touched[p];
+		int look = touched[p];
 		for (q = 0; q < m2; ++q)
 		{
-			if (look == Colinear[q])
+			if (look == colinear[q])
 			{
 				break;
 			}
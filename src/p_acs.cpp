@@ -701,6 +701,10 @@ public:
 	{
 		GlobalACSStrings.MarkStringArray(&Localvars[0], Localvars.Size());
 	}
+	void PromoteLocalVarStrings() const
+	{
+		GlobalACSStrings.PromoteStringArray(&Localvars[0], Localvars.Size());
+	}
 	void LockLocalVarStrings() const
 	{
 		GlobalACSStrings.LockStringArray(&Localvars[0], Localvars.Size());
@@ -927,6 +931,18 @@ FACSStack::~FACSStack()
 // that they might be. A string is also considered in use if its lock count
 // is non-zero, even if none of the above variable blocks referenced it.
 //
+// Most strings only live for the tic they were created in, e.g. HUD messages
+// that are rebuilt every tic. Every new string therefore starts out young.
+// At the end of each tic, young strings are freed unless they are found on
+// the stack or in local, map, world or global variables. Arrays are not
+// scanned for this. Instead, storing a value into any array promotes it out
+// of the young generation immediately.
+//
+// When the pool is full, the world and global arrays are marked a few at a
+// time over the following tics (see acs_gcmarkstep) instead of all at once.
+// Values stored into them during that time are marked when they are stored.
+// The pool is allowed to grow until the collection has finished.
+//
 // To keep track of local and map variables for nonresident maps in a hub,
 // when a map's state is archived, all strings found in its local and map
 // variables are locked. When a map is revisited in a hub, all strings found
@@ -934,14 +950,18 @@ FACSStack::~FACSStack()
 // cumulative operations.
 //
 // What this all means is that:
-//   * Strings returned by strparam last indefinitely. No longer do they
-//     disappear at the end of the tic they were generated.
+//   * Strings returned by strparam last as long as anything refers to them.
+//     They only disappear at the end of the tic they were generated in if
+//     nothing does.
 //   * You can pass library strings around freely without having to worry
 //     about always having the same libraries loaded in the same order on
 //     every map that needs to use those strings.
 //
 //----------------------------------------------------------------------------
 
+CVAR(Bool, acs_younggc, true, CVAR_SERVERINFO)
+CVAR(Int, acs_gcmarkstep, 4096, CVAR_SERVERINFO)
+
 ACSStringPool GlobalACSStrings;
 
 void ACSStringPool::PoolEntry::Lock()
@@ -963,8 +983,7 @@ void ACSStringPool::PoolEntry::Unlock()
 
 ACSStringPool::ACSStringPool()
 {
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
-	FirstFreeEntry = 0;
+	Clear();
 }
 
 //============================================================================
@@ -978,8 +997,12 @@ ACSStringPool::ACSStringPool()
 void ACSStringPool::Clear()
 {
 	Pool.Clear();
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
+	YoungEntries.Clear();
+	PoolBuckets.Resize(MIN_BUCKETS);
+	memset(&PoolBuckets[0], 0xFF, MIN_BUCKETS * sizeof(PoolBuckets[0]));
 	FirstFreeEntry = 0;
+	NumStrings = 0;
+	MarkCursor = NO_ENTRY;
 }
 
 //============================================================================
@@ -996,26 +1019,24 @@ int ACSStringPool::AddString(const char *str)
 	if (str == nullptr) str = "";
 	size_t len = strlen(str);
 	unsigned int h = SuperFastHash(str, len);
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, len, h, bucketnum);
+	int i = FindString(str, len, h);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
 	FString fstr(str);
-	return InsertString(fstr, h, bucketnum);
+	return InsertString(fstr, h);
 }
 
 int ACSStringPool::AddString(FString &str)
 {
 	unsigned int h = SuperFastHash(str.GetChars(), str.Len());
-	unsigned int bucketnum = h % NUM_BUCKETS;
-	int i = FindString(str, str.Len(), h, bucketnum);
+	int i = FindString(str, str.Len(), h);
 	if (i >= 0)
 	{
 		return i | STRPOOL_LIBRARYID_OR;
 	}
-	return InsertString(str, h, bucketnum);
+	return InsertString(str, h);
 }
 
 //============================================================================
@@ -1187,6 +1208,23 @@ void ACSStringPool::MarkStringMap(const FWorldGlobalArray &aray)
 	}
 }
 
+//============================================================================
+//
+// ACSStringPool :: PromoteStringArray
+//
+// Array version of PromoteString. Like MarkStringArray, everything that looks
+// like a string is kept.
+//
+//============================================================================
+
+void ACSStringPool::PromoteStringArray(const int *strnum, unsigned int count)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		PromoteString(strnum[i]);
+	}
+}
+
 //============================================================================
 //
 // ACSStringPool :: UnlockAll
@@ -1203,6 +1241,7 @@ void ACSStringPool::UnlockAll()
 		Pool[i].Mark = false;
 		Pool[i].Locks.Clear();
 	}
+	MarkCursor = NO_ENTRY;
 }
 
 //============================================================================
@@ -1217,7 +1256,8 @@ void ACSStringPool::PurgeStrings()
 {
 	// Clear the hash buckets. We'll rebuild them as we decide what strings
 	// to keep and which to toss.
-	memset(PoolBuckets, 0xFF, sizeof(PoolBuckets));
+	memset(&PoolBuckets[0], 0xFF, PoolBuckets.Size() * sizeof(PoolBuckets[0]));
+	unsigned int mask = PoolBuckets.Size() - 1;
 	size_t usedcount = 0, freedcount = 0;
 	for (unsigned int i = 0; i < Pool.Size(); ++i)
 	{
@@ -1240,7 +1280,7 @@ void ACSStringPool::PurgeStrings()
 			{
 				usedcount++;
 				// Rehash this entry.
-				unsigned int h = entry->Hash % NUM_BUCKETS;
+				unsigned int h = entry->Hash & mask;
 				entry->Next = PoolBuckets[h];
 				PoolBuckets[h] = i;
 				// Remove MarkString's mark.
@@ -1248,6 +1288,69 @@ void ACSStringPool::PurgeStrings()
 			}
 		}
 	}
+	NumStrings = (unsigned int)usedcount;
+	MarkCursor = NO_ENTRY;
+}
+
+//============================================================================
+//
+// ACSStringPool :: PurgeYoungStrings
+//
+// Removes all strings that are still young, unless they are locked. Whatever
+// the caller wants to keep must have been promoted before. Everything that
+// survives is no longer young.
+//
+//============================================================================
+
+void ACSStringPool::PurgeYoungStrings()
+{
+	unsigned int mask = PoolBuckets.Size() - 1;
+	for (unsigned int i = 0; i < YoungEntries.Size(); ++i)
+	{
+		unsigned int index = YoungEntries[i];
+		PoolEntry *entry = &Pool[index];
+
+		// Entries may have been freed by a full purge and even been reused since.
+		if (entry->Next == FREE_ENTRY || !entry->Young)
+		{
+			continue;
+		}
+		entry->Young = false;
+		if (entry->Locks.Size() != 0)
+		{
+			continue;
+		}
+		// Unlink it from its hash chain.
+		unsigned int *link = &PoolBuckets[entry->Hash & mask];
+		while (*link != index)
+		{
+			assert(*link != NO_ENTRY);
+			link = &Pool[*link].Next;
+		}
+		*link = entry->Next;
+
+		entry->Next = FREE_ENTRY;
+		entry->Str = "";
+		if (index < FirstFreeEntry)
+		{
+			FirstFreeEntry = index;
+		}
+		NumStrings--;
+	}
+	YoungEntries.Clear();
+}
+
+//============================================================================
+//
+// ACSStringPool :: StartMarking
+//
+// Begins an incremental collection. See P_StepACSGlobalStrings.
+//
+//============================================================================
+
+void ACSStringPool::StartMarking()
+{
+	MarkCursor = 0;
 }
 
 //============================================================================
@@ -1259,9 +1362,9 @@ void ACSStringPool::PurgeStrings()
 //
 //============================================================================
 
-int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::FindString(const char *str, size_t len, unsigned int h)
 {
-	unsigned int i = PoolBuckets[bucketnum];
+	unsigned int i = PoolBuckets[h & (PoolBuckets.Size() - 1)];
 	while (i != NO_ENTRY)
 	{
 		PoolEntry *entry = &Pool[i];
@@ -1284,13 +1387,20 @@ int ACSStringPool::FindString(const char *str, size_t len, unsigned int h, unsig
 //
 //============================================================================
 
-int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int bucketnum)
+int ACSStringPool::InsertString(FString &str, unsigned int h)
 {
 	unsigned int index = FirstFreeEntry;
 	if (index >= MIN_GC_SIZE && index == Pool.Max())
 	{ // We will need to grow the array. Try a garbage collection first.
-		P_CollectACSGlobalStrings();
-		index = FirstFreeEntry;
+		if (acs_gcmarkstep <= 0)
+		{
+			P_CollectACSGlobalStrings();
+			index = FirstFreeEntry;
+		}
+		else if (!IsMarking())
+		{ // Let it grow for now and collect over the next few tics.
+			StartMarking();
+		}
 	}
 	if (FirstFreeEntry >= STRPOOL_LIBRARYID_OR)
 	{ // If we go any higher, we'll collide with the library ID marker.
@@ -1305,16 +1415,50 @@ int ACSStringPool::InsertString(FString &str, unsigned int h, unsigned int bucke
 	{ // Scan for the next free entry
 		FindFirstFreeEntry(FirstFreeEntry + 1);
 	}
+	unsigned int bucketnum = h & (PoolBuckets.Size() - 1);
 	PoolEntry *entry = &Pool[index];
 	entry->Str = str;
 	entry->Hash = h;
 	entry->Next = PoolBuckets[bucketnum];
 	entry->Mark = false;
+	entry->Young = acs_younggc;
 	entry->Locks.Clear();
 	PoolBuckets[bucketnum] = index;
+	if (entry->Young)
+	{
+		YoungEntries.Push(index);
+	}
+	if (++NumStrings > PoolBuckets.Size())
+	{ // Keep the hash chains short.
+		Rehash(PoolBuckets.Size() * 2);
+	}
 	return index | STRPOOL_LIBRARYID_OR;
 }
 
+//============================================================================
+//
+// ACSStringPool :: Rehash
+//
+// Rebuilds the hash chains for a new number of buckets.
+//
+//============================================================================
+
+void ACSStringPool::Rehash(unsigned int numbuckets)
+{
+	PoolBuckets.Resize(numbuckets);
+	memset(&PoolBuckets[0], 0xFF, numbuckets * sizeof(PoolBuckets[0]));
+	for (unsigned int i = 0; i < Pool.Size(); ++i)
+	{
+		PoolEntry *entry = &Pool[i];
+		if (entry->Next != FREE_ENTRY)
+		{
+			unsigned int h = entry->Hash & (numbuckets - 1);
+			entry->Next = PoolBuckets[h];
+			PoolBuckets[h] = i;
+		}
+	}
+}
+
 //============================================================================
 //
 // ACSStringPool :: FindFirstFreeEntry
@@ -1354,6 +1498,7 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 		{
 			p.Next = FREE_ENTRY;
 			p.Mark = false;
+			p.Young = false;
 			p.Locks.Clear();
 		}
 		if (file.BeginArray("pool"))
@@ -1370,11 +1515,12 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 						file("string", Pool[ii].Str)
 							("locks", Pool[ii].Locks);
 
-						unsigned h = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
-						unsigned bucketnum = h % NUM_BUCKETS;
-						Pool[ii].Hash = h;
-						Pool[ii].Next = PoolBuckets[bucketnum];
-						PoolBuckets[bucketnum] = ii;
+						Pool[ii].Hash = SuperFastHash(Pool[ii].Str, Pool[ii].Str.Len());
+						if (Pool[ii].Next == FREE_ENTRY)
+						{
+							Pool[ii].Next = NO_ENTRY;
+							NumStrings++;
+						}
 					}
 					file.EndObject();
 				}
@@ -1382,6 +1528,12 @@ void ACSStringPool::ReadStrings(FSerializer &file, const char *key)
 		}
 	}
 
+	unsigned int numbuckets = MIN_BUCKETS;
+	while (numbuckets < NumStrings)
+	{
+		numbuckets *= 2;
+	}
+	Rehash(numbuckets);
 	FindFirstFreeEntry(FirstFreeEntry);
 }
 
@@ -1500,7 +1652,7 @@ void P_MarkGlobalVarStrings()
 //
 //============================================================================
 
-void P_CollectACSGlobalStrings()
+static void P_MarkStackStrings()
 {
 	for (FACSStack *stack = FACSStack::head; stack != NULL; stack = stack->next)
 	{
@@ -1519,12 +1671,86 @@ void P_CollectACSGlobalStrings()
 			GlobalACSStrings.MarkStringArray(&stack->buffer[0], sp);
 		}
 	}
+}
+
+void P_CollectACSGlobalStrings()
+{
+	P_MarkStackStrings();
 	FBehavior::StaticMarkLevelVarStrings();
 	P_MarkWorldVarStrings();
 	P_MarkGlobalVarStrings();
 	GlobalACSStrings.PurgeStrings();
 }
 
+//============================================================================
+//
+// P_CollectACSYoungStrings
+//
+// Frees the strings created since the last call that are not referenced by
+// the stack or by local, map, world or global variables. Arrays need not be
+// looked at because everything stored in them has already been promoted.
+//
+//============================================================================
+
+static void P_CollectACSYoungStrings()
+{
+	if (GlobalACSStrings.CountYoungStrings() == 0)
+	{
+		return;
+	}
+	for (FACSStack *stack = FACSStack::head; stack != NULL; stack = stack->next)
+	{
+		GlobalACSStrings.PromoteStringArray(&stack->buffer[0], stack->sp);
+	}
+	FBehavior::StaticPromoteLevelVarStrings();
+	GlobalACSStrings.PromoteStringArray(ACS_WorldVars, countof(ACS_WorldVars));
+	GlobalACSStrings.PromoteStringArray(ACS_GlobalVars, countof(ACS_GlobalVars));
+	GlobalACSStrings.PurgeYoungStrings();
+}
+
+//============================================================================
+//
+// P_StepACSGlobalStrings
+//
+// Continues an incremental collection by marking world and global arrays
+// until about acs_gcmarkstep values have been looked at. An array is always
+// marked in one go because TMap may move its pairs around when written to.
+// Once all arrays are done, the remaining variables are marked and the pool
+// is purged.
+//
+//============================================================================
+
+static void P_StepACSGlobalStrings()
+{
+	if (!GlobalACSStrings.IsMarking())
+	{
+		return;
+	}
+
+	const unsigned int numarrays = NUM_WORLDVARS + NUM_GLOBALVARS;
+	unsigned int cursor = GlobalACSStrings.GetMarkCursor();
+	int budget = acs_gcmarkstep;
+
+	while (cursor < numarrays && (budget > 0 || acs_gcmarkstep <= 0))
+	{
+		const FWorldGlobalArray &aray = cursor < NUM_WORLDVARS ?
+			ACS_WorldArrays[cursor] : ACS_GlobalArrays[cursor - NUM_WORLDVARS];
+		GlobalACSStrings.MarkStringMap(aray);
+		budget -= aray.CountUsed() + 1;
+		cursor++;
+	}
+	if (cursor < numarrays)
+	{
+		GlobalACSStrings.SetMarkCursor(cursor);
+		return;
+	}
+	P_MarkStackStrings();
+	FBehavior::StaticMarkLevelVarStrings();
+	GlobalACSStrings.MarkStringArray(ACS_WorldVars, countof(ACS_WorldVars));
+	GlobalACSStrings.MarkStringArray(ACS_GlobalVars, countof(ACS_GlobalVars));
+	GlobalACSStrings.PurgeStrings();
+}
+
 #ifdef _DEBUG
 CCMD(acsgc)
 {
@@ -2202,6 +2428,22 @@ void FBehavior::StaticMarkLevelVarStrings()
 	}
 }
 
+void FBehavior::StaticPromoteLevelVarStrings()
+{
+	// Map arrays are not included. Everything stored in them has been promoted already.
+	for (uint32_t modnum = 0; modnum < StaticModules.Size(); ++modnum)
+	{
+		StaticModules[modnum]->PromoteMapVarStrings();
+	}
+	if (DACSThinker::ActiveThinker != NULL)
+	{
+		for (DLevelScript *script = DACSThinker::ActiveThinker->Scripts; script != NULL; script = script->GetNext())
+		{
+			script->PromoteLocalVarStrings();
+		}
+	}
+}
+
 void FBehavior::StaticLockLevelVarStrings()
 {
 	// Lock map variables.
@@ -2233,6 +2475,11 @@ void FBehavior::MarkMapVarStrings() const
 	}
 }
 
+void FBehavior::PromoteMapVarStrings() const
+{
+	GlobalACSStrings.PromoteStringArray(MapVarStore, NUM_MAPVARS);
+}
+
 void FBehavior::LockMapVarStrings() const
 {
 	GlobalACSStrings.LockStringArray(MapVarStore, NUM_MAPVARS);
@@ -2695,6 +2942,7 @@ bool FBehavior::Init(int lumpnum, FileReader * fr, int len)
 							if (str != NULL)
 							{
 								*elems = GlobalACSStrings.AddString(str);
+								GlobalACSStrings.PromoteString(*elems);
 							}
 						}
 					}
@@ -2729,6 +2977,7 @@ bool FBehavior::Init(int lumpnum, FileReader * fr, int len)
 								if (str != NULL)
 								{
 									*elems = GlobalACSStrings.AddString(str);
+									GlobalACSStrings.PromoteString(*elems);
 								}
 							}
 						}
@@ -2860,7 +3109,9 @@ bool FBehavior::Init(int lumpnum, FileReader * fr, int len)
 		}
 	}
 
-	DPrintf (DMSG_NOTIFY, "Loaded %d scripts, %d functions\n", NumScripts, NumFunctions);
+	DecodeScripts ();
+
+	DPrintf (DMSG_NOTIFY, "Loaded %d scripts, %d functions, %u decoded p-code sequences\n", NumScripts, NumFunctions, DecodedOps.Size());
 	return true;
 }
 
@@ -3105,6 +3356,552 @@ void FBehavior::LoadScriptsDirectory ()
 	}
 }
 
+CVAR(Bool, acs_decodescripts, true, 0)
+
+//============================================================================
+//
+// GetPCodeOperands
+//
+// Describes the operands that follow a p-code: a number of operands read
+// with NEXTBYTE and NEXTSHORT, full words and raw bytes. PCD_PUSHBYTES and
+// PCD_CASEGOTOSORTED have variable length and are handled by the caller.
+// Returns false for p-codes the interpreter does not handle.
+//
+//============================================================================
+
+struct FPCodeOperands
+{
+	int NextBytes;
+	int NextShorts;
+	int Words;
+	int RawBytes;
+};
+
+static bool GetPCodeOperands (int pcd, FPCodeOperands &ops)
+{
+	ops.NextBytes = ops.NextShorts = ops.Words = ops.RawBytes = 0;
+
+	switch (pcd)
+	{
+	case PCD_LSPEC6:
+	case PCD_LSPEC6DIRECT:
+	case PCD_SETSTYLE:
+	case PCD_SETSTYLEDIRECT:
+	case PCD_PLAYERBLUESKULL:
+	case PCD_PLAYERREDSKULL:
+	case PCD_PLAYERYELLOWSKULL:
+	case PCD_PLAYERMASTERSKULL:
+	case PCD_PLAYERBLUECARD:
+	case PCD_PLAYERREDCARD:
+	case PCD_PLAYERYELLOWCARD:
+	case PCD_PLAYERMASTERCARD:
+	case PCD_PLAYERBLACKSKULL:
+	case PCD_PLAYERSILVERSKULL:
+	case PCD_PLAYERGOLDSKULL:
+	case PCD_PLAYERBLACKCARD:
+	case PCD_PLAYERSILVERCARD:
+	case PCD_PLAYEREXPERT:
+	case PCD_BLUETEAMCOUNT:
+	case PCD_REDTEAMCOUNT:
+	case PCD_BLUETEAMSCORE:
+	case PCD_REDTEAMSCORE:
+	case PCD_ISONEFLAGCTF:
+	case PCD_WRITETOINI:
+	case PCD_GETFROMINI:
+	case PCD_GRABINPUT:
+	case PCD_SETMOUSEPOINTER:
+	case PCD_MOVEMOUSEPOINTER:
+		return false;
+
+	case PCD_LSPEC1:
+	case PCD_LSPEC2:
+	case PCD_LSPEC3:
+	case PCD_LSPEC4:
+	case PCD_LSPEC5:
+	case PCD_LSPEC5RESULT:
+	case PCD_CALL:
+	case PCD_CALLDISCARD:
+	case PCD_PUSHFUNCTION:
+	case PCD_ASSIGNSCRIPTVAR: case PCD_ASSIGNMAPVAR: case PCD_ASSIGNWORLDVAR: case PCD_ASSIGNGLOBALVAR:
+	case PCD_PUSHSCRIPTVAR: case PCD_PUSHMAPVAR: case PCD_PUSHWORLDVAR: case PCD_PUSHGLOBALVAR:
+	case PCD_ADDSCRIPTVAR: case PCD_ADDMAPVAR: case PCD_ADDWORLDVAR: case PCD_ADDGLOBALVAR:
+	case PCD_SUBSCRIPTVAR: case PCD_SUBMAPVAR: case PCD_SUBWORLDVAR: case PCD_SUBGLOBALVAR:
+	case PCD_MULSCRIPTVAR: case PCD_MULMAPVAR: case PCD_MULWORLDVAR: case PCD_MULGLOBALVAR:
+	case PCD_DIVSCRIPTVAR: case PCD_DIVMAPVAR: case PCD_DIVWORLDVAR: case PCD_DIVGLOBALVAR:
+	case PCD_MODSCRIPTVAR: case PCD_MODMAPVAR: case PCD_MODWORLDVAR: case PCD_MODGLOBALVAR:
+	case PCD_INCSCRIPTVAR: case PCD_INCMAPVAR: case PCD_INCWORLDVAR: case PCD_INCGLOBALVAR:
+	case PCD_DECSCRIPTVAR: case PCD_DECMAPVAR: case PCD_DECWORLDVAR: case PCD_DECGLOBALVAR:
+	case PCD_ANDSCRIPTVAR: case PCD_ANDMAPVAR: case PCD_ANDWORLDVAR: case PCD_ANDGLOBALVAR:
+	case PCD_EORSCRIPTVAR: case PCD_EORMAPVAR: case PCD_EORWORLDVAR: case PCD_EORGLOBALVAR:
+	case PCD_ORSCRIPTVAR: case PCD_ORMAPVAR: case PCD_ORWORLDVAR: case PCD_ORGLOBALVAR:
+	case PCD_LSSCRIPTVAR: case PCD_LSMAPVAR: case PCD_LSWORLDVAR: case PCD_LSGLOBALVAR:
+	case PCD_RSSCRIPTVAR: case PCD_RSMAPVAR: case PCD_RSWORLDVAR: case PCD_RSGLOBALVAR:
+	case PCD_ASSIGNSCRIPTARRAY: case PCD_ASSIGNMAPARRAY: case PCD_ASSIGNWORLDARRAY: case PCD_ASSIGNGLOBALARRAY:
+	case PCD_PUSHSCRIPTARRAY: case PCD_PUSHMAPARRAY: case PCD_PUSHWORLDARRAY: case PCD_PUSHGLOBALARRAY:
+	case PCD_ADDSCRIPTARRAY: case PCD_ADDMAPARRAY: case PCD_ADDWORLDARRAY: case PCD_ADDGLOBALARRAY:
+	case PCD_SUBSCRIPTARRAY: case PCD_SUBMAPARRAY: case PCD_SUBWORLDARRAY: case PCD_SUBGLOBALARRAY:
+	case PCD_MULSCRIPTARRAY: case PCD_MULMAPARRAY: case PCD_MULWORLDARRAY: case PCD_MULGLOBALARRAY:
+	case PCD_DIVSCRIPTARRAY: case PCD_DIVMAPARRAY: case PCD_DIVWORLDARRAY: case PCD_DIVGLOBALARRAY:
+	case PCD_MODSCRIPTARRAY: case PCD_MODMAPARRAY: case PCD_MODWORLDARRAY: case PCD_MODGLOBALARRAY:
+	case PCD_INCSCRIPTARRAY: case PCD_INCMAPARRAY: case PCD_INCWORLDARRAY: case PCD_INCGLOBALARRAY:
+	case PCD_DECSCRIPTARRAY: case PCD_DECMAPARRAY: case PCD_DECWORLDARRAY: case PCD_DECGLOBALARRAY:
+	case PCD_ANDSCRIPTARRAY: case PCD_ANDMAPARRAY: case PCD_ANDWORLDARRAY: case PCD_ANDGLOBALARRAY:
+	case PCD_EORSCRIPTARRAY: case PCD_EORMAPARRAY: case PCD_EORWORLDARRAY: case PCD_EORGLOBALARRAY:
+	case PCD_ORSCRIPTARRAY: case PCD_ORMAPARRAY: case PCD_ORWORLDARRAY: case PCD_ORGLOBALARRAY:
+	case PCD_LSSCRIPTARRAY: case PCD_LSMAPARRAY: case PCD_LSWORLDARRAY: case PCD_LSGLOBALARRAY:
+	case PCD_RSSCRIPTARRAY: case PCD_RSMAPARRAY: case PCD_RSWORLDARRAY: case PCD_RSGLOBALARRAY:
+		ops.NextBytes = 1;
+		break;
+
+	case PCD_CALLFUNC:
+		ops.NextBytes = 1;
+		ops.NextShorts = 1;
+		break;
+
+	case PCD_LSPEC1DIRECT:
+	case PCD_LSPEC2DIRECT:
+	case PCD_LSPEC3DIRECT:
+	case PCD_LSPEC4DIRECT:
+	case PCD_LSPEC5DIRECT:
+		ops.NextBytes = 1;
+		ops.Words = pcd - PCD_LSPEC1DIRECT + 1;
+		break;
+
+	case PCD_PUSHNUMBER:
+	case PCD_LSPEC5EX:
+	case PCD_LSPEC5EXRESULT:
+	case PCD_GOTO:
+	case PCD_IFGOTO:
+	case PCD_IFNOTGOTO:
+	case PCD_DELAYDIRECT:
+	case PCD_TAGWAITDIRECT:
+	case PCD_POLYWAITDIRECT:
+	case PCD_SCRIPTWAITDIRECT:
+	case PCD_SETGRAVITYDIRECT:
+	case PCD_SETAIRCONTROLDIRECT:
+	case PCD_CHECKINVENTORYDIRECT:
+	case PCD_SETFONTDIRECT:
+		ops.Words = 1;
+		break;
+
+	case PCD_CASEGOTO:
+	case PCD_RANDOMDIRECT:
+	case PCD_THINGCOUNTDIRECT:
+	case PCD_CHANGEFLOORDIRECT:
+	case PCD_CHANGECEILINGDIRECT:
+	case PCD_GIVEINVENTORYDIRECT:
+	case PCD_TAKEINVENTORYDIRECT:
+		ops.Words = 2;
+		break;
+
+	case PCD_CONSOLECOMMANDDIRECT:
+	case PCD_SETMUSICDIRECT:
+	case PCD_LOCALSETMUSICDIRECT:
+		ops.Words = 3;
+		break;
+
+	case PCD_SPAWNSPOTDIRECT:
+		ops.Words = 4;
+		break;
+
+	case PCD_SPAWNDIRECT:
+		ops.Words = 6;
+		break;
+
+	case PCD_PUSHBYTE:
+	case PCD_DELAYDIRECTB:
+		ops.RawBytes = 1;
+		break;
+
+	case PCD_RANDOMDIRECTB:
+	case PCD_PUSH2BYTES:
+		ops.RawBytes = 2;
+		break;
+
+	case PCD_PUSH3BYTES:
+	case PCD_PUSH4BYTES:
+	case PCD_PUSH5BYTES:
+		ops.RawBytes = pcd - PCD_PUSH3BYTES + 3;
+		break;
+
+	case PCD_LSPEC1DIRECTB:
+	case PCD_LSPEC2DIRECTB:
+	case PCD_LSPEC3DIRECTB:
+	case PCD_LSPEC4DIRECTB:
+	case PCD_LSPEC5DIRECTB:
+		ops.RawBytes = pcd - PCD_LSPEC1DIRECTB + 2;
+		break;
+
+	default:
+		return pcd >= 0 && pcd < PCODE_COMMAND_COUNT;
+	}
+	return true;
+}
+
+//============================================================================
+//
+// FBehavior :: DecodeScripts
+//
+// Walks the code of every script and function and replaces common
+// sequences of p-codes with a single decoded instruction. The replacement
+// p-code is written over the first p-code of the sequence, so the offsets
+// of all instructions stay the same and jumps and savegames are not
+// affected. Sequences that contain a jump target are left alone.
+//
+//============================================================================
+
+struct FDecodedPCode
+{
+	uint32_t Ofs;
+	uint32_t Next;
+	int PCode;
+	int Operand;		// first operand, if any
+	int NumLiterals;	// values pushed by a push p-code
+	int Literals[5];
+};
+
+static int SortDecodedPCodes (const void *a, const void *b)
+{
+	uint32_t ofs1 = ((const FDecodedPCode *)a)->Ofs;
+	uint32_t ofs2 = ((const FDecodedPCode *)b)->Ofs;
+	return ofs1 < ofs2 ? -1 : ofs1 > ofs2 ? 1 : 0;
+}
+
+void FBehavior::DecodeScripts ()
+{
+	enum
+	{
+		CODE_Start = 1,		// an instruction starts here
+		CODE_Operand = 2,	// part of an instruction, but not its start
+		CODE_Target = 4,	// something jumps here
+	};
+
+	DecodedOps.Clear();
+	if (!acs_decodescripts || Format == ACS_Unknown)
+	{
+		return;
+	}
+
+	// The code always comes before the chunks or the old style script directory.
+	uint32_t codesize = MIN<uint32_t>(DataSize, uint32_t(Chunks - Data));
+	codesize = MIN<uint32_t>(codesize, LittleLong(((uint32_t *)Data)[1]));
+	if (codesize <= 8)
+	{
+		return;
+	}
+
+	const bool compact = (Format == ACS_LittleEnhanced);
+	const int bytesize = compact ? 1 : 4;
+	const int shortsize = compact ? 2 : 4;
+	TArray<uint8_t> flags;
+	TArray<uint32_t> pending;
+	TArray<FDecodedPCode> code;
+	unsigned int i;
+
+	flags.Resize(codesize);
+	memset(&flags[0], 0, codesize);
+
+	auto addtarget = [&](uint32_t ofs)
+	{
+		if (ofs >= 8 && ofs < codesize)
+		{
+			flags[ofs] |= CODE_Target;
+			pending.Push(ofs);
+		}
+	};
+	auto readword = [&](uint32_t ofs)
+	{
+		return uallong(*(int *)(Data + ofs));
+	};
+
+	for (i = 0; i < (unsigned)NumScripts; ++i)
+	{
+		addtarget(Scripts[i].Address);
+	}
+	for (i = 0; i < (unsigned)NumFunctions; ++i)
+	{
+		ScriptFunction *func = &Functions[i];
+		if (func->ImportNum == 0 && func->Address != 0)
+		{
+			addtarget(func->Address);
+		}
+	}
+	for (i = 0; i < JumpPoints.Size(); ++i)
+	{
+		addtarget(JumpPoints[i]);
+	}
+
+	// Follow the control flow from every entry point. Anything that cannot be
+	// decoded unambiguously ends the walk, because that code can never run
+	// anyway. If two walks disagree about where an instruction starts, the
+	// module is left as it is.
+	uint32_t ofs;
+	while (pending.Pop(ofs))
+	{
+		while (ofs < codesize && !(flags[ofs] & CODE_Start))
+		{
+			if (flags[ofs] & CODE_Operand)
+			{
+				return;
+			}
+
+			FDecodedPCode ins;
+			FPCodeOperands ops;
+			uint32_t p = ofs;
+
+			if (compact)
+			{
+				ins.PCode = Data[p++];
+				if (ins.PCode >= 256-16)
+				{
+					if (p >= codesize) break;
+					ins.PCode = (256-16) + ((ins.PCode - (256-16)) << 8) + Data[p++];
+				}
+			}
+			else
+			{
+				if (p + 4 > codesize) break;
+				ins.PCode = readword(p);
+				p += 4;
+			}
+			if (!GetPCodeOperands(ins.PCode, ops))
+			{
+				break;
+			}
+
+			ins.Ofs = ofs;
+			ins.Operand = 0;
+			ins.NumLiterals = 0;
+
+			bool terminal = false;
+			uint32_t opstart = p;
+			if (ins.PCode == PCD_PUSHBYTES)
+			{
+				if (p >= codesize) break;
+				int count = Data[p];
+				if (p + 1 + count > codesize) break;
+				if (count >= 1 && count <= 5)
+				{
+					ins.NumLiterals = count;
+					for (int j = 0; j < count; ++j)
+					{
+						ins.Literals[j] = Data[p + 1 + j];
+					}
+				}
+				p += 1 + count;
+			}
+			else if (ins.PCode == PCD_CASEGOTOSORTED)
+			{
+				p = uint32_t((((size_t)(Data + p) + 3) & ~3) - (size_t)Data);
+				if (p + 4 > codesize) break;
+				int numcases = readword(p);
+				p += 4;
+				if (numcases < 0 || numcases > int((codesize - p) / 8)) break;
+				for (int j = 0; j < numcases; ++j)
+				{
+					addtarget(readword(p + j*8 + 4));
+				}
+				p += numcases * 8;
+			}
+			else
+			{
+				p += ops.NextBytes * bytesize + ops.NextShorts * shortsize + ops.Words * 4 + ops.RawBytes;
+				if (p > codesize) break;
+
+				if (ops.NextBytes > 0)
+				{
+					ins.Operand = compact ? Data[opstart] : readword(opstart);
+				}
+				else if (ops.Words > 0)
+				{
+					ins.Operand = readword(opstart);
+				}
+				else if (ops.RawBytes > 0)
+				{
+					ins.Operand = Data[opstart];
+				}
+
+				switch (ins.PCode)
+				{
+				case PCD_PUSHNUMBER:
+				case PCD_PUSHBYTE:
+					ins.NumLiterals = 1;
+					ins.Literals[0] = ins.Operand;
+					break;
+
+				case PCD_PUSH2BYTES:
+				case PCD_PUSH3BYTES:
+				case PCD_PUSH4BYTES:
+				case PCD_PUSH5BYTES:
+					ins.NumLiterals = ops.RawBytes;
+					for (int j = 0; j < ops.RawBytes; ++j)
+					{
+						ins.Literals[j] = Data[opstart + j];
+					}
+					break;
+
+				case PCD_GOTO:
+					terminal = true;
+					// fall through
+				case PCD_IFGOTO:
+				case PCD_IFNOTGOTO:
+					addtarget(ins.Operand);
+					break;
+
+				case PCD_CASEGOTO:
+					addtarget(readword(opstart + 4));
+					break;
+
+				case PCD_TERMINATE:
+				case PCD_RESTART:
+				case PCD_GOTOSTACK:
+				case PCD_RETURNVOID:
+				case PCD_RETURNVAL:
+					terminal = true;
+					break;
+				}
+			}
+
+			for (uint32_t j = ofs + 1; j < p; ++j)
+			{
+				if (flags[j] & (CODE_Start | CODE_Target))
+				{
+					return;
+				}
+				flags[j] |= CODE_Operand;
+			}
+			flags[ofs] |= CODE_Start;
+			ins.Next = p;
+			code.Push(ins);
+
+			if (terminal)
+			{
+				break;
+			}
+			ofs = p;
+		}
+	}
+	if (code.Size() == 0)
+	{
+		return;
+	}
+	qsort(&code[0], code.Size(), sizeof(FDecodedPCode), SortDecodedPCodes);
+
+	// The replacement p-code needs two bytes in compact modules and a full word otherwise.
+	const int maxops = compact ? (256-16) + (15 << 8) + 256 - ACS_DECODED_PCODE : 65536;
+	auto follows = [&](unsigned int k)
+	{
+		// true if code[k] is reached only by falling through from code[k-1]
+		return k < code.Size() && code[k].Ofs == code[k-1].Next && !(flags[code[k].Ofs] & CODE_Target);
+	};
+
+	for (i = 0; i < code.Size() && (int)DecodedOps.Size() < maxops; ++i)
+	{
+		const FDecodedPCode &ins = code[i];
+		ACSDecodedOp op;
+		int count = 0;
+
+		memset(&op, 0, sizeof(op));
+
+		if (ins.PCode == PCD_PUSHSCRIPTVAR &&
+			follows(i+1) && code[i+1].NumLiterals == 1 &&
+			follows(i+2) && code[i+2].PCode >= PCD_EQ && code[i+2].PCode <= PCD_GE &&
+			follows(i+3) && code[i+3].PCode == PCD_IFNOTGOTO)
+		{
+			op.Kind = uint8_t(ACSDecodedOp::BranchScriptVarEQ + code[i+2].PCode - PCD_EQ);
+			op.Var = ins.Operand;
+			op.Value = code[i+1].Literals[0];
+			op.Target = code[i+3].Operand;
+			count = 4;
+		}
+		else if (ins.NumLiterals > 0)
+		{
+			// Collect the arguments for a line special.
+			int numargs = 0;
+			for (unsigned int k = i; numargs + code[k].NumLiterals <= 5; )
+			{
+				for (int j = 0; j < code[k].NumLiterals; ++j)
+				{
+					op.Args[numargs++] = code[k].Literals[j];
+				}
+				if (!follows(++k))
+				{
+					break;
+				}
+				if (code[k].PCode == PCD_LSPEC1 + numargs - 1)
+				{
+					op.Kind = ACSDecodedOp::LineSpecial;
+					op.Var = code[k].Operand;
+					op.ArgCount = uint8_t(numargs);
+					count = k - i + 1;
+					break;
+				}
+				if (code[k].NumLiterals == 0)
+				{
+					break;
+				}
+			}
+
+			if (count == 0 && ins.NumLiterals == 1 && follows(i+1))
+			{
+				op.Value = ins.Literals[0];
+				op.Var = code[i+1].Operand;
+				count = 2;
+				switch (code[i+1].PCode)
+				{
+				case PCD_ADD:				op.Kind = ACSDecodedOp::AddLiteral;				break;
+				case PCD_SUBTRACT:			op.Kind = ACSDecodedOp::SubtractLiteral;		break;
+				case PCD_MULTIPLY:			op.Kind = ACSDecodedOp::MultiplyLiteral;		break;
+				case PCD_ANDBITWISE:		op.Kind = ACSDecodedOp::AndLiteral;				break;
+				case PCD_ORBITWISE:			op.Kind = ACSDecodedOp::OrLiteral;				break;
+				case PCD_EORBITWISE:		op.Kind = ACSDecodedOp::EorLiteral;				break;
+				case PCD_LSHIFT:			op.Kind = ACSDecodedOp::LShiftLiteral;			break;
+				case PCD_RSHIFT:			op.Kind = ACSDecodedOp::RShiftLiteral;			break;
+				case PCD_EQ:				op.Kind = ACSDecodedOp::EQLiteral;				break;
+				case PCD_NE:				op.Kind = ACSDecodedOp::NELiteral;				break;
+				case PCD_LT:				op.Kind = ACSDecodedOp::LTLiteral;				break;
+				case PCD_GT:				op.Kind = ACSDecodedOp::GTLiteral;				break;
+				case PCD_LE:				op.Kind = ACSDecodedOp::LELiteral;				break;
+				case PCD_GE:				op.Kind = ACSDecodedOp::GELiteral;				break;
+				case PCD_ASSIGNSCRIPTVAR:	op.Kind = ACSDecodedOp::AssignScriptVarLiteral;	break;
+				case PCD_ADDSCRIPTVAR:		op.Kind = ACSDecodedOp::AddScriptVarLiteral;	break;
+
+				case PCD_ASSIGNMAPVAR:
+					op.Kind = ACSDecodedOp::AssignMapVarLiteral;
+					if ((unsigned)op.Var >= NUM_MAPVARS) count = 0;
+					break;
+
+				default:
+					count = 0;
+					break;
+				}
+			}
+		}
+
+		if (count == 0)
+		{
+			continue;
+		}
+
+		op.Count = uint8_t(count);
+		op.Next = code[i + count - 1].Next;
+
+		// Write the replacement p-code over the first p-code of the sequence.
+		int pcd = ACS_DECODED_PCODE + DecodedOps.Push(op);
+		if (compact)
+		{
+			Data[ins.Ofs] = uint8_t((256-16) + ((pcd - (256-16)) >> 8));
+			Data[ins.Ofs + 1] = uint8_t((pcd - (256-16)) & 255);
+		}
+		else
+		{
+			uint32_t word = LittleLong(uint32_t(pcd));
+			memcpy(Data + ins.Ofs, &word, 4);
+		}
+		i += count - 1;
+	}
+}
+
 int FBehavior::SortScripts (const void *a, const void *b)
 {
 	ScriptPtr *ptr1 = (ScriptPtr *)a;
@@ -3338,6 +4135,7 @@ void FBehavior::SetArrayVal (int arraynum, int index, int value)
 	if ((unsigned)index >= (unsigned)array->ArraySize)
 		return;
 	array->Elements[index] = value;
+	GlobalACSStrings.PromoteString(value);
 }
 
 inline bool FBehavior::CopyStringToArray(int arraynum, int index, int maxLength, const char *string)
@@ -3607,7 +4405,8 @@ void DACSThinker::Tick ()
 		script = next;
 	}
 
-//	GlobalACSStrings.Clear();
+	P_CollectACSYoungStrings();
+	P_StepACSGlobalStrings();
 
 	if (ACS_StringBuilderStack.Size())
 	{
@@ -5100,6 +5899,8 @@ static void SetUserVariable(AActor *self, FName varname, int index, int value)
 	{
 		if (!type->isFloat())
 		{
+			// Actors are not scanned for strings, so keep anything stored here alive until the next full collection.
+			GlobalACSStrings.PromoteString(value);
 			type->SetValue(addr, value);
 		}
 		else
@@ -7079,6 +7880,65 @@ int DLevelScript::RunScript ()
 		switch (pcd)
 		{
 		default:
+			if (pcd >= ACS_DECODED_PCODE)
+			{
+				const ACSDecodedOp *op = activeBehavior->GetDecodedOp(pcd);
+				if (op != NULL)
+				{
+					// Count the replaced p-codes so that runaway detection and profiling are unchanged.
+					runaway += op->Count - 1;
+					pc = activeBehavior->Ofs2PC(op->Next);
+					switch (op->Kind)
+					{
+					case ACSDecodedOp::AddLiteral:				STACK(1) += op->Value;						break;
+					case ACSDecodedOp::SubtractLiteral:			STACK(1) -= op->Value;						break;
+					case ACSDecodedOp::MultiplyLiteral:			STACK(1) *= op->Value;						break;
+					case ACSDecodedOp::AndLiteral:				STACK(1) &= op->Value;						break;
+					case ACSDecodedOp::OrLiteral:				STACK(1) |= op->Value;						break;
+					case ACSDecodedOp::EorLiteral:				STACK(1) ^= op->Value;						break;
+					case ACSDecodedOp::LShiftLiteral:			STACK(1) <<= op->Value;						break;
+					case ACSDecodedOp::RShiftLiteral:			STACK(1) >>= op->Value;						break;
+					case ACSDecodedOp::EQLiteral:				STACK(1) = (STACK(1) == op->Value);			break;
+					case ACSDecodedOp::NELiteral:				STACK(1) = (STACK(1) != op->Value);			break;
+					case ACSDecodedOp::LTLiteral:				STACK(1) = (STACK(1) < op->Value);			break;
+					case ACSDecodedOp::GTLiteral:				STACK(1) = (STACK(1) > op->Value);			break;
+					case ACSDecodedOp::LELiteral:				STACK(1) = (STACK(1) <= op->Value);			break;
+					case ACSDecodedOp::GELiteral:				STACK(1) = (STACK(1) >= op->Value);			break;
+					case ACSDecodedOp::AssignScriptVarLiteral:	locals[op->Var] = op->Value;				break;
+					case ACSDecodedOp::AssignMapVarLiteral:		*(activeBehavior->MapVars[op->Var]) = op->Value;	break;
+					case ACSDecodedOp::AddScriptVarLiteral:		locals[op->Var] += op->Value;				break;
+
+					case ACSDecodedOp::BranchScriptVarEQ:
+						if (!(locals[op->Var] == op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+					case ACSDecodedOp::BranchScriptVarNE:
+						if (!(locals[op->Var] != op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+					case ACSDecodedOp::BranchScriptVarLT:
+						if (!(locals[op->Var] < op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+					case ACSDecodedOp::BranchScriptVarGT:
+						if (!(locals[op->Var] > op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+					case ACSDecodedOp::BranchScriptVarLE:
+						if (!(locals[op->Var] <= op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+					case ACSDecodedOp::BranchScriptVarGE:
+						if (!(locals[op->Var] >= op->Value)) pc = activeBehavior->Ofs2PC(op->Target);
+						break;
+
+					case ACSDecodedOp::LineSpecial:
+						P_ExecuteSpecial(op->Var, activationline, activator, backSide,
+										op->Args[0] & specialargmask,
+										op->Args[1] & specialargmask,
+										op->Args[2] & specialargmask,
+										op->Args[3] & specialargmask,
+										op->Args[4] & specialargmask);
+						break;
+					}
+					break;
+				}
+			}
 			Printf ("Unknown P-Code %d in %s\n", pcd, ScriptPresentation(script).GetChars());
 			activeBehavior = savedActiveBehavior;
 			// fall through
@@ -7521,11 +8381,13 @@ int DLevelScript::RunScript ()
 
 		case PCD_ASSIGNWORLDARRAY:
 			ACS_WorldArrays[NEXTBYTE][STACK(2)] = STACK(1);
+			GlobalACSStrings.PromoteString(STACK(1));
 			sp -= 2;
 			break;
 
 		case PCD_ASSIGNGLOBALARRAY:
 			ACS_GlobalArrays[NEXTBYTE][STACK(2)] = STACK(1);
+			GlobalACSStrings.PromoteString(STACK(1));
 			sp -= 2;
 			break;
 
@@ -7601,7 +8463,7 @@ int DLevelScript::RunScript ()
 		case PCD_ADDWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] += STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] += STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7609,7 +8471,7 @@ int DLevelScript::RunScript ()
 		case PCD_ADDGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] += STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] += STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7654,7 +8516,7 @@ int DLevelScript::RunScript ()
 		case PCD_SUBWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] -= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] -= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7662,7 +8524,7 @@ int DLevelScript::RunScript ()
 		case PCD_SUBGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] -= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] -= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7707,7 +8569,7 @@ int DLevelScript::RunScript ()
 		case PCD_MULWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] *= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] *= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7715,7 +8577,7 @@ int DLevelScript::RunScript ()
 		case PCD_MULGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] *= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] *= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7803,7 +8665,7 @@ int DLevelScript::RunScript ()
 			else
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] /= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] /= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7816,7 +8678,7 @@ int DLevelScript::RunScript ()
 			else
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] /= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] /= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7904,7 +8766,7 @@ int DLevelScript::RunScript ()
 			else
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] %= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] %= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7917,7 +8779,7 @@ int DLevelScript::RunScript ()
 			else
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] %= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] %= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7963,7 +8825,7 @@ int DLevelScript::RunScript ()
 		case PCD_ANDWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] &= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] &= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -7971,7 +8833,7 @@ int DLevelScript::RunScript ()
 		case PCD_ANDGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] &= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] &= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8016,7 +8878,7 @@ int DLevelScript::RunScript ()
 		case PCD_EORWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] ^= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] ^= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8024,7 +8886,7 @@ int DLevelScript::RunScript ()
 		case PCD_EORGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] ^= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] ^= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8069,7 +8931,7 @@ int DLevelScript::RunScript ()
 		case PCD_ORWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] |= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] |= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8078,7 +8940,7 @@ int DLevelScript::RunScript ()
 			{
 				int a = NEXTBYTE;
 				int i = STACK(2);
-				ACS_GlobalArrays[a][STACK(2)] |= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] |= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8123,7 +8985,7 @@ int DLevelScript::RunScript ()
 		case PCD_LSWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] <<= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] <<= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8131,7 +8993,7 @@ int DLevelScript::RunScript ()
 		case PCD_LSGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] <<= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] <<= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8176,7 +9038,7 @@ int DLevelScript::RunScript ()
 		case PCD_RSWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(2)] >>= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(2)] >>= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8184,7 +9046,7 @@ int DLevelScript::RunScript ()
 		case PCD_RSGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(2)] >>= STACK(1);
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(2)] >>= STACK(1));
 				sp -= 2;
 			}
 			break;
@@ -8226,7 +9088,7 @@ int DLevelScript::RunScript ()
 		case PCD_INCWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(1)] += 1;
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(1)] += 1);
 				sp--;
 			}
 			break;
@@ -8234,7 +9096,7 @@ int DLevelScript::RunScript ()
 		case PCD_INCGLOBALARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_GlobalArrays[a][STACK(1)] += 1;
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(1)] += 1);
 				sp--;
 			}
 			break;
@@ -8275,7 +9137,7 @@ int DLevelScript::RunScript ()
 		case PCD_DECWORLDARRAY:
 			{
 				int a = NEXTBYTE;
-				ACS_WorldArrays[a][STACK(1)] -= 1;
+				GlobalACSStrings.PromoteString(ACS_WorldArrays[a][STACK(1)] -= 1);
 				sp--;
 			}
 			break;
@@ -8284,7 +9146,7 @@ int DLevelScript::RunScript ()
 			{
 				int a = NEXTBYTE;
 				int i = STACK(1);
-				ACS_GlobalArrays[a][STACK(1)] -= 1;
+				GlobalACSStrings.PromoteString(ACS_GlobalArrays[a][STACK(1)] -= 1);
 				sp--;
 			}
 			break;
@@ -9137,6 +9999,7 @@ scriptwait:
 						break;
 					}
 				}
+				P_InvalidateSightCache();
 
 				sp -= 2;
 			}
@@ -11066,3 +11929,10 @@ ADD_STAT(ACS)
 {
 	return FStringf("ACS time: %f ms", ACSTime.TimeMS());
 }
+
+ADD_STAT(ACSStrings)
+{
+	return FStringf("ACS strings: %u, %u young, %u buckets%s", GlobalACSStrings.CountStrings(),
+		GlobalACSStrings.CountYoungStrings(), GlobalACSStrings.CountBuckets(),
+		GlobalACSStrings.IsMarking() ? ", marking" : "");
+}
@@ -90,7 +90,23 @@ public:
 	void UnlockStringArray(const int *strnum, unsigned int count);
 	void MarkStringArray(const int *strnum, unsigned int count);
 	void MarkStringMap(const FWorldGlobalArray &array);
+	void PromoteString(int strnum)
+	{
+		if ((strnum & LIBRARYID_MASK) == STRPOOL_LIBRARYID_OR)
+		{
+			PromoteEntry(strnum & ~LIBRARYID_MASK);
+		}
+	}
+	void PromoteStringArray(const int *strnum, unsigned int count);
 	void PurgeStrings();
+	void PurgeYoungStrings();
+	void StartMarking();
+	bool IsMarking() const { return MarkCursor != NO_ENTRY; }
+	unsigned int GetMarkCursor() const { return MarkCursor; }
+	void SetMarkCursor(unsigned int cursor) { MarkCursor = cursor; }
+	unsigned int CountStrings() const { return NumStrings; }
+	unsigned int CountYoungStrings() const { return YoungEntries.Size(); }
+	unsigned int CountBuckets() const { return PoolBuckets.Size(); }
 	void Clear();
 	void Dump() const;
 	void UnlockForLevel(int level)	;
@@ -98,11 +114,27 @@ public:
 	void WriteStrings(FSerializer &file, const char *key) const;
 
 private:
-	int FindString(const char *str, size_t len, unsigned int h, unsigned int bucketnum);
-	int InsertString(FString &str, unsigned int h, unsigned int bucketnum);
+	int FindString(const char *str, size_t len, unsigned int h);
+	int InsertString(FString &str, unsigned int h);
 	void FindFirstFreeEntry(unsigned int base);
+	void Rehash(unsigned int numbuckets);
+
+	// Stored values are promoted out of the young generation. While an
+	// incremental collection is running they are marked as well, so that
+	// arrays which were already marked cannot hide them from the purge.
+	void PromoteEntry(unsigned int num)
+	{
+		if (num < Pool.Size())
+		{
+			Pool[num].Young = false;
+			if (MarkCursor != NO_ENTRY)
+			{
+				Pool[num].Mark = true;
+			}
+		}
+	}
 
-	enum { NUM_BUCKETS = 251 };
+	enum { MIN_BUCKETS = 256 };			// Must be a power of 2
 	enum { FREE_ENTRY = 0xFFFFFFFE };	// Stored in PoolEntry's Next field
 	enum { NO_ENTRY = 0xFFFFFFFF };
 	enum { MIN_GC_SIZE = 100 };			// Don't auto-collect until there are this many strings
@@ -112,14 +144,18 @@ private:
 		unsigned int Hash;
 		unsigned int Next;
 		bool Mark;
+		bool Young;						// Created since the last young collection
 		TArray<int> Locks;
 
 		void Lock();
 		void Unlock();
 	};
 	TArray<PoolEntry> Pool;
-	unsigned int PoolBuckets[NUM_BUCKETS];
+	TArray<unsigned int> PoolBuckets;
+	TArray<unsigned int> YoungEntries;
 	unsigned int FirstFreeEntry;
+	unsigned int NumStrings;
+	unsigned int MarkCursor;			// Next world/global array to mark, or NO_ENTRY
 };
 extern ACSStringPool GlobalACSStrings;
 
@@ -324,6 +360,60 @@ enum
 
 enum ACSFormat { ACS_Old, ACS_Enhanced, ACS_LittleEnhanced, ACS_Unknown };
 
+// P-codes from this number on are not part of the ACS format. They are written
+// over common sequences of p-codes when a module is loaded and refer to an
+// entry in the module's DecodedOps.
+#define ACS_DECODED_PCODE		1024
+
+// A sequence of p-codes that has been decoded at load time so that it can be
+// executed as a single instruction.
+struct ACSDecodedOp
+{
+	enum
+	{
+		// push literal + binary operator
+		AddLiteral,
+		SubtractLiteral,
+		MultiplyLiteral,
+		AndLiteral,
+		OrLiteral,
+		EorLiteral,
+		LShiftLiteral,
+		RShiftLiteral,
+		EQLiteral,
+		NELiteral,
+		LTLiteral,
+		GTLiteral,
+		LELiteral,
+		GELiteral,
+
+		// push literal + variable assignment
+		AssignScriptVarLiteral,
+		AssignMapVarLiteral,
+		AddScriptVarLiteral,
+
+		// push script variable + push literal + comparison + ifnotgoto
+		BranchScriptVarEQ,
+		BranchScriptVarNE,
+		BranchScriptVarLT,
+		BranchScriptVarGT,
+		BranchScriptVarLE,
+		BranchScriptVarGE,
+
+		// push literals + lspec
+		LineSpecial,
+	};
+
+	uint8_t Kind;
+	uint8_t Count;		// number of p-codes this replaces
+	uint8_t ArgCount;
+	int Var;			// variable index or special number
+	int Value;
+	uint32_t Target;	// branch target
+	uint32_t Next;		// offset of the p-code following the sequence
+	int Args[5];
+};
+
 class FBehavior
 {
 public:
@@ -358,6 +448,11 @@ public:
 	ACSProfileInfo *GetFunctionProfileData(int index) { return index >= 0 && index < NumFunctions ? &FunctionProfileData[index] : NULL; }
 	ACSProfileInfo *GetFunctionProfileData(ScriptFunction *func) { return GetFunctionProfileData((int)(func - (ScriptFunction *)Functions)); }
 	const char *LookupString (uint32_t index) const;
+	const ACSDecodedOp *GetDecodedOp (int pcd) const
+	{
+		unsigned int index = unsigned(pcd - ACS_DECODED_PCODE);
+		return index < DecodedOps.Size() ? &DecodedOps[index] : NULL;
+	}
 
 	int32_t *MapVars[NUM_MAPVARS];
 
@@ -368,6 +463,7 @@ public:
 	static FBehavior *StaticGetModule (int lib);
 	static void StaticSerializeModuleStates (FSerializer &arc);
 	static void StaticMarkLevelVarStrings();
+	static void StaticPromoteLevelVarStrings();
 	static void StaticLockLevelVarStrings();
 	static void StaticUnlockLevelVarStrings();
 
@@ -400,10 +496,12 @@ private:
 	uint32_t LibraryID;
 	char ModuleName[9];
 	TArray<int> JumpPoints;
+	TArray<ACSDecodedOp> DecodedOps;
 
 	static TArray<FBehavior *> StaticModules;
 
 	void LoadScriptsDirectory ();
+	void DecodeScripts ();
 
 	static int SortScripts (const void *a, const void *b);
 	void UnencryptStrings ();
@@ -414,6 +512,7 @@ private:
 	void SerializeVarSet (FSerializer &arc, int32_t *vars, int max);
 
 	void MarkMapVarStrings() const;
+	void PromoteMapVarStrings() const;
 	void LockMapVarStrings() const;
 	void UnlockMapVarStrings() const;
 
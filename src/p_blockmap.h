@@ -6,22 +6,60 @@
 class AActor;
 
 // [RH] Like msecnode_t, but for the blockmap
+// Each actor keeps a chain of these to remember which blocks it is linked into.
 struct FBlockNode
 {
-	AActor *Me;						// actor this node references
 	int BlockIndex;					// index into blocklinks for the block this node is in
-	int Group;						// portal group this link belongs to (can be different than the actor's own group
-	FBlockNode **PrevActor;			// previous actor in this block
-	FBlockNode *NextActor;			// next actor in this block
-	FBlockNode **PrevBlock;			// previous block this actor is in
 	FBlockNode *NextBlock;			// next block this actor is in
 
-	static FBlockNode *Create (AActor *who, int x, int y, int group = -1);
+	static FBlockNode *Create (int x, int y);
 	void Release ();
 
 	static FBlockNode *FreeBlocks;
 };
 
+// One actor in a block's actor list. Unlinked actors leave a NULL entry
+// behind so that iterators walking the list stay valid; those get squeezed
+// out by FBlockmap::Compact at the start of the next tic.
+struct FBlockEntry
+{
+	AActor *Me;
+	bool Single;					// actor is only linked into this one block
+};
+
+struct FBlockCell
+{
+	TArray<FBlockEntry> Actors;		// iterated back to front, newest first
+	int Removed = 0;				// number of NULL entries in Actors
+
+	void Add(AActor *actor, bool single)
+	{
+		Actors.Push({ actor, single });
+	}
+
+	// Returns the entry's position so that player prediction can put it back there.
+	int Remove(AActor *actor)
+	{
+		for (int i = (int)Actors.Size() - 1; i >= 0; i--)
+		{
+			if (Actors[i].Me == actor)
+			{
+				Actors[i].Me = nullptr;
+				Removed++;
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	// Refills a slot that was left by Remove. Only valid as long as the block hasn't been compacted.
+	void Restore(int pos, AActor *actor)
+	{
+		Actors[pos].Me = actor;
+		Removed--;
+	}
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -39,7 +77,8 @@ struct FBlockmap
 	int					bmapheight; 	// in mapblocks
 	double				bmaporgx;
 	double				bmaporgy;		// origin of block map
-	FBlockNode**		blocklinks; 	// for thing chains
+	FBlockCell*			blocklinks; 	// for thing chains
+	TArray<int>			dirtyblocks;	// blocks with entries waiting to be compacted
 
 	// mapblocks are used to check movement
 	// against lines and things
@@ -75,6 +114,19 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count);
 
+	int Unlink(int index, AActor *actor)
+	{
+		FBlockCell &cell = blocklinks[index];
+		int pos = cell.Remove(actor);
+		if (pos >= 0 && cell.Removed == 1)
+		{
+			dirtyblocks.Push(index);
+		}
+		return pos;
+	}
+
+	void Compact();
+
 	void Clear()
 	{
 		if (blockmaplump != NULL)
@@ -87,6 +139,7 @@ struct FBlockmap
 			delete[] blocklinks;
 			blocklinks = NULL;
 		}
+		dirtyblocks.Clear();
 	}
 
 };
@@ -1436,13 +1436,16 @@ DEFINE_ACTION_FUNCTION(AActor, LookForMonsters)
 AActor *LookForTIDInBlock (AActor *lookee, int index, void *extparams)
 {
 	FLookExParams *params = (FLookExParams *)extparams;
-	FBlockNode *block;
+	auto &list = level.blockmap.blocklinks[index].Actors;
 	AActor *link;
 	AActor *other;
 	
-	for (block = level.blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (int i = (int)list.Size() - 1; i >= 0; i--)
 	{
-		link = block->Me;
+		link = list[i].Me;
+
+		if (link == nullptr)
+			continue;
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
@@ -1614,14 +1617,17 @@ DEFINE_ACTION_FUNCTION(AActor, LookForTID)
 
 AActor *LookForEnemiesInBlock (AActor *lookee, int index, void *extparam)
 {
-	FBlockNode *block;
+	auto &list = level.blockmap.blocklinks[index].Actors;
 	AActor *link;
 	AActor *other;
 	FLookExParams *params = (FLookExParams *)extparam;
 	
-	for (block = level.blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (int i = (int)list.Size() - 1; i >= 0; i--)
 	{
-		link = block->Me;
+		link = list[i].Me;
+
+		if (link == nullptr)
+			continue;
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
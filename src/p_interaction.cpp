@@ -1365,6 +1365,8 @@ static int DamageMobj (AActor *target, AActor *inflictor, AActor *source, int da
 		player->health -= damage;		// mirror mobj health here for Dave
 		// [RH] Make voodoo dolls and real players record the same health
 		target->health = player->mo->health -= damage;
+		target->TouchStateHash();
+		player->mo->TouchStateHash();
 		if (player->health < 50 && !deathmatch && !(flags & DMG_FORCED))
 		{
 			P_AutoUseStrifeHealth (player);
@@ -1421,6 +1423,7 @@ static int DamageMobj (AActor *target, AActor *inflictor, AActor *source, int da
 		}
 	
 		target->health -= damage;	
+		target->TouchStateHash();
 	}
 
 	//
@@ -1914,6 +1917,7 @@ void P_PoisonDamage (player_t *player, AActor *source, int damage, bool playPain
 	// do the damage
 	//
 	target->health -= damage;
+	target->TouchStateHash();
 	if (target->health <= 0)
 	{ // Death
 		if ((((player->cheats & CF_BUDDHA) || (player->cheats & CF_BUDDHA2) ||
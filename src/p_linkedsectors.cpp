@@ -39,6 +39,7 @@
 #include "p_spec.h"
 #include "g_levellocals.h"
 #include "vm.h"
+#include "p_statehash.h"
 
 enum
 {
@@ -105,6 +106,7 @@ DEFINE_ACTION_FUNCTION(_Sector, isLinked)
 static bool MoveCeiling(sector_t *sector, int crush, double move, bool instant)
 {
 	sector->ceilingplane.ChangeHeight (move);
+	P_StateHashSector(sector);
 	sector->ChangePlaneTexZ(sector_t::ceiling, move);
 
 	if (P_ChangeSector(sector, crush, move, 1, true, instant)) return false;
@@ -120,6 +122,7 @@ static bool MoveCeiling(sector_t *sector, int crush, double move, bool instant)
 static bool MoveFloor(sector_t *sector, int crush, double move, bool instant)
 {
 	sector->floorplane.ChangeHeight (move);
+	P_StateHashSector(sector);
 	sector->ChangePlaneTexZ(sector_t::floor, move);
 
 	if (P_ChangeSector(sector, crush, move, 0, true, instant)) return false;
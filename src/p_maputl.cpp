@@ -82,6 +82,7 @@
 #include "po_man.h"
 #include "g_levellocals.h"
 #include "vm.h"
+#include "p_tick.h"
 
 sector_t *P_PointInSectorBuggy(double x, double y);
 int P_VanillaPointOnDivlineSide(double x, double y, const divline_t* line);
@@ -332,11 +333,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 
 		while (block != NULL)
 		{
-			if (block->NextActor != NULL)
-			{
-				block->NextActor->PrevActor = block->PrevActor;
-			}
-			*(block->PrevActor) = block->NextActor;
+			level.blockmap.Unlink(block->BlockIndex, this);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -459,11 +456,23 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 		}
 	}
 
+	subsector_t *rendersub = nullptr;
 	if (sector == NULL)
 	{
 		if (!spawning)
 		{
-			sector = P_PointInSector(Pos());
+			// Use the result of the parallel pre-pass if it was made for exactly this spot.
+			if (LinkPrediction.Generation == P_LinkPredictionGeneration && LinkPrediction.Pos == Pos().XY())
+			{
+				sector = LinkPrediction.Sector;
+				rendersub = LinkPrediction.Subsector;
+				LinkPrediction.Generation = 0;
+				P_LinkPredictionHits++;
+			}
+			else
+			{
+				sector = P_PointInSector(Pos());
+			}
 		}
 		else
 		{
@@ -472,7 +481,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 	}
 
 	Sector = sector;
-	subsector = R_PointInSubsector(Pos());	// this is from the rendering nodes, not the gameplay nodes!
+	subsector = rendersub != nullptr? rendersub : R_PointInSubsector(Pos());	// this is from the rendering nodes, not the gameplay nodes!
 
 	if (!(flags & MF_NOSECTOR))
 	{
@@ -518,6 +527,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 
 		BlockNode = NULL;
 		FBlockNode **alink = &this->BlockNode;
+		int numblocks = 0;
 		for (int i = -1; i < (int)check.Size(); i++)
 		{
 			DVector3 pos = i==-1? Pos() : PosRelative(check[i] & ~FPortalGroupArray::FLAT);
@@ -540,26 +550,23 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 				{
 					for (int x = x1; x <= x2; ++x)
 					{
-						FBlockNode **link = &level.blockmap.blocklinks[y*level.blockmap.bmapwidth + x];
-						FBlockNode *node = FBlockNode::Create(this, x, y, this->Sector->PortalGroup);
-
-						// Link in to block
-						if ((node->NextActor = *link) != NULL)
-						{
-							(*link)->PrevActor = &node->NextActor;
-						}
-						node->PrevActor = link;
-						*link = node;
+						FBlockNode *node = FBlockNode::Create(x, y);
 
 						// Link in to actor
-						node->PrevBlock = alink;
-						node->NextBlock = NULL;
 						(*alink) = node;
 						alink = &node->NextBlock;
+						numblocks++;
 					}
 				}
 			}
 		}
+
+		// Link in to blocks. This needs to know the final count so that
+		// the iterators can skip the duplicate check for single block actors.
+		for (FBlockNode *node = BlockNode; node != NULL; node = node->NextBlock)
+		{
+			level.blockmap.blocklinks[node->BlockIndex].Add(this, numblocks == 1);
+		}
 	}
 	// Portal links cannot be done unless the level is fully initialized.
 	if (!spawningmapthing) UpdateRenderSectorList();
@@ -602,7 +609,7 @@ DEFINE_ACTION_FUNCTION(AActor, SetOrigin)
 
 FBlockNode *FBlockNode::FreeBlocks = NULL;
 
-FBlockNode *FBlockNode::Create (AActor *who, int x, int y, int group)
+FBlockNode *FBlockNode::Create (int x, int y)
 {
 	FBlockNode *block;
 
@@ -616,10 +623,6 @@ FBlockNode *FBlockNode::Create (AActor *who, int x, int y, int group)
 		block = new FBlockNode;
 	}
 	block->BlockIndex = x + y*level.blockmap.bmapwidth;
-	block->Me = who;
-	block->NextActor = NULL;
-	block->PrevActor = NULL;
-	block->PrevBlock = NULL;
 	block->NextBlock = NULL;
 	return block;
 }
@@ -630,6 +633,37 @@ void FBlockNode::Release ()
 	FreeBlocks = this;
 }
 
+//===========================================================================
+//
+// FBlockmap :: Compact
+//
+// Squeezes the entries of unlinked actors out of the block lists.
+// This may not be done while anything is iterating over the blockmap,
+// so it only gets called at the start of a tic. The order of the
+// remaining entries must be preserved because a lot of the game logic
+// depends on the order the iterators return actors in.
+//
+//===========================================================================
+
+void FBlockmap::Compact()
+{
+	for (int index : dirtyblocks)
+	{
+		FBlockCell &cell = blocklinks[index];
+		unsigned j = 0;
+		for (unsigned i = 0; i < cell.Actors.Size(); i++)
+		{
+			if (cell.Actors[i].Me != nullptr)
+			{
+				cell.Actors[j++] = cell.Actors[i];
+			}
+		}
+		cell.Actors.Resize(j);
+		cell.Removed = 0;
+	}
+	dirtyblocks.Clear();
+}
+
 //
 // BLOCK MAP ITERATORS
 // For each line/thing in the given mapblock,
@@ -1010,7 +1044,8 @@ FBlockThingsIterator::FBlockThingsIterator()
 	minx = maxx = 0;
 	miny = maxy = 0;
 	ClearHash();
-	block = NULL;
+	block = -1;
+	blockpos = -1;
 }
 
 FBlockThingsIterator::FBlockThingsIterator(int _minx, int _miny, int _maxx, int _maxy)
@@ -1059,12 +1094,14 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	cury = y;
 	if (level.blockmap.isValidBlock(x, y))
 	{
-		block = level.blockmap.blocklinks[y*level.blockmap.bmapwidth + x];
+		block = y*level.blockmap.bmapwidth + x;
+		blockpos = (int)level.blockmap.blocklinks[block].Actors.Size() - 1;
 	}
 	else
 	{
 		// invalid block
-		block = NULL;
+		block = -1;
+		blockpos = -1;
 	}
 }
 
@@ -1091,16 +1128,21 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 {
 	for (;;)
 	{
-		while (block != NULL)
+		while (blockpos >= 0)
 		{
-			AActor *me = block->Me;
-			FBlockNode *mynode = block;
+			// Entries added while iterating are past the start position and won't be seen,
+			// just like the old linked lists which added new actors to the front.
+			const FBlockEntry &blockentry = level.blockmap.blocklinks[block].Actors[blockpos--];
+			AActor *me = blockentry.Me;
 			HashEntry *entry;
 			int i;
 
-			block = block->NextActor;
+			if (me == nullptr)
+			{ // Unlinked while iterating.
+				continue;
+			}
 			// Don't recheck things that were already checked
-			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
+			if (blockentry.Single)
 			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
 				return me;
 			}
@@ -1978,23 +2020,24 @@ static AActor *RoughBlockCheck (AActor *mo, int index, void *param)
 {
 	BlockCheckInfo *info = (BlockCheckInfo *)param;
 
-	FBlockNode *link;
+	auto &list = level.blockmap.blocklinks[index].Actors;
 
-	for (link = level.blockmap.blocklinks[index]; link != NULL; link = link->NextActor)
+	for (int i = (int)list.Size() - 1; i >= 0; i--)
 	{
-		if (link->Me != mo)
+		AActor *link = list[i].Me;
+		if (link != nullptr && link != mo)
 		{
-			if (info->onlyseekable && !mo->CanSeek(link->Me))
+			if (info->onlyseekable && !mo->CanSeek(link))
 			{
 				continue;
 			}
-			if (info->frontonly && P_PointOnDivlineSide(link->Me->X(), link->Me->Y(), &info->frontline) != 0)
+			if (info->frontonly && P_PointOnDivlineSide(link->X(), link->Y(), &info->frontline) != 0)
 			{
 				continue;
 			}
-			if (mo->IsOkayToAttack (link->Me))
+			if (mo->IsOkayToAttack (link))
 			{
-				return link->Me;
+				return link;
 			}
 		}
 	}
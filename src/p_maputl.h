@@ -279,7 +279,8 @@ class FBlockThingsIterator
 
 	int curx, cury;
 
-	FBlockNode *block;
+	int block;		// index of the current block, -1 if outside the blockmap
+	int blockpos;	// next entry to check in the current block's list
 
 	int Buckets[32];
 
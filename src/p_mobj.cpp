@@ -105,6 +105,7 @@
 #include "d_player.h"
 #include "vm.h"
 #include "g_levellocals.h"
+#include "p_statehash.h"
 #include "a_morph.h"
 #include "events.h"
 #include "actorinlines.h"
@@ -1498,6 +1499,7 @@ bool P_GiveBody(AActor *actor, int num, int max)
 		return false;
 	}
 
+	actor->TouchStateHash();
 	player_t *player = actor->player;
 
 	num = clamp(num, -65536, 65536);	// prevent overflows for bad values
@@ -5387,6 +5389,7 @@ void AActor::OnDestroy ()
 	//      note: if OnDestroy is ever made optional, E_WorldThingDestroyed should still be called for ANY thing.
 	E_WorldThingDestroyed(this);
 
+	P_StateHashRemove(this);
 	ClearRenderSectorList();
 	ClearRenderLineList();
 
@@ -64,6 +64,7 @@
 #include "serializer.h"
 #include "g_levellocals.h"
 #include "events.h"
+#include "p_statehash.h"
 
 //==========================================================================
 //
@@ -1012,6 +1013,12 @@ void G_SerializeLevel(FSerializer &arc, bool hubload)
 		{
 			P_Recalculate3DFloors(&sec);
 		}
+		// Any line may have moved, so the renderer has to check all of them.
+		for (auto &line : level.lines)
+		{
+			level.LineChanged(&line);
+		}
+		P_ResetStateHash();
 		for (int i = 0; i < MAXPLAYERS; ++i)
 		{
 			if (playeringame[i] && players[i].mo != NULL)
@@ -2439,6 +2439,7 @@ DEFINE_ACTION_FUNCTION(_Secplane, ChangeHeight)
 	PARAM_SELF_STRUCT_PROLOGUE(secplane_t);
 	PARAM_FLOAT(hdiff);
 	self->ChangeHeight(hdiff);
+	P_InvalidateSightCache();
 	return 0;
 }
 
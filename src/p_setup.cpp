@@ -119,6 +119,7 @@
 #include "scripting/vm/vm.h"
 
 #include "fragglescript/t_fs.h"
+#include "p_statehash.h"
 
 #define MISSING_TEXTURE_WARN_LIMIT		20
 
@@ -3130,8 +3131,8 @@ void P_LoadBlockMap (MapData * map)
 
 	// clear out mobj chains
 	count = level.blockmap.bmapwidth*level.blockmap.bmapheight;
-	level.blockmap.blocklinks = new FBlockNode *[count];
-	memset (level.blockmap.blocklinks, 0, count*sizeof(*level.blockmap.blocklinks));
+	level.blockmap.blocklinks = new FBlockCell[count];
+	level.blockmap.dirtyblocks.Clear();
 	level.blockmap.blockmap = level.blockmap.blockmaplump+4;
 }
 
@@ -3551,7 +3552,9 @@ void P_FreeLevelData ()
 	level.segs.Clear();
 	level.sectors.Clear();
 	level.lines.Clear();
+	level.ChangedLines.Clear();
 	level.sides.Clear();
+	P_ResetStateHash();
 	level.loadsectors.Clear();
 	level.loadlines.Clear();
 	level.loadsides.Clear();
@@ -4104,6 +4107,7 @@ void P_SetupLevel (const char *lumpname, int position)
 	if (reloop) P_LoopSidedefs (false);
 	PO_Init ();				// Initialize the polyobjs
 	P_FinalizePortals();	// finalize line portals after polyobjects have been initialized. This info is needed for properly flagging them.
+	P_InitSightGroups();	// needs to know about linked portals
 	times[16].Unclock();
 
 	assert(sidetemp != NULL);
@@ -61,6 +61,100 @@ This uses specialized forms of the maputils routines for optimized performance
 static int sightcounts[6];
 static cycle_t SightCycles;
 static cycle_t MaxSightCycles;
+static int sightcachecounts[3];	// hits, misses, static rejects
+
+CVAR(Bool, sv_sightcache, true, CVAR_SERVERINFO)
+
+//==========================================================================
+//
+// Sight cache
+//
+// Monsters looking for and chasing targets ask the same questions many
+// times per tic, so results are remembered until the next tic or until
+// something happens that can change them: a plane moving, a polyobject
+// moving or line blocking flags being changed. Scripts count too: ACS
+// changes lines through natives that invalidate the cache, and ZScript
+// assignments to Line.flags compile to a call that does. Entries are only
+// used if both actors are exactly where they were when the trace was made.
+//
+// In addition, the sectors of each map are grouped by what is reachable
+// through two-sided lines. Sectors in different groups can never see each
+// other. This is independent of the REJECT lump, which often is missing or
+// empty. Only one-sided lines separate groups, and no line can change sides
+// at run time. Blocking flags, polyobjects and 3D floors can only block sight
+// within a group, so the groups never need to be rebuilt. The group check is
+// done after everything that may consume random numbers and is turned off
+// together with the cache by sv_sightcache.
+//
+//==========================================================================
+
+enum
+{
+	SIGHTCACHE_SIZE = 1024		// must be a power of 2
+};
+
+struct FSightCacheEntry
+{
+	AActor *t1, *t2;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	int flags;
+	int generation;
+	bool result;
+};
+
+static FSightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static int SightCacheGeneration = 1;
+static TArray<int> SightGroups;
+
+void P_InvalidateSightCache()
+{
+	// Generation 0 is reserved for 'never used'.
+	if (++SightCacheGeneration == 0) SightCacheGeneration = 1;
+}
+
+static int FindSightGroup(TArray<int> &groups, int sec)
+{
+	while (groups[sec] != sec)
+	{
+		groups[sec] = groups[groups[sec]];
+		sec = groups[sec];
+	}
+	return sec;
+}
+
+void P_InitSightGroups()
+{
+	P_InvalidateSightCache();
+	SightGroups.Clear();
+
+	// Linked portals let sight pass between unconnected sectors.
+	if (Displacements.size > 1) return;
+
+	SightGroups.Resize(level.sectors.Size());
+	for (unsigned i = 0; i < SightGroups.Size(); i++)
+	{
+		SightGroups[i] = i;
+	}
+	for (auto &line : level.lines)
+	{
+		// Blocking flags can change at run time, so every two-sided line connects.
+		if (line.frontsector != nullptr && line.backsector != nullptr)
+		{
+			int a = FindSightGroup(SightGroups, line.frontsector->Index());
+			int b = FindSightGroup(SightGroups, line.backsector->Index());
+			if (a != b) SightGroups[MAX(a, b)] = MIN(a, b);
+		}
+	}
+	bool split = false;
+	for (unsigned i = 0; i < SightGroups.Size(); i++)
+	{
+		SightGroups[i] = FindSightGroup(SightGroups, i);
+		if (SightGroups[i] != 0) split = true;
+	}
+	// If everything is connected there's nothing to reject.
+	if (!split) SightGroups.Clear();
+}
 
 enum
 {
@@ -842,6 +936,7 @@ bool P_CheckSight (AActor *t1, AActor *t2, int flags)
 	SightCycles.Clock();
 
 	bool res;
+	FSightCacheEntry *cache = nullptr;
 
 	assert (t1 != NULL);
 	assert (t2 != NULL);
@@ -903,6 +998,26 @@ sightcounts[0]++;
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
+	// The checks above need to run every time because they may consume random numbers.
+	if (sv_sightcache)
+	{
+		if (SightGroups.Size() == level.sectors.Size() && SightGroups[s1->Index()] != SightGroups[s2->Index()])
+		{
+			sightcachecounts[2]++;
+			res = false;
+			goto done;
+		}
+		cache = &SightCache[(((size_t)t1 >> 4) ^ ((size_t)t2 >> 3)) & (SIGHTCACHE_SIZE - 1)];
+		if (cache->generation == SightCacheGeneration && cache->t1 == t1 && cache->t2 == t2 && cache->flags == flags &&
+			cache->pos1 == t1->Pos() && cache->pos2 == t2->Pos() && cache->height1 == t1->Height && cache->height2 == t2->Height)
+		{
+			sightcachecounts[0]++;
+			res = cache->result;
+			goto done;
+		}
+		sightcachecounts[1]++;
+	}
+
 	validcount++;
 	portals.Clear();
 	{
@@ -934,6 +1049,11 @@ sightcounts[0]++;
 		}
 	}
 
+	if (cache != nullptr)
+	{
+		*cache = { t1, t2, t1->Pos(), t2->Pos(), t1->Height, t2->Height, flags, SightCacheGeneration, res };
+	}
+
 done:
 	SightCycles.Unclock();
 	return res;
@@ -950,9 +1070,10 @@ DEFINE_ACTION_FUNCTION(AActor, CheckSight)
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, cache %d hits %d misses %d rejects\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5],
+		sightcachecounts[0], sightcachecounts[1], sightcachecounts[2]);
 	return out;
 }
 
@@ -968,4 +1089,7 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	memset (sightcachecounts, 0, sizeof(sightcachecounts));
+	// This gets called once per tic, so this is where cached results expire.
+	P_InvalidateSightCache();
 }
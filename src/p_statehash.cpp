@@ -0,0 +1,308 @@
+//
+//---------------------------------------------------------------------------
+//
+// Copyright(C) 2018 GZDoom maintainers
+// All rights reserved.
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//--------------------------------------------------------------------------
+//
+/*
+** p_statehash.cpp
+** Checksums of the playsim state for demo and netgame sync checks
+**
+**/
+
+#include "p_statehash.h"
+#include "actor.h"
+#include "m_random.h"
+#include "m_crc32.h"
+#include "g_levellocals.h"
+#include "c_dispatch.h"
+#include "a_dynlight.h"
+
+int P_StateHashStamp = 1;
+
+static TArray<AActor *> DirtyActors;
+static TArray<int> DirtySectors;
+static TArray<uint32_t> SectorHashes;
+static TArray<int> SectorStamps;
+static uint32_t ActorSum, SectorSum;
+static uint32_t CurrentHash;
+static bool NeedsRehash = true;
+
+//==========================================================================
+//
+// Only values are hashed, never pointers, so the result is the same for
+// every machine and every run that plays the same tics.
+//
+// The per-actor and per-sector hashes are summed up so that any of them
+// can be replaced without touching the rest.
+//
+// Positions are only changed through the AActor setters, which touch the
+// actor. Velocity and health are also written directly, from ZScript and
+// ACS among others, so P_UpdateStateHash compares them against what was
+// last hashed. Tics and angles are left out.
+//
+//==========================================================================
+
+struct FActorHashState
+{
+	double X, Y, Z;
+	double VelX, VelY, VelZ;
+	int32_t Health;
+};
+
+// Dynamic lights are spawned by the renderer depending on the client's
+// settings and are not part of the playsim.
+static bool IsHashed (AActor *ac)
+{
+	return !(ac->ObjectFlags & OF_Transient) && !ac->IsKindOf(RUNTIME_CLASS(ADynamicLight));
+}
+
+static uint32_t HashActor (AActor *ac)
+{
+	FActorHashState state;
+	memset(&state, 0, sizeof(state));	// no uninitialized padding in the CRC
+	state.X = ac->X();
+	state.Y = ac->Y();
+	state.Z = ac->Z();
+	state.VelX = ac->Vel.X;
+	state.VelY = ac->Vel.Y;
+	state.VelZ = ac->Vel.Z;
+	state.Health = ac->health;
+	// Never 0, so that an actor always changes the sum.
+	return CalcCRC32((const uint8_t *)&state, sizeof(state)) | 1;
+}
+
+// Updates the actor's part of the sum and returns the change.
+static uint32_t RehashActor (AActor *ac)
+{
+	uint32_t hash = IsHashed(ac) ? HashActor(ac) : 0;
+	uint32_t change = hash - ac->StateHash;
+	ac->StateHash = hash;
+	ac->StateHashHealth = ac->health;
+	ac->StateHashMoving = !ac->Vel.isZero();
+	return change;
+}
+
+static uint32_t HashSector (sector_t *sec)
+{
+	double heights[3] = { (double)sec->Index(), sec->floorplane.fD(), sec->ceilingplane.fD() };
+	return CalcCRC32((const uint8_t *)heights, sizeof(heights));
+}
+
+static uint32_t CombineHashes (uint32_t actorsum, uint32_t sectorsum)
+{
+	uint32_t sums[2] = { actorsum, sectorsum };
+	return FRandom::StaticHashState(CalcCRC32((const uint8_t *)sums, sizeof(sums)));
+}
+
+//==========================================================================
+//
+// P_StateHashTouch
+//
+// Queues an actor to be rehashed at the end of the tic. Called through
+// AActor::TouchStateHash when something that is hashed may have changed.
+//
+//==========================================================================
+
+void P_StateHashTouch (AActor *actor)
+{
+	if (!IsHashed(actor)) return;
+	actor->StateHashStamp = P_StateHashStamp;
+	actor->StateHashIndex = DirtyActors.Push(actor);
+}
+
+//==========================================================================
+//
+// P_StateHashRemove
+//
+// Takes a destroyed actor out of the sum and out of the queue.
+//
+//==========================================================================
+
+void P_StateHashRemove (AActor *actor)
+{
+	ActorSum -= actor->StateHash;
+	actor->StateHash = 0;
+	if (actor->StateHashStamp == P_StateHashStamp)
+	{
+		DirtyActors[actor->StateHashIndex] = nullptr;
+		actor->StateHashStamp = 0;
+	}
+}
+
+//==========================================================================
+//
+// P_StateHashSector
+//
+//==========================================================================
+
+void P_StateHashSector (sector_t *sector)
+{
+	int index = sector->Index();
+	if (index < (int)SectorStamps.Size() && SectorStamps[index] != P_StateHashStamp)
+	{
+		SectorStamps[index] = P_StateHashStamp;
+		DirtySectors.Push(index);
+	}
+}
+
+//==========================================================================
+//
+// P_ResetStateHash
+//
+// Everything gets rehashed on the next update, for new levels and
+// loaded savegames.
+//
+//==========================================================================
+
+void P_ResetStateHash ()
+{
+	NeedsRehash = true;
+}
+
+//==========================================================================
+//
+// P_UpdateStateHash
+//
+// Rehashes everything touched since the last call. Runs once per tic.
+//
+// Actors whose velocity or health may have changed without a touch are
+// picked up first. An actor that is moving is always rehashed, as is one
+// that was moving the last time, so that stopping is seen too.
+//
+//==========================================================================
+
+void P_UpdateStateHash ()
+{
+	if (NeedsRehash)
+	{
+		NeedsRehash = false;
+		ActorSum = 0;
+		TThinkerIterator<AActor> it;
+		AActor *ac;
+		while ((ac = it.Next()))
+		{
+			ac->StateHash = 0;
+			ActorSum += RehashActor(ac);
+		}
+
+		SectorSum = 0;
+		SectorHashes.Resize(level.sectors.Size());
+		SectorStamps.Resize(level.sectors.Size());
+		for (auto &sec : level.sectors)
+		{
+			SectorHashes[sec.Index()] = HashSector(&sec);
+			SectorStamps[sec.Index()] = 0;
+			SectorSum += SectorHashes[sec.Index()];
+		}
+	}
+	else
+	{
+		TThinkerIterator<AActor> it;
+		AActor *ac;
+		while ((ac = it.Next()))
+		{
+			if (ac->StateHashMoving || ac->health != ac->StateHashHealth || !ac->Vel.isZero())
+			{
+				ac->TouchStateHash();
+			}
+		}
+		for (auto ac : DirtyActors)
+		{
+			// OF_Transient may have been set after the actor was queued.
+			if (ac != nullptr)
+			{
+				ActorSum += RehashActor(ac);
+			}
+		}
+		for (auto index : DirtySectors)
+		{
+			uint32_t hash = HashSector(&level.sectors[index]);
+			SectorSum += hash - SectorHashes[index];
+			SectorHashes[index] = hash;
+		}
+	}
+	DirtyActors.Clear();
+	DirtySectors.Clear();
+
+	// A new stamp invalidates all queue entries at once.
+	if (++P_StateHashStamp == 0) P_StateHashStamp = 1;
+
+	CurrentHash = CombineHashes(ActorSum, SectorSum);
+}
+
+//==========================================================================
+//
+// P_GetStateHash
+//
+// The hash as of the end of the last tic.
+//
+//==========================================================================
+
+uint32_t P_GetStateHash ()
+{
+	if (NeedsRehash)
+	{
+		P_UpdateStateHash();
+	}
+	return CurrentHash;
+}
+
+//==========================================================================
+//
+// P_HashLevelState
+//
+// Computes the hash from scratch, ignoring what was cached.
+//
+//==========================================================================
+
+uint32_t P_HashLevelState ()
+{
+	uint32_t actorsum = 0;
+	TThinkerIterator<AActor> it;
+	AActor *ac;
+	while ((ac = it.Next()))
+	{
+		if (IsHashed(ac)) actorsum += HashActor(ac);
+	}
+
+	uint32_t sectorsum = 0;
+	for (auto &sec : level.sectors)
+	{
+		sectorsum += HashSector(&sec);
+	}
+
+	return CombineHashes(actorsum, sectorsum);
+}
+
+//==========================================================================
+//
+// CCMD checkstatehash
+//
+// Verifies the incremental hash. A mismatch means that something changed
+// hashed state without calling AActor::TouchStateHash.
+//
+//==========================================================================
+
+CCMD (checkstatehash)
+{
+	P_UpdateStateHash();
+	uint32_t incremental = P_GetStateHash();
+	uint32_t full = P_HashLevelState();
+	Printf ("State hash: %08x, full rehash: %08x%s\n", incremental, full, incremental == full ? "" : " - MISMATCH");
+}
@@ -0,0 +1,25 @@
+#ifndef __P_STATEHASH_H
+#define __P_STATEHASH_H
+
+#include <stdint.h>
+
+class AActor;
+struct sector_t;
+
+// Checksum of the playsim state that matters for sync: actor positions,
+// velocities and health, sector heights and the RNG positions.
+//
+// P_GetStateHash is kept up to date incrementally: only actors and sectors
+// that were touched since the last tic get rehashed. P_HashLevelState
+// computes the same value from scratch.
+uint32_t P_GetStateHash ();
+uint32_t P_HashLevelState ();
+
+void P_UpdateStateHash ();
+void P_ResetStateHash ();
+
+void P_StateHashTouch (AActor *actor);
+void P_StateHashRemove (AActor *actor);
+void P_StateHashSector (sector_t *sector);
+
+#endif
@@ -41,9 +41,117 @@
 #include "g_levellocals.h"
 #include "events.h"
 #include "actorinlines.h"
+#include "stats.h"
+#include "parallel_for.h"
+#include "p_statehash.h"
 
 extern gamestate_t wipegamestate;
 
+CVAR(Bool, threadedthinkers, false, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+int P_LinkPredictionGeneration;
+int P_LinkPredictionHits;
+static int LinkPredictionCount;
+static TArray<AActor *> MovingActors;
+static TArray<AActor *> SortedActors;
+static TArray<unsigned> CellCounts;
+static TArray<unsigned> Partitions;
+
+enum
+{
+	MIN_PREDICT_ACTORS = 256,		// below this the thread overhead isn't worth it
+	PARTITION_SIZE = 64,			// minimum number of actors handed to a worker at once
+};
+
+//==========================================================================
+//
+// P_PredictActorLinks
+//
+// Linking an actor into the world needs two BSP descents, one through the
+// game nodes for its sector and one through the render nodes for its
+// subsector. For maps with thousands of moving actors that is a sizable
+// part of the tic, and unlike the rest of AActor::Tick it is read-only, so
+// it can be done up front on worker threads.
+//
+// Moving actors are binned by the blockmap cell they are in and handed to
+// the workers as partitions of whole cells, so each worker stays in its own
+// region of the map. Each worker only writes to the LinkPrediction of its own
+// actors; the actual linking still happens in the normal, serial thinker
+// pass, which only uses a prediction if the actor ended up exactly where it
+// was expected. The result is identical to a serial run, so demos and net
+// games are unaffected by this setting.
+//
+// AActor::Tick itself stays serial. Nearly everything it does has effects
+// that the order of execution decides: every random number comes from
+// shared FRandom streams, action functions run on the single VM stack and
+// can spawn, destroy and damage anything on the map, and the thinker lists,
+// sound and ACS are all global. Committing that in a deterministic serial
+// phase would mean recording every side effect of every action function, so
+// only the read-only part of the tic is done in parallel.
+//
+//==========================================================================
+
+static void P_PredictActorLinks()
+{
+	auto &bmap = level.blockmap;
+	const unsigned outside = bmap.bmapwidth * bmap.bmapheight;	// catches everything outside the blockmap
+	const int generation = P_LinkPredictionGeneration;
+
+	// Counting sort by blockmap cell.
+	CellCounts.Resize(outside + 2);
+	memset(&CellCounts[0], 0, CellCounts.Size() * sizeof(unsigned));
+	for (auto ac : MovingActors)
+	{
+		int bx = bmap.GetBlockX(ac->X());
+		int by = bmap.GetBlockY(ac->Y());
+		CellCounts[(bmap.isValidBlock(bx, by) ? by * bmap.bmapwidth + bx : outside) + 1]++;
+	}
+	for (unsigned i = 1; i < CellCounts.Size(); i++)
+	{
+		CellCounts[i] += CellCounts[i - 1];
+	}
+
+	// Cut partitions at cell boundaries only.
+	Partitions.Clear();
+	Partitions.Push(0);
+	for (unsigned i = 1; i <= outside + 1; i++)
+	{
+		if (CellCounts[i] - Partitions.Last() >= PARTITION_SIZE || i == outside + 1)
+		{
+			if (CellCounts[i] > Partitions.Last()) Partitions.Push(CellCounts[i]);
+		}
+	}
+
+	SortedActors.Resize(MovingActors.Size());
+	for (auto ac : MovingActors)
+	{
+		int bx = bmap.GetBlockX(ac->X());
+		int by = bmap.GetBlockY(ac->Y());
+		SortedActors[CellCounts[bmap.isValidBlock(bx, by) ? by * bmap.bmapwidth + bx : outside]++] = ac;
+	}
+
+	parallel_for(int(Partitions.Size() - 1), [=](int part)
+	{
+		for (unsigned i = Partitions[part]; i < Partitions[part + 1]; i++)
+		{
+			AActor *ac = SortedActors[i];
+			auto &pred = ac->LinkPrediction;
+			pred.Pos = ac->Pos().XY() + ac->Vel.XY();
+			pred.Sector = P_PointInSector(pred.Pos);
+			pred.Subsector = R_PointInSubsector(pred.Pos);
+			pred.Generation = generation;
+		}
+	});
+	LinkPredictionCount = MovingActors.Size();
+}
+
+ADD_STAT(linkpredict)
+{
+	FString out;
+	out.Format("Link predictions = %d, used = %d", LinkPredictionCount, P_LinkPredictionHits);
+	return out;
+}
+
 //==========================================================================
 //
 // P_CheckTickerPaused
@@ -89,6 +197,10 @@ void P_Ticker (void)
 //		GSnd->SetSfxPaused(!!playerswiping, 2);
 	}
 
+	// Nothing is iterating over the blockmap right now, so this is the
+	// time to get rid of the empty entries unlinked actors left behind.
+	level.blockmap.Compact();
+
 	// run the tic
 	if (paused || P_CheckTickerPaused())
 		return;
@@ -123,10 +235,25 @@ void P_Ticker (void)
 	// Reset all actor interpolations for all actors before the current thinking turn so that indirect actor movement gets properly interpolated.
 	TThinkerIterator<AActor> it;
 	AActor *ac;
+	bool predict = threadedthinkers && !bglobal.freeze && !(level.flags2 & LEVEL2_FROZEN);
+
+	// Generation 0 is reserved for 'no prediction'.
+	if (++P_LinkPredictionGeneration == 0) P_LinkPredictionGeneration = 1;
+	P_LinkPredictionHits = 0;
+	LinkPredictionCount = 0;
+	MovingActors.Clear();
 
 	while ((ac = it.Next()))
 	{
 		ac->ClearInterpolation();
+		if (predict && !ac->Vel.XY().isZero())
+		{
+			MovingActors.Push(ac);
+		}
+	}
+	if (MovingActors.Size() >= MIN_PREDICT_ACTORS)
+	{
+		P_PredictActorLinks();
 	}
 
 	// Since things will be moving, it's okay to interpolate them in the renderer.
@@ -156,4 +283,6 @@ void P_Ticker (void)
 	level.time++;
 	level.maptime++;
 	level.totaltime++;
+
+	P_UpdateStateHash();
 }
@@ -7,5 +7,9 @@
 void P_Ticker (void);
 bool P_CheckTickerPaused ();
 
+// Parallel link position pre-pass (see P_PredictActorLinks)
+extern int P_LinkPredictionGeneration;
+extern int P_LinkPredictionHits;
+
 
 #endif
@@ -141,6 +141,7 @@ static int PredictionLerptics;
 static player_t PredictionPlayerBackup;
 static uint8_t PredictionActorBackup[sizeof(APlayerPawn)];
 static TArray<AActor *> PredictionSectorListBackup;
+static TArray<int> PredictionBlockPosBackup;
 
 static TArray<sector_t *> PredictionTouchingSectorsBackup;
 static TArray<msecnode_t *> PredictionTouchingSectors_sprev_Backup;
@@ -2490,15 +2491,14 @@ void P_PredictPlayer (player_t *player)
 
 	// Blockmap ordering also needs to stay the same, so unlink the block nodes
 	// without releasing them. (They will be used again in P_UnpredictPlayer).
+	// The blocks won't get compacted before that, so the empty slots left
+	// behind in them can be refilled with the same actor afterward.
 	FBlockNode *block = act->BlockNode;
 
+	PredictionBlockPosBackup.Clear();
 	while (block != NULL)
 	{
-		if (block->NextActor != NULL)
-		{
-			block->NextActor->PrevActor = block->PrevActor;
-		}
-		*(block->PrevActor) = block->NextActor;
+		PredictionBlockPosBackup.Push(level.blockmap.Unlink(block->BlockIndex, act));
 		block = block->NextBlock;
 	}
 	act->BlockNode = NULL;
@@ -2590,7 +2590,12 @@ void P_UnPredictPlayer ()
 		act->touching_lineportallist = nullptr;
 
 		act->UnlinkFromWorld(&ctx);
+		// Predicting may have queued the actor for the state hash, which has to stay valid.
+		int hashstamp = act->StateHashStamp;
+		int hashindex = act->StateHashIndex;
 		memcpy(&act->snext, PredictionActorBackup, sizeof(APlayerPawn) - ((uint8_t *)&act->snext - (uint8_t *)act));
+		act->StateHashStamp = hashstamp;
+		act->StateHashIndex = hashindex;
 
 		// The blockmap ordering needs to remain unchanged, too.
 		// Restore sector links and refrences.
@@ -2623,17 +2628,16 @@ void P_UnPredictPlayer ()
 			act->touching_lineportallist = RestoreNodeList(act, lineportal_list, &FLinePortal::lineportal_thinglist, PredictionPortalLines_sprev_Backup, PredictionPortalLinesBackup);
 		}
 
-		// Now fix the pointers in the blocknode chain
+		// Now put the actor back into its old slots in the blocks
 		FBlockNode *block = act->BlockNode;
 
-		while (block != NULL)
+		for (i = 0; block != NULL; block = block->NextBlock, i++)
 		{
-			*(block->PrevActor) = block;
-			if (block->NextActor != NULL)
+			int pos = PredictionBlockPosBackup[i];
+			if (pos >= 0)
 			{
-				block->NextActor->PrevActor = &block->NextActor;
+				level.blockmap.blocklinks[block->BlockIndex].Restore(pos, act);
 			}
-			block = block->NextBlock;
 		}
 
 		act->InvSel = InvSel;
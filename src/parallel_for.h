@@ -44,9 +44,10 @@ inline void parallel_for(const Index first, const Index last, const Index step,
 {
 	const dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
 
-	dispatch_apply((last - first) / step + 1, queue, ^(size_t slice)
+	// Round up so that a partial last slice is included, but never run past last.
+	dispatch_apply((last - first + step - 1) / step, queue, ^(size_t slice)
 	{
-		function(slice * step);
+		function(first + Index(slice) * step);
 	});
 }
 
@@ -967,6 +967,7 @@ bool FPolyObj::MovePolyobj (const DVector2 &pos, bool force)
 	CenterSpot.pos += pos;
 	LinkPolyobj ();
 	ClearSubsectorLinks();
+	for (auto line : Linedefs) level.LineChanged(line);
 	RecalcActorFloorCeil(Bounds | oldbounds);
 	return true;
 }
@@ -1061,6 +1062,7 @@ bool FPolyObj::RotatePolyobj (DAngle angle, bool fromsave)
 	Angle += angle;
 	LinkPolyobj();
 	ClearSubsectorLinks();
+	for (auto line : Linedefs) level.LineChanged(line);
 	RecalcActorFloorCeil(Bounds | oldbounds);
 	return true;
 }
@@ -1109,7 +1111,6 @@ void FPolyObj::UnLinkPolyobj ()
 bool FPolyObj::CheckMobjBlocking (side_t *sd)
 {
 	static TArray<AActor *> checker;
-	FBlockNode *block;
 	AActor *mobj;
 	int i, j, k;
 	int left, right, top, bottom;
@@ -1142,9 +1143,14 @@ bool FPolyObj::CheckMobjBlocking (side_t *sd)
 	{
 		for (i = left; i <= right; i++)
 		{
-			for (block = level.blockmap.blocklinks[j+i]; block != NULL; block = block->NextActor)
+			auto &list = level.blockmap.blocklinks[j+i].Actors;
+			for (int b = (int)list.Size() - 1; b >= 0; b--)
 			{
-				mobj = block->Me;
+				mobj = list[b].Me;
+				if (mobj == nullptr)
+				{
+					continue;
+				}
 				for (k = (int)checker.Size()-1; k >= 0; --k)
 				{
 					if (checker[k] == mobj)
@@ -1246,6 +1252,9 @@ void FPolyObj::LinkPolyobj ()
 	int bmapwidth = level.blockmap.bmapwidth;
 	int bmapheight = level.blockmap.bmapheight;
 
+	// The polyobject's lines may now block or unblock sight differently.
+	P_InvalidateSightCache();
+
 	// calculate the polyobj bbox
 	Bounds.ClearBox();
 	for(unsigned i = 0; i < Sidedefs.Size(); i++)
@@ -901,8 +901,7 @@ private:
 		uint32_t posV = startV;
 		for (int y = y0; y < y1; y++, posV += stepV)
 		{
-			int coreBlock = y / 8;
-			if (coreBlock % thread->num_cores != thread->core)
+			if (thread->line_skipped_by_thread(y))
 			{
 				continue;
 			}
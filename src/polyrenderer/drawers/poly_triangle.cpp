@@ -39,6 +39,8 @@
 #include "screen_triangle.h"
 #include "x86.h"
 
+EXTERN_CVAR(Bool, r_polyrenderer)
+
 int PolyTriangleDrawer::viewport_x;
 int PolyTriangleDrawer::viewport_y;
 int PolyTriangleDrawer::viewport_width;
@@ -46,6 +48,7 @@ int PolyTriangleDrawer::viewport_height;
 int PolyTriangleDrawer::dest_pitch;
 int PolyTriangleDrawer::dest_width;
 int PolyTriangleDrawer::dest_height;
+int PolyTriangleDrawer::dest_y;
 uint8_t *PolyTriangleDrawer::dest;
 bool PolyTriangleDrawer::dest_bgra;
 bool PolyTriangleDrawer::mirror;
@@ -68,6 +71,7 @@ void PolyTriangleDrawer::set_viewport(int x, int y, int width, int height, DCanv
 	viewport_height = height;
 
 	dest += (offsetx + offsety * dest_pitch) * pixelsize;
+	dest_y = offsety;
 	dest_width = clamp(viewport_x + viewport_width, 0, dest_width - offsetx);
 	dest_height = clamp(viewport_y + viewport_height, 0, dest_height - offsety);
 
@@ -84,22 +88,13 @@ bool PolyTriangleDrawer::is_mirror()
 	return mirror;
 }
 
-void PolyTriangleDrawer::draw_elements(const PolyDrawArgs &drawargs, WorkerThreadData *thread)
+void PolyTriangleDrawer::setup_elements(const PolyDrawArgs &drawargs, std::vector<PolyScreenTriangle> &triangles)
 {
 	if (drawargs.VertexCount() < 3)
 		return;
 
 	TriDrawTriangleArgs args;
-	args.dest = dest;
-	args.pitch = dest_pitch;
-	args.clipright = dest_width;
-	args.clipbottom = dest_height;
 	args.uniforms = &drawargs;
-	args.destBgra = dest_bgra;
-	args.stencilPitch = PolyStencilBuffer::Instance()->BlockWidth();
-	args.stencilValues = PolyStencilBuffer::Instance()->Values();
-	args.stencilMasks = PolyStencilBuffer::Instance()->Masks();
-	args.zbuffer = PolyZBuffer::Instance()->Values();
 
 	bool ccw = drawargs.FaceCullCCW();
 	const TriVertex *vinput = drawargs.Vertices();
@@ -113,7 +108,7 @@ void PolyTriangleDrawer::draw_elements(const PolyDrawArgs &drawargs, WorkerThrea
 		{
 			for (int j = 0; j < 3; j++)
 				vert[j] = shade_vertex(drawargs, vinput[*(elements++)]);
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 		}
 	}
 	else if (drawargs.DrawMode() == PolyDrawMode::TriangleFan)
@@ -123,7 +118,7 @@ void PolyTriangleDrawer::draw_elements(const PolyDrawArgs &drawargs, WorkerThrea
 		for (int i = 2; i < vcount; i++)
 		{
 			vert[2] = shade_vertex(drawargs, vinput[*(elements++)]);
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 			vert[1] = vert[2];
 		}
 	}
@@ -134,7 +129,7 @@ void PolyTriangleDrawer::draw_elements(const PolyDrawArgs &drawargs, WorkerThrea
 		for (int i = 2; i < vcount; i++)
 		{
 			vert[2] = shade_vertex(drawargs, vinput[*(elements++)]);
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 			vert[0] = vert[1];
 			vert[1] = vert[2];
 			ccw = !ccw;
@@ -142,22 +137,13 @@ void PolyTriangleDrawer::draw_elements(const PolyDrawArgs &drawargs, WorkerThrea
 	}
 }
 
-void PolyTriangleDrawer::draw_arrays(const PolyDrawArgs &drawargs, WorkerThreadData *thread)
+void PolyTriangleDrawer::setup_arrays(const PolyDrawArgs &drawargs, std::vector<PolyScreenTriangle> &triangles)
 {
 	if (drawargs.VertexCount() < 3)
 		return;
 
 	TriDrawTriangleArgs args;
-	args.dest = dest;
-	args.pitch = dest_pitch;
-	args.clipright = dest_width;
-	args.clipbottom = dest_height;
 	args.uniforms = &drawargs;
-	args.destBgra = dest_bgra;
-	args.stencilPitch = PolyStencilBuffer::Instance()->BlockWidth();
-	args.stencilValues = PolyStencilBuffer::Instance()->Values();
-	args.stencilMasks = PolyStencilBuffer::Instance()->Masks();
-	args.zbuffer = PolyZBuffer::Instance()->Values();
 
 	bool ccw = drawargs.FaceCullCCW();
 	const TriVertex *vinput = drawargs.Vertices();
@@ -170,7 +156,7 @@ void PolyTriangleDrawer::draw_arrays(const PolyDrawArgs &drawargs, WorkerThreadD
 		{
 			for (int j = 0; j < 3; j++)
 				vert[j] = shade_vertex(drawargs, *(vinput++));
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 		}
 	}
 	else if (drawargs.DrawMode() == PolyDrawMode::TriangleFan)
@@ -180,7 +166,7 @@ void PolyTriangleDrawer::draw_arrays(const PolyDrawArgs &drawargs, WorkerThreadD
 		for (int i = 2; i < vcount; i++)
 		{
 			vert[2] = shade_vertex(drawargs, *(vinput++));
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 			vert[1] = vert[2];
 		}
 	}
@@ -191,7 +177,7 @@ void PolyTriangleDrawer::draw_arrays(const PolyDrawArgs &drawargs, WorkerThreadD
 		for (int i = 2; i < vcount; i++)
 		{
 			vert[2] = shade_vertex(drawargs, *(vinput++));
-			draw_shaded_triangle(vert, ccw, &args, thread);
+			setup_shaded_triangle(vert, ccw, &args, triangles);
 			vert[0] = vert[1];
 			vert[1] = vert[2];
 			ccw = !ccw;
@@ -252,7 +238,7 @@ bool PolyTriangleDrawer::is_frontfacing(TriDrawTriangleArgs *args)
 	return a <= 0.0f;
 }
 
-void PolyTriangleDrawer::draw_shaded_triangle(const ShadedTriVertex *vert, bool ccw, TriDrawTriangleArgs *args, WorkerThreadData *thread)
+void PolyTriangleDrawer::setup_shaded_triangle(const ShadedTriVertex *vert, bool ccw, TriDrawTriangleArgs *args, std::vector<PolyScreenTriangle> &triangles)
 {
 	// Reject triangle if degenerate
 	if (is_degenerate(vert))
@@ -325,7 +311,7 @@ void PolyTriangleDrawer::draw_shaded_triangle(const ShadedTriVertex *vert, bool
 		}
 	}
 
-	// Draw screen triangles
+	// Store screen triangles
 	if (ccw)
 	{
 		for (int i = numclipvert - 1; i > 1; i--)
@@ -334,7 +320,7 @@ void PolyTriangleDrawer::draw_shaded_triangle(const ShadedTriVertex *vert, bool
 			args->v2 = &clippedvert[i - 1];
 			args->v3 = &clippedvert[i - 2];
 			if (is_frontfacing(args) == ccw && args->CalculateGradients())
-				ScreenTriangle::Draw(args, thread);
+				store_screen_triangle(args, triangles);
 		}
 	}
 	else
@@ -345,11 +331,28 @@ void PolyTriangleDrawer::draw_shaded_triangle(const ShadedTriVertex *vert, bool
 			args->v2 = &clippedvert[i - 1];
 			args->v3 = &clippedvert[i];
 			if (is_frontfacing(args) != ccw && args->CalculateGradients())
-				ScreenTriangle::Draw(args, thread);
+				store_screen_triangle(args, triangles);
 		}
 	}
 }
 
+void PolyTriangleDrawer::store_screen_triangle(const TriDrawTriangleArgs *args, std::vector<PolyScreenTriangle> &triangles)
+{
+	float miny = MIN(MIN(args->v1->y, args->v2->y), args->v3->y);
+	float maxy = MAX(MAX(args->v1->y, args->v2->y), args->v3->y);
+
+	PolyScreenTriangle tri;
+	tri.vertices[0] = *args->v1;
+	tri.vertices[1] = *args->v2;
+	tri.vertices[2] = *args->v3;
+	tri.gradientX = args->gradientX;
+	tri.gradientY = args->gradientY;
+	tri.miny = MAX((int)floorf(miny), 0);
+	tri.maxy = MIN((int)ceilf(maxy), dest_height - 1);
+	if (tri.miny <= tri.maxy)
+		triangles.push_back(tri);
+}
+
 int PolyTriangleDrawer::clipedge(const ShadedTriVertex *verts, ShadedTriVertex *clippedvert)
 {
 	// Clip and cull so that the following is true for all vertices:
@@ -531,27 +534,89 @@ DrawPolyTrianglesCommand::DrawPolyTrianglesCommand(const PolyDrawArgs &args, boo
 {
 	if (mirror)
 		this->args.SetFaceCullCCW(!this->args.FaceCullCCW());
+
+	drawargs.dest = PolyTriangleDrawer::dest;
+	drawargs.pitch = PolyTriangleDrawer::dest_pitch;
+	drawargs.clipright = PolyTriangleDrawer::dest_width;
+	drawargs.clipbottom = PolyTriangleDrawer::dest_height;
+	drawargs.uniforms = &this->args;
+	drawargs.destBgra = PolyTriangleDrawer::dest_bgra;
+	dest_y = PolyTriangleDrawer::dest_y;
+
+	// The poly rasterizer hands out lines to threads in blocks of 8, the software renderer one line at a time
+	lineblocks = r_polyrenderer;
+
+	if (!this->args.Elements())
+		PolyTriangleDrawer::setup_arrays(this->args, triangles);
+	else
+		PolyTriangleDrawer::setup_elements(this->args, triangles);
+
+	miny = drawargs.clipbottom;
+	maxy = -1;
+	for (const auto &tri : triangles)
+	{
+		miny = MIN(miny, tri.miny);
+		maxy = MAX(maxy, tri.maxy);
+	}
+}
+
+bool DrawPolyTrianglesCommand::LineRange(int &first_line, int &count)
+{
+	first_line = dest_y + miny;
+	count = MAX(maxy - miny + 1, 0);
+	return true;
 }
 
 void DrawPolyTrianglesCommand::Execute(DrawerThread *thread)
 {
+	if (triangles.empty())
+		return;
+
+	// Lines of the pass relative to the viewport
 	WorkerThreadData thread_data;
 	thread_data.core = thread->core;
 	thread_data.num_cores = thread->num_cores;
+	thread_data.pass_start_y = thread->pass_start_y - dest_y;
+	thread_data.pass_end_y = thread->pass_end_y - dest_y;
 
-	if (!args.Elements())
-		PolyTriangleDrawer::draw_arrays(args, &thread_data);
-	else
-		PolyTriangleDrawer::draw_elements(args, &thread_data);
+	TriDrawTriangleArgs args = drawargs;
+	args.stencilPitch = PolyStencilBuffer::Instance()->BlockWidth();
+	args.stencilValues = PolyStencilBuffer::Instance()->Values();
+	args.stencilMasks = PolyStencilBuffer::Instance()->Masks();
+	args.zbuffer = PolyZBuffer::Instance()->Values();
+
+	for (auto &tri : triangles)
+	{
+		if (thread_data.lines_skipped_by_thread(tri.miny, tri.maxy, lineblocks))
+			continue;
+
+		args.v1 = &tri.vertices[0];
+		args.v2 = &tri.vertices[1];
+		args.v3 = &tri.vertices[2];
+		args.gradientX = tri.gradientX;
+		args.gradientY = tri.gradientY;
+		ScreenTriangle::Draw(&args, &thread_data);
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
+bool DrawRectCommand::LineRange(int &first_line, int &count)
+{
+	int y0 = (int)(args.Y0() + 0.5f);
+	int y1 = (int)(args.Y1() + 0.5f);
+	first_line = y0;
+	count = MAX(y1 - y0, 0);
+	return true;
+}
+
 void DrawRectCommand::Execute(DrawerThread *thread)
 {
 	WorkerThreadData thread_data;
 	thread_data.core = thread->core;
 	thread_data.num_cores = thread->num_cores;
+	thread_data.pass_start_y = thread->pass_start_y;
+	thread_data.pass_end_y = thread->pass_end_y;
 
 	auto renderTarget = PolyRenderer::Instance()->RenderTarget;
 	const void *destOrg = renderTarget->GetBuffer();
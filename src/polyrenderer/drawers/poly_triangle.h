@@ -31,6 +31,15 @@
 
 typedef void(*PolyDrawFuncPtr)(const TriDrawTriangleArgs *, WorkerThreadData *);
 
+// Clipped triangle in screen coordinates with its gradients, ready to be rasterized
+struct PolyScreenTriangle
+{
+	ShadedTriVertex vertices[3];
+	ScreenTriangleStepVariables gradientX;
+	ScreenTriangleStepVariables gradientY;
+	int miny, maxy;
+};
+
 class PolyTriangleDrawer
 {
 public:
@@ -40,15 +49,16 @@ public:
 
 private:
 	static ShadedTriVertex shade_vertex(const PolyDrawArgs &drawargs, const TriVertex &v);
-	static void draw_elements(const PolyDrawArgs &args, WorkerThreadData *thread);
-	static void draw_arrays(const PolyDrawArgs &args, WorkerThreadData *thread);
-	static void draw_shaded_triangle(const ShadedTriVertex *vertices, bool ccw, TriDrawTriangleArgs *args, WorkerThreadData *thread);
+	static void setup_elements(const PolyDrawArgs &args, std::vector<PolyScreenTriangle> &triangles);
+	static void setup_arrays(const PolyDrawArgs &args, std::vector<PolyScreenTriangle> &triangles);
+	static void setup_shaded_triangle(const ShadedTriVertex *vertices, bool ccw, TriDrawTriangleArgs *args, std::vector<PolyScreenTriangle> &triangles);
+	static void store_screen_triangle(const TriDrawTriangleArgs *args, std::vector<PolyScreenTriangle> &triangles);
 	static bool is_degenerate(const ShadedTriVertex *vertices);
 	static bool is_frontfacing(TriDrawTriangleArgs *args);
 
 	static int clipedge(const ShadedTriVertex *verts, ShadedTriVertex *clippedvert);
 
-	static int viewport_x, viewport_y, viewport_width, viewport_height, dest_pitch, dest_width, dest_height;
+	static int viewport_x, viewport_y, viewport_width, viewport_height, dest_pitch, dest_width, dest_height, dest_y;
 	static bool dest_bgra;
 	static uint8_t *dest;
 	static bool mirror;
@@ -64,10 +74,20 @@ public:
 	DrawPolyTrianglesCommand(const PolyDrawArgs &args, bool mirror);
 
 	void Execute(DrawerThread *thread) override;
+	bool LineRange(int &first_line, int &count) override;
 	FString DebugInfo() override { return "DrawPolyTriangles"; }
 
 private:
 	PolyDrawArgs args;
+
+	// Transform, clipping and triangle setup are done once when the command is created.
+	// The drawer threads then only rasterize the triangles touching their lines.
+	// All drawer threads execute the same command, so these are read-only once it has been created.
+	std::vector<PolyScreenTriangle> triangles;
+	TriDrawTriangleArgs drawargs;
+	int dest_y;
+	int miny, maxy;
+	bool lineblocks;	// lines are handed out to threads in blocks of 8 rather than one at a time
 };
 
 class DrawRectCommand : public DrawerCommand
@@ -76,6 +96,7 @@ public:
 	DrawRectCommand(const RectDrawArgs &args) : args(args) { }
 
 	void Execute(DrawerThread *thread) override;
+	bool LineRange(int &first_line, int &count) override;
 	FString DebugInfo() override { return "DrawRect"; }
 
 private:
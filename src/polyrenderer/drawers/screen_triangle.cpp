@@ -86,6 +86,7 @@ private:
 
 	// Viewport clipping
 	int clipright;
+	int cliptop;
 	int clipbottom;
 
 	// Depth buffer
@@ -144,8 +145,10 @@ TriangleBlock::TriangleBlock(const TriDrawTriangleArgs *args, WorkerThreadData *
 	const ShadedTriVertex &v2 = *args->v2;
 	const ShadedTriVertex &v3 = *args->v3;
 
+	// Only rasterize the lines of the current pass
 	clipright = args->clipright;
-	clipbottom = args->clipbottom;
+	cliptop = MAX(thread->pass_start_y, 0);
+	clipbottom = MIN(args->clipbottom, thread->pass_end_y);
 
 	stencilPitch = args->stencilPitch;
 	stencilValues = args->stencilValues;
@@ -202,7 +205,7 @@ TriangleBlock::TriangleBlock(const TriDrawTriangleArgs *args, WorkerThreadData *
 	// Bounding rectangle
 	minx = MAX((MIN(MIN(X1, X2), X3) + 0xF) >> 4, 0);
 	maxx = MIN((MAX(MAX(X1, X2), X3) + 0xF) >> 4, clipright - 1);
-	miny = MAX((MIN(MIN(Y1, Y2), Y3) + 0xF) >> 4, 0);
+	miny = MAX((MIN(MIN(Y1, Y2), Y3) + 0xF) >> 4, cliptop);
 	maxy = MIN((MAX(MAX(Y1, Y2), Y3) + 0xF) >> 4, clipbottom - 1);
 	if (minx >= maxx || miny >= maxy)
 	{
@@ -490,11 +493,13 @@ void TriangleBlock::ClipTest()
 	};
 
 	uint32_t xmask = (X + 8 <= clipright) ? 0xffffffff : clipxmask[clipright - X];
-	uint32_t ymask0 = (Y + 4 <= clipbottom) ? 0xffffffff : clipymask[clipbottom - Y];
-	uint32_t ymask1 = (Y + 8 <= clipbottom) ? 0xffffffff : clipymask[clipbottom - Y - 4];
+	uint32_t ymask0 = (Y + 4 <= clipbottom) ? 0xffffffff : clipymask[clamp(clipbottom - Y, 0, 4)];
+	uint32_t ymask1 = (Y + 8 <= clipbottom) ? 0xffffffff : clipymask[clamp(clipbottom - Y - 4, 0, 4)];
+	uint32_t topmask0 = (Y >= cliptop) ? 0xffffffff : ~clipymask[MIN(cliptop - Y, 4)];
+	uint32_t topmask1 = (Y + 4 >= cliptop) ? 0xffffffff : ~clipymask[MIN(cliptop - Y - 4, 4)];
 
-	Mask0 = Mask0 & xmask & ymask0;
-	Mask1 = Mask1 & xmask & ymask1;
+	Mask0 = Mask0 & xmask & ymask0 & topmask0;
+	Mask1 = Mask1 & xmask & ymask1 & topmask1;
 }
 
 #ifdef NO_SSE
@@ -1121,6 +1126,10 @@ void ScreenTriangle::DrawSWRender(const TriDrawTriangleArgs *args, WorkerThreadD
 	if (topY >= bottomY)
 		return;
 
+	// Only rasterize the lines of the current pass
+	int startY = MAX(topY, thread->pass_start_y);
+	int endY = MIN(bottomY, thread->pass_end_y);
+
 	// Find start/end X positions for each line covered by the triangle:
 
 	int leftEdge[MAXHEIGHT];
@@ -1187,7 +1196,7 @@ void ScreenTriangle::DrawSWRender(const TriDrawTriangleArgs *args, WorkerThreadD
 	float v1W = args->v1->w;
 
 	int num_cores = thread->num_cores;
-	for (int y = topY + thread->skipped_by_thread(topY); y < bottomY; y += num_cores)
+	for (int y = startY + thread->skipped_by_thread(startY); y < endY; y += num_cores)
 	{
 		int x = leftEdge[y];
 		int xend = rightEdge[y];
@@ -33,12 +33,44 @@ struct WorkerThreadData
 	int32_t core;
 	int32_t num_cores;
 
+	// Lines rendered in the current pass
+	int32_t pass_start_y = 0;
+	int32_t pass_end_y = 0x7fffffff;
+
 	// The number of lines to skip to reach the first line to be rendered by this thread
 	int skipped_by_thread(int first_line)
 	{
 		int core_skip = (num_cores - (first_line - core) % num_cores) % num_cores;
 		return core_skip;
 	}
+
+	// Checks if a line belongs to another thread or pass. Lines are distributed in blocks of 8.
+	bool line_skipped_by_thread(int line)
+	{
+		return line < pass_start_y || line >= pass_end_y || (line / 8) % num_cores != core;
+	}
+
+	// Checks if none of the lines from y0 to y1 (inclusive) are rendered by this thread
+	bool lines_skipped_by_thread(int y0, int y1, bool blocks)
+	{
+		if (y0 < pass_start_y) y0 = pass_start_y;
+		if (y1 >= pass_end_y) y1 = pass_end_y - 1;
+		if (y0 > y1)
+			return true;
+		if (blocks)
+		{
+			y0 /= 8;
+			y1 /= 8;
+		}
+		if (y1 - y0 + 1 >= num_cores)
+			return false;
+		for (int y = y0; y <= y1; y++)
+		{
+			if (y % num_cores == core)
+				return false;
+		}
+		return true;
+	}
 };
 
 struct ShadedTriVertex
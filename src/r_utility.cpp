@@ -67,6 +67,7 @@
 #include "math/cmath.h"
 #include "vm.h"
 #include "i_time.h"
+#include "a_dynlight.h"
 
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
@@ -763,6 +764,9 @@ void R_SetupFrame (FRenderViewpoint &viewpoint, FViewWindow &viewwindow, AActor
 	InterpolationViewer *iview;
 	bool unlinked = false;
 
+	// Lights that moved since the last frame need to be linked before anything can be rendered.
+	ADynamicLight::LinkPendingLights();
+
 	if (player != NULL && player->mo == actor)
 	{	// [RH] Use camera instead of viewplayer
 		viewpoint.camera = player->camera;
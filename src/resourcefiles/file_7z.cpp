@@ -119,10 +119,9 @@ struct C7zArchive
 
 	C7zArchive(FileReader *file) : ArchiveStream(file)
 	{
-		if (g_CrcTable[1] == 0)
-		{
-			CrcGenerateTable();
-		}
+		// Archives may get opened on several threads at once during startup.
+		static const bool crcinit = (CrcGenerateTable(), true);
+		(void)crcinit;
 		file->Seek(0, SEEK_SET);
 		LookToRead2_CreateVTable(&LookStream, false);
 		LookStream.realStream = &ArchiveStream.s;
@@ -34,6 +34,12 @@
 */
 
 #include <time.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <deque>
+#include <vector>
 #include "file_zip.h"
 #include "cmdlib.h"
 #include "templates.h"
@@ -42,6 +48,7 @@
 #include "w_zip.h"
 #include "i_system.h"
 #include "ancientzip.h"
+#include "c_console.h"
 
 #define BUFREADCOMMENT (0x400)
 
@@ -441,6 +448,145 @@ FileReader *FZipLump::GetReader()
 	else return NULL;	
 }
 
+//==========================================================================
+//
+// Background decompression
+//
+// Lumps that are needed during startup can be inflated on worker threads
+// while the main thread is busy with other things. The workers never touch
+// the lump or its owner, they only read the compressed data from memory.
+//
+//==========================================================================
+
+struct FZipPrefetch
+{
+	char *Buffer;
+	FCapturedOutput Output;
+	std::future<void> Finished;
+};
+
+class FZipPrefetchQueue
+{
+public:
+	~FZipPrefetchQueue()
+	{
+		std::unique_lock<std::mutex> lock(QueueMutex);
+		Shutdown = true;
+		lock.unlock();
+		QueueCondition.notify_all();
+		for (auto &thread : Threads)
+			thread.join();
+	}
+
+	void Add(std::packaged_task<void()> &&task)
+	{
+		std::unique_lock<std::mutex> lock(QueueMutex);
+		if (Threads.empty())
+		{
+			int numthreads = clamp<int>(std::thread::hardware_concurrency() - 1, 1, 4);
+			for (int i = 0; i < numthreads; i++)
+			{
+				Threads.push_back(std::thread([this]() { WorkerMain(); }));
+			}
+		}
+		Jobs.push_back(std::move(task));
+		lock.unlock();
+		QueueCondition.notify_one();
+	}
+
+private:
+	void WorkerMain()
+	{
+		while (true)
+		{
+			std::unique_lock<std::mutex> lock(QueueMutex);
+			QueueCondition.wait(lock, [this]() { return Shutdown || !Jobs.empty(); });
+			// Pending jobs are still run on shutdown so that nobody waits forever.
+			if (Jobs.empty())
+				return;
+			std::packaged_task<void()> task = std::move(Jobs.front());
+			Jobs.pop_front();
+			lock.unlock();
+			task();
+		}
+	}
+
+	std::mutex QueueMutex;
+	std::condition_variable QueueCondition;
+	std::deque<std::packaged_task<void()>> Jobs;
+	std::vector<std::thread> Threads;
+	bool Shutdown = false;
+};
+
+static FZipPrefetchQueue PrefetchQueue;
+
+//==========================================================================
+//
+// Queues the lump for background decompression. Only compressed lumps in
+// in-memory archives qualify, everything else is cheap enough to read
+// directly or needs the owner's file reader.
+//
+//==========================================================================
+
+void FZipLump::Prefetch()
+{
+	if (Cache != NULL || Prefetched != nullptr || Method == METHOD_STORED || LumpSize <= 0)
+	{
+		return;
+	}
+
+	const char *buffer = Owner->Reader->GetBuffer();
+	if (buffer == NULL)
+	{
+		return;
+	}
+	if (Flags & LUMPFZIP_NEEDFILESTART) SetLumpAddress();
+	if (Position < 0 || Position + (long)CompressedSize > Owner->Reader->GetLength())
+	{
+		return;
+	}
+
+	FZipPrefetch *job = new FZipPrefetch;
+	job->Buffer = new char[LumpSize];
+
+	const char *source = buffer + Position;
+	int method = Method, lumpsize = LumpSize, compressedsize = CompressedSize, gpflags = GPFlags;
+	std::packaged_task<void()> task([=]()
+	{
+		C_CaptureOutput(&job->Output);
+		try
+		{
+			MemoryReader reader(source, compressedsize);
+			UncompressZipLump(job->Buffer, &reader, method, lumpsize, compressedsize, gpflags);
+		}
+		catch (...)
+		{
+			C_CaptureOutput(NULL);
+			throw;
+		}
+		C_CaptureOutput(NULL);
+	});
+	job->Finished = task.get_future();
+	PrefetchQueue.Add(std::move(task));
+	Prefetched = job;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+FZipLump::~FZipLump()
+{
+	if (Prefetched != nullptr)
+	{
+		Prefetched->Finished.wait();
+		delete[] Prefetched->Buffer;
+		delete Prefetched;
+	}
+}
+
 //==========================================================================
 //
 // Fills the lump cache and performs decompression
@@ -460,6 +606,21 @@ int FZipLump::FillCache()
 		return -1;
 	}
 
+	if (Prefetched != nullptr)
+	{
+		// Already being decompressed in the background.
+		FZipPrefetch *job = Prefetched;
+		Prefetched = nullptr;
+		job->Finished.wait();
+		C_ReplayOutput(job->Output);
+		Cache = job->Buffer;
+		RefCount = 1;
+		std::future<void> result = std::move(job->Finished);
+		delete job;
+		result.get();	// rethrows whatever the worker ran into
+		return 1;
+	}
+
 	Owner->Reader->Seek(Position, SEEK_SET);
 	Cache = new char[LumpSize];
 	UncompressZipLump(Cache, Owner->Reader, Method, LumpSize, CompressedSize, GPFlags);
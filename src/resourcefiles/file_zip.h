@@ -14,6 +14,8 @@ enum
 //
 //==========================================================================
 
+struct FZipPrefetch;
+
 struct FZipLump : public FResourceLump
 {
 	uint16_t	GPFlags;
@@ -21,9 +23,12 @@ struct FZipLump : public FResourceLump
 	int		CompressedSize;
 	int		Position;
 	unsigned CRC32;
+	FZipPrefetch *Prefetched = nullptr;
 
+	~FZipLump();
 	virtual FileReader *GetReader();
 	virtual int FillCache();
+	virtual void Prefetch();
 
 private:
 	void SetLumpAddress();
@@ -73,6 +73,10 @@ struct FResourceLump
 	void *CacheLump();
 	int ReleaseCache();
 
+	// Starts loading the lump in the background if this can be done
+	// without touching the owner's file reader. Main thread only.
+	virtual void Prefetch() {}
+
 protected:
 	virtual int FillCache() = 0;
 
@@ -48,6 +48,7 @@
 #include "a_pickups.h"
 #include "thingdef.h"
 #include "p_lnspec.h"
+#include "p_local.h"
 #include "doomstat.h"
 #include "codegen.h"
 #include "m_fixed.h"
@@ -2422,6 +2423,7 @@ FxAssign::FxAssign(FxExpression *base, FxExpression *right, bool ismodify)
 {
 	AddressRequested = false;
 	AddressWritable = false;
+	IsLineFlagsWrite = false;
 }
 
 FxAssign::~FxAssign()
@@ -2446,6 +2448,15 @@ FxExpression *FxAssign::Resolve(FCompileContext &ctx)
 
 	ValueType = Base->ValueType;
 
+	// Sight check results are cached, so writing a line's flags needs to tell the sight code.
+	if (Base->ExprType == EFX_StructMember)
+	{
+		auto member = static_cast<FxStructMember *>(Base);
+		PType *type = member->classx->ValueType;
+		if (type->isPointer()) type = type->toPointer()->PointedType;
+		IsLineFlagsWrite = type->isStruct() && static_cast<PStruct *>(type)->TypeName == NAME_Line && member->membervar->SymbolName == NAME_Flags;
+	}
+
 	SAFE_RESOLVE(Right, ctx);
 
 	if (IsModifyAssign && Base->ValueType == TypeBool && Right->ValueType != TypeBool)
@@ -2521,6 +2532,12 @@ FxExpression *FxAssign::Resolve(FCompileContext &ctx)
 	return this;
 }
 
+int BuiltinInvalidateSightCache(VMValue *param, TArray<VMValue> &defaultparam, int numparam, VMReturn *ret, int numret)
+{
+	P_InvalidateSightCache();
+	return 0;
+}
+
 ExpEmit FxAssign::Emit(VMFunctionBuilder *build)
 {
 	static const uint8_t loadops[] = { OP_LK, OP_LKF, OP_LKS, OP_LKP };
@@ -2580,6 +2597,15 @@ ExpEmit FxAssign::Emit(VMFunctionBuilder *build)
 
 	}
 
+	if (IsLineFlagsWrite)
+	{
+		PSymbol *sym = FindBuiltinFunction(NAME_BuiltinInvalidateSightCache, BuiltinInvalidateSightCache);
+
+		assert(sym->IsKindOf(RUNTIME_CLASS(PSymbolVMFunction)));
+		assert(((PSymbolVMFunction *)sym)->Function != nullptr);
+		build->Emit(OP_CALL_K, build->GetConstantAddress(((PSymbolVMFunction *)sym)->Function), 0, 0);
+	}
+
 	if (AddressRequested)
 	{
 		result.Free(build);
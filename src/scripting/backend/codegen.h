@@ -850,6 +850,7 @@ class FxAssign : public FxExpression
 	bool AddressRequested;
 	bool AddressWritable;
 	bool IsModifyAssign;
+	bool IsLineFlagsWrite;
 
 	friend class FxAssignSelf;
 
@@ -39,6 +39,9 @@
 //#include "thingdef.h"
 #include "doomerrors.h"
 #include "vmintern.h"
+#include "c_cvars.h"
+
+CVAR(Bool, vm_fuseops, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
 
 struct VMRemap
 {
@@ -111,6 +114,10 @@ void VMFunctionBuilder::EndStatement()
 
 void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 {
+	if (vm_fuseops)
+	{
+		FuseInstructions();
+	}
 	func->Alloc(Code.Size(), IntConstantList.Size(), FloatConstantList.Size(), StringConstantList.Size(), AddressConstantList.Size(), LineNumbers.Size());
 
 	// Copy code block.
@@ -149,6 +156,59 @@ void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 	assert(ActiveParam == 0);
 }
 
+//==========================================================================
+//
+// VMFunctionBuilder :: FuseInstructions
+//
+// Peephole pass that replaces frequent instruction sequences with
+// superinstructions. Only the opcode of the first instruction changes: the
+// rest of the sequence stays where it is, so jumps into it and the line
+// number table need no adjustment, and the superinstruction simply reads
+// the operands of the instructions behind it.
+//
+//==========================================================================
+
+void VMFunctionBuilder::FuseInstructions()
+{
+	for (unsigned i = 0; i + 1 < Code.Size(); i++)
+	{
+		VMOP &op = Code[i];
+		const VMOP &next = Code[i + 1];
+		bool branch = i + 2 < Code.Size() && Code[i + 2].op == OP_JMP;
+
+		switch (op.op)
+		{
+		case OP_LBIT:
+		case OP_LW:
+			// Flag and field tests: if (bFlag), if (field == value)
+			if (next.op == OP_EQ_K && next.b == op.a && branch)
+			{
+				op.op = op.op == OP_LBIT ? OP_LBIT_EQK : OP_LW_EQK;
+				i += 2;
+			}
+			break;
+
+		case OP_LO:
+		case OP_LP:
+			// Pointer tests: if (target), if (ptr == null)
+			if (next.op == OP_EQA_K && next.b == op.a && branch)
+			{
+				op.op = op.op == OP_LO ? OP_LO_EQAK : OP_LP_EQAK;
+				i += 2;
+			}
+			break;
+
+		case OP_PARAM:
+			if (next.op == OP_PARAM)
+			{
+				op.op = OP_PARAM2;
+				i++;
+			}
+			break;
+		}
+	}
+}
+
 //==========================================================================
 //
 // VMFunctionBuilder :: FillIntConstants
@@ -915,6 +975,7 @@ void FFunctionBuildList::Build()
 				{
 					sfunc->NumArgs += s->GetRegCount();
 				}
+				VMJitCompile(sfunc);
 
 				if (dump != nullptr)
 				{
@@ -115,6 +115,7 @@ private:
 
 	TArray<VMOP> Code;
 
+	void FuseInstructions();
 };
 
 void DumpFunction(FILE *dump, VMScriptFunction *sfunc, const char *label, int labellen);
@@ -296,6 +296,10 @@ void VMDisasm(FILE *out, const VMOP *code, int codesize, const VMScriptFunction
 		{
 			name = "parama";
 		}
+		else if (code[i].op == OP_PARAM2 && code[i].b & REGT_ADDROF)
+		{
+			name = "param2a";
+		}
 		if (cmp)
 		{ // Comparison instruction. Modify name for inverted test.
 			if (!(a & CMP_CHECK))
@@ -45,6 +45,11 @@
 
 extern cycle_t VMCycles[10];
 extern int VMCalls[10];
+extern unsigned VMOpCounts[NUM_OPS];
+extern unsigned VMOpPairs[NUM_OPS][NUM_OPS];
+static unsigned VMLastOp;
+
+EXTERN_CVAR(Bool, vm_jit)
 
 // intentionally implemented in a different source file to prevent inlining.
 #if 0
@@ -57,9 +62,12 @@ void ThrowVMException(VMException *x);
 #define COMPGOTO 1
 #endif
 
+// Only the profiling engine counts the executed instructions.
+#define PROFILEOP(op)	(ProfileOps ? (VMOpCounts[op]++, VMOpPairs[VMLastOp][op]++, VMLastOp = op) : 0)
+
 #if COMPGOTO
 #define OP(x)	x
-#define NEXTOP	do { pc++; unsigned op = pc->op; a = pc->a; goto *ops[op]; } while(0)
+#define NEXTOP	do { pc++; unsigned op = pc->op; a = pc->a; PROFILEOP(op); goto *ops[op]; } while(0)
 #else
 #define OP(x)	case OP_##x
 #define NEXTOP	pc++; break
@@ -117,6 +125,7 @@ void ThrowVMException(VMException *x);
 #include <assert.h>
 struct VMExec_Checked
 {
+	static const bool ProfileOps = false;
 #include "vmexec.h"
 };
 #if WAS_NDEBUG
@@ -130,6 +139,12 @@ struct VMExec_Checked
 #include <assert.h>
 struct VMExec_Unchecked
 {
+	static const bool ProfileOps = false;
+#include "vmexec.h"
+};
+struct VMExec_Profiled
+{
+	static const bool ProfileOps = true;
 #include "vmexec.h"
 };
 #if !WAS_NDEBUG
@@ -157,7 +172,8 @@ thread_local VMFrameStack GlobalVMStack;
 // VMSelectEngine
 //
 // Selects the VM engine, either checked or unchecked. Default will decide
-// based on the NDEBUG preprocessor definition.
+// based on the NDEBUG preprocessor definition. The profiled engine is the
+// unchecked one with instruction counting.
 //
 //===========================================================================
 
@@ -178,6 +194,9 @@ void VMSelectEngine(EVMEngine engine)
 	case VMEngine_Checked:
 		VMExec = VMExec_Checked::Exec;
 		break;
+	case VMEngine_Profiled:
+		VMExec = VMExec_Profiled::Exec;
+		break;
 	}
 }
 
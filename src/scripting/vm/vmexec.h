@@ -78,12 +78,23 @@ static int Exec(VMFrameStack *stack, const VMOP *pc, VMReturn *ret, int numret)
 	const double *fbp, *fcp;
 	int a, b, c;
 
+	if (!ProfileOps && sfunc != NULL && sfunc->JitFunc != nullptr && pc == sfunc->Code && vm_jit)
+	{
+		int result = sfunc->JitFunc(reg.d, reg.f, reg.a, ret, numret);
+		if (result >= 0)
+		{
+			return result;
+		}
+		// The native code stopped at an instruction it does not handle.
+		pc = sfunc->Code + (-result - 1);
+	}
+
 //begin:
 	try
 	{
 #if !COMPGOTO
 	VM_UBYTE op;
-	for(;;) switch(op = pc->op, a = pc->a, op)
+	for(;;) switch(op = pc->op, a = pc->a, PROFILEOP(op), op)
 #else
 	pc--;
 	NEXTOP;
@@ -320,6 +331,43 @@ static int Exec(VMFrameStack *stack, const VMOP *pc, VMReturn *ret, int numret)
 		reg.d[a] = !!(*(VM_UBYTE *)ptr & C);
 		NEXTOP;
 
+	OP(LBIT_EQK):
+		ASSERTD(a); ASSERTA(B);
+		GETADDR(PB,0,X_READ_NIL);
+		reg.d[a] = !!(*(VM_UBYTE *)ptr & C);
+		pc++;
+		a = A;
+		assert(pc->op == OP_EQ_K);
+		CMPJMP(reg.d[B] == konstd[C]);
+		NEXTOP;
+	OP(LW_EQK):
+		ASSERTD(a); ASSERTA(B); ASSERTKD(C);
+		GETADDR(PB,KC,X_READ_NIL);
+		reg.d[a] = *(VM_SWORD *)ptr;
+		pc++;
+		a = A;
+		assert(pc->op == OP_EQ_K);
+		CMPJMP(reg.d[B] == konstd[C]);
+		NEXTOP;
+	OP(LO_EQAK):
+		ASSERTA(a); ASSERTA(B); ASSERTKD(C);
+		GETADDR(PB,KC,X_READ_NIL);
+		reg.a[a] = GC::ReadBarrier(*(DObject **)ptr);
+		pc++;
+		a = A;
+		assert(pc->op == OP_EQA_K);
+		CMPJMP(reg.a[B] == konsta[C].v);
+		NEXTOP;
+	OP(LP_EQAK):
+		ASSERTA(a); ASSERTA(B); ASSERTKD(C);
+		GETADDR(PB,KC,X_READ_NIL);
+		reg.a[a] = *(void **)ptr;
+		pc++;
+		a = A;
+		assert(pc->op == OP_EQA_K);
+		CMPJMP(reg.a[B] == konsta[C].v);
+		NEXTOP;
+
 	OP(SB):
 		ASSERTA(a); ASSERTD(B); ASSERTKD(C);
 		GETADDR(PA,KC,X_WRITE_NIL);
@@ -578,7 +626,12 @@ static int Exec(VMFrameStack *stack, const VMOP *pc, VMReturn *ret, int numret)
 			::new(param) VMValue(ABCs);
 		}
 		NEXTOP;
+	OP(PARAM2):
+		c = 2;
+		goto Do_PARAM;
 	OP(PARAM):
+		c = 1;
+	Do_PARAM:
 		assert(f->NumParam < sfunc->MaxParam);
 		{
 			VMValue *param = &reg.param[f->NumParam++];
@@ -660,6 +713,12 @@ static int Exec(VMFrameStack *stack, const VMOP *pc, VMReturn *ret, int numret)
 				}
 			}
 		}
+		if (--c > 0)
+		{
+			pc++;
+			assert(pc->op == OP_PARAM);
+			goto Do_PARAM;
+		}
 		NEXTOP;
 	OP(VTBL):
 		ASSERTA(a); ASSERTA(B);
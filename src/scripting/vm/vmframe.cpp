@@ -33,6 +33,7 @@
 */
 
 #include <new>
+#include <algorithm>
 #include "dobject.h"
 #include "v_text.h"
 #include "stats.h"
@@ -43,6 +44,8 @@
 
 cycle_t VMCycles[10];
 int VMCalls[10];
+unsigned VMOpCounts[NUM_OPS];
+unsigned VMOpPairs[NUM_OPS][NUM_OPS];
 
 #if 0
 IMPLEMENT_CLASS(VMException, false, false)
@@ -73,6 +76,7 @@ VMScriptFunction::VMScriptFunction(FName name)
 	NumKonstA = 0;
 	MaxParam = 0;
 	NumArgs = 0;
+	JitFunc = nullptr;
 }
 
 VMScriptFunction::~VMScriptFunction()
@@ -637,3 +641,72 @@ CCMD(vmengine)
 	Printf("Usage: vmengine <default|checked|unchecked>\n");
 }
 
+//-----------------------------------------------------------------------------
+//
+// vmprofile
+//
+// Counts the executed instructions and the most frequent pairs of them, which
+// are the candidates for superinstructions. Counting runs in a separate copy
+// of the interpreter so that normal execution does not pay for it.
+//
+//-----------------------------------------------------------------------------
+
+static decltype(VMExec) VMExecBeforeProfiling;	// the engine to go back to on 'stop'
+
+CCMD(vmprofile)
+{
+	if (argv.argc() >= 2 && stricmp(argv[1], "start") == 0)
+	{
+		memset(VMOpCounts, 0, sizeof(VMOpCounts));
+		memset(VMOpPairs, 0, sizeof(VMOpPairs));
+		if (VMExecBeforeProfiling == nullptr) VMExecBeforeProfiling = VMExec;
+		VMSelectEngine(VMEngine_Profiled);
+		Printf("VM profiling started\n");
+		return;
+	}
+	if (argv.argc() >= 2 && stricmp(argv[1], "stop") == 0)
+	{
+		if (VMExecBeforeProfiling != nullptr)
+		{
+			VMExec = VMExecBeforeProfiling;
+			VMExecBeforeProfiling = nullptr;
+		}
+		Printf("VM profiling stopped\n");
+		return;
+	}
+	if (argv.argc() >= 2 && stricmp(argv[1], "dump") == 0)
+	{
+		int count = argv.argc() >= 3 ? clamp(atoi(argv[2]), 1, 1000) : 20;
+		TArray<std::pair<unsigned, int>> ops, pairs;
+		double total = 0;
+
+		for (int i = 0; i < NUM_OPS; i++)
+		{
+			if (VMOpCounts[i] > 0) ops.Push(std::make_pair(VMOpCounts[i], i));
+			total += VMOpCounts[i];
+			for (int j = 0; j < NUM_OPS; j++)
+			{
+				if (VMOpPairs[i][j] > 0) pairs.Push(std::make_pair(VMOpPairs[i][j], i * NUM_OPS + j));
+			}
+		}
+		auto bycount = [](const std::pair<unsigned, int> &a, const std::pair<unsigned, int> &b) { return a.first > b.first; };
+		std::sort(ops.begin(), ops.end(), bycount);
+		std::sort(pairs.begin(), pairs.end(), bycount);
+		if (total == 0) total = 1;
+
+		Printf(TEXTCOLOR_YELLOW "Instructions:\n");
+		for (unsigned i = 0; i < ops.Size() && i < (unsigned)count; i++)
+		{
+			Printf("%-12s %10u %6.2f%%\n", OpInfo[ops[i].second].Name, ops[i].first, ops[i].first * 100. / total);
+		}
+		Printf(TEXTCOLOR_YELLOW "Pairs:\n");
+		for (unsigned i = 0; i < pairs.Size() && i < (unsigned)count; i++)
+		{
+			FString name;
+			name.Format("%s %s", OpInfo[pairs[i].second / NUM_OPS].Name, OpInfo[pairs[i].second % NUM_OPS].Name);
+			Printf("%-24s %10u %6.2f%%\n", name.GetChars(), pairs[i].first, pairs[i].first * 100. / total);
+		}
+		return;
+	}
+	Printf("Usage: vmprofile <start|stop|dump [count]>\n");
+}
@@ -423,7 +423,8 @@ enum EVMEngine
 {
 	VMEngine_Default,
 	VMEngine_Unchecked,
-	VMEngine_Checked
+	VMEngine_Checked,
+	VMEngine_Profiled
 };
 
 void VMSelectEngine(EVMEngine engine);
@@ -437,6 +438,10 @@ extern thread_local VMFrameStack GlobalVMStack;
 
 typedef std::pair<const class PType *, unsigned> FTypeAndOffset;
 
+// Native code for a script function. Returns the number of results like the
+// interpreter or -(pc+1) to continue interpreting at that instruction.
+typedef int (*VMJitFunc)(int *regd, double *regf, void **rega, VMReturn *ret, int numret);
+
 class VMScriptFunction : public VMFunction
 {
 public:
@@ -465,6 +470,7 @@ public:
 	VM_UHALF NumKonstA;
 	VM_UHALF MaxParam;		// Maximum number of parameters this function has on the stack at once
 	VM_UBYTE NumArgs;		// Number of arguments this function takes
+	VMJitFunc JitFunc;		// Native code for the function, if any
 	TArray<FTypeAndOffset> SpecialInits;	// list of all contents on the extra stack which require construction and destruction
 
 	void InitExtra(void *addr);
@@ -472,3 +478,5 @@ public:
 	int AllocExtraStack(PType *type);
 	int PCToLine(const VMOP *pc);
 };
+
+bool VMJitCompile(VMScriptFunction *func);
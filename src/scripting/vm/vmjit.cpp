@@ -0,0 +1,1166 @@
+/*
+** vmjit.cpp
+** Baseline x86-64 code generator for VM script functions
+**
+**---------------------------------------------------------------------------
+** Copyright 2018 GZDoom maintainers
+** All rights reserved.
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions
+** are met:
+**
+** 1. Redistributions of source code must retain the above copyright
+**    notice, this list of conditions and the following disclaimer.
+** 2. Redistributions in binary form must reproduce the above copyright
+**    notice, this list of conditions and the following disclaimer in the
+**    documentation and/or other materials provided with the distribution.
+** 3. The name of the author may not be used to endorse or promote products
+**    derived from this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+** IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+** IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+** NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+** THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**---------------------------------------------------------------------------
+**
+** The generated code works directly on the frame's register arrays, so the
+** VM state is exactly the same as the interpreter's at every instruction
+** boundary. This allows the native code to hand control back to the
+** interpreter at any instruction it cannot translate, and also for anything
+** that needs to throw: the interpreter simply re-executes the instruction
+** and reports the error with proper line information. No exception ever
+** has to unwind through generated code.
+**
+*/
+
+#include <stddef.h>
+#include "dobject.h"
+#include "c_cvars.h"
+#include "stats.h"
+#include "templates.h"
+#include "v_text.h"
+#include "vmintern.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VM_JIT_X64 1
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#endif
+
+CVAR(Bool, vm_jit, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
+
+static int JitFunctions, JitInstructions, JitNativeInstructions;
+
+#ifdef VM_JIT_X64
+
+//==========================================================================
+//
+// FJitMemory
+//
+// Executable memory for generated code. Pages are only ever writable while
+// a function is being copied in.
+//
+//==========================================================================
+
+class FJitMemory
+{
+	struct Block
+	{
+		uint8_t *Memory;
+		size_t Size;
+		size_t Used;
+	};
+	TArray<Block> Blocks;
+
+	static void Protect(Block &block, bool writable)
+	{
+#ifdef _WIN32
+		DWORD old;
+		VirtualProtect(block.Memory, block.Size, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &old);
+#else
+		mprotect(block.Memory, block.Size, writable ? PROT_READ|PROT_WRITE : PROT_READ|PROT_EXEC);
+#endif
+	}
+
+public:
+	~FJitMemory()
+	{
+		for (auto &block : Blocks)
+		{
+#ifdef _WIN32
+			VirtualFree(block.Memory, 0, MEM_RELEASE);
+#else
+			munmap(block.Memory, block.Size);
+#endif
+		}
+	}
+
+	void *Commit(const uint8_t *code, size_t size)
+	{
+		size_t alignedsize = (size + 15) & ~size_t(15);
+		if (Blocks.Size() == 0 || Blocks.Last().Size - Blocks.Last().Used < alignedsize)
+		{
+			Block block;
+			block.Size = MAX<size_t>(alignedsize, 256 * 1024);
+			block.Size = (block.Size + 65535) & ~size_t(65535);
+			block.Used = 0;
+#ifdef _WIN32
+			block.Memory = (uint8_t *)VirtualAlloc(nullptr, block.Size, MEM_COMMIT|MEM_RESERVE, PAGE_READWRITE);
+			if (block.Memory == nullptr) return nullptr;
+#else
+			void *mem = mmap(nullptr, block.Size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+			if (mem == MAP_FAILED) return nullptr;
+			block.Memory = (uint8_t *)mem;
+#endif
+			Protect(block, false);
+			Blocks.Push(block);
+		}
+		Block &block = Blocks.Last();
+		uint8_t *dest = block.Memory + block.Used;
+		Protect(block, true);
+		memcpy(dest, code, size);
+		Protect(block, false);
+#ifdef _WIN32
+		FlushInstructionCache(GetCurrentProcess(), dest, size);
+#endif
+		block.Used += alignedsize;
+		return dest;
+	}
+};
+
+static FJitMemory JitMemory;
+
+//==========================================================================
+//
+// FJitCompiler
+//
+// Translates one function instruction by instruction. The native code keeps
+// no VM register in a machine register across instruction boundaries.
+//
+// rbx = int registers, r12 = float registers, r13 = pointer registers,
+// r14 = VMReturn array, r15d = number of wanted returns.
+//
+//==========================================================================
+
+class FJitCompiler
+{
+public:
+	FJitCompiler(VMScriptFunction *func) : Func(func) {}
+
+	TArray<uint8_t> Code;
+	int NativeCount = 0;
+
+	bool Compile();
+
+private:
+	enum
+	{
+		RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15,
+		XMM0 = 0, XMM1 = 1,
+	};
+	enum
+	{
+		CC_P = 0xA, CC_B = 2, CC_AE = 3, CC_E = 4, CC_NE = 5, CC_BE = 6, CC_A = 7,
+		CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF,
+	};
+	enum
+	{
+		TARGET_EXIT = -1,
+		// Values below this are bailouts to instruction (TARGET_BAIL - target)
+		TARGET_BAIL = -2,
+	};
+
+	struct FFixup
+	{
+		unsigned Pos;
+		int Target;
+	};
+
+	VMScriptFunction *Func;
+	TArray<unsigned> Labels;
+	TArray<FFixup> Fixups;
+
+	void Byte(int b) { Code.Push((uint8_t)b); }
+	void Dword(int32_t v) { for (int i = 0; i < 4; i++) Byte(v >> (i * 8)); }
+	void Qword(int64_t v) { for (int i = 0; i < 8; i++) Byte(int(v >> (i * 8))); }
+
+	void Rex(bool w, int reg, int rm)
+	{
+		int rex = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+		if (rex != 0x40) Byte(rex);
+	}
+	void Opcode(int op)
+	{
+		if (op > 0xff) Byte(op >> 8);
+		Byte(op & 0xff);
+	}
+	// op reg, [base + disp32]
+	void OpM(int prefix, bool w, int op, int reg, int base, int32_t disp)
+	{
+		if (prefix) Byte(prefix);
+		Rex(w, reg, base);
+		Opcode(op);
+		Byte(0x80 | ((reg & 7) << 3) | (base & 7));
+		if ((base & 7) == RSP) Byte(0x24);
+		Dword(disp);
+	}
+	// op reg, rm
+	void OpR(int prefix, bool w, int op, int reg, int rm)
+	{
+		if (prefix) Byte(prefix);
+		Rex(w, reg, rm);
+		Opcode(op);
+		Byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+	}
+	// group 1 operation with a 32 bit immediate on a register
+	void OpRI(bool w, int ext, int rm, int32_t imm)
+	{
+		OpR(0, w, 0x81, ext, rm);
+		Dword(imm);
+	}
+	void MovRI(int reg, int32_t imm)
+	{
+		Rex(false, 0, reg);
+		Byte(0xB8 + (reg & 7));
+		Dword(imm);
+	}
+	void MovRI64(int reg, const void *imm)
+	{
+		Rex(true, 0, reg);
+		Byte(0xB8 + (reg & 7));
+		Qword((int64_t)(intptr_t)imm);
+	}
+	void MovMI(bool w, int base, int32_t disp, int32_t imm)
+	{
+		OpM(0, w, 0xC7, 0, base, disp);
+		Dword(imm);
+	}
+
+	void LoadD(int reg, int r) { OpM(0, false, 0x8B, reg, RBX, r * 4); }
+	void StoreD(int r, int reg) { OpM(0, false, 0x89, reg, RBX, r * 4); }
+	void LoadA(int reg, int r) { OpM(0, true, 0x8B, reg, R13, r * 8); }
+	void StoreA(int r, int reg) { OpM(0, true, 0x89, reg, R13, r * 8); }
+	void LoadF(int xmm, int r) { OpM(0xF2, false, 0x0F10, xmm, R12, r * 8); }
+	void StoreF(int r, int xmm) { OpM(0xF2, false, 0x0F11, xmm, R12, r * 8); }
+	void FloatOp(int op, int xmm, int r) { OpM(0xF2, false, op, xmm, R12, r * 8); }
+	// Points rax at a float constant and applies op with it.
+	void FloatOpK(int op, int xmm, int k)
+	{
+		MovRI64(RAX, &Func->KonstF[k]);
+		OpM(0xF2, false, op, xmm, RAX, 0);
+	}
+
+	void AddFixup(int target)
+	{
+		Fixups.Push({ Code.Size(), target });
+		Dword(0);
+	}
+	void Jmp(int target) { Byte(0xE9); AddFixup(target); }
+	void Jcc(int cc, int target) { Byte(0x0F); Byte(0x80 | cc); AddFixup(target); }
+	void Bail(int index) { MovRI(RAX, -(index + 1)); Jmp(TARGET_EXIT); }
+
+	unsigned JccLocal(int cc) { Byte(0x0F); Byte(0x80 | cc); Dword(0); return Code.Size(); }
+	void BindLocal(unsigned pos)
+	{
+		int32_t rel = Code.Size() - pos;
+		memcpy(&Code[pos - 4], &rel, 4);
+	}
+
+	bool KonstD(int k) const { return k < Func->NumKonstD; }
+	bool KonstF(int k) const { return k < Func->NumKonstF; }
+	bool KonstA(int k) const { return k < Func->NumKonstA; }
+	bool JumpTarget(int index) const { return index >= 0 && index < Func->CodeSize; }
+
+	void NullCheck(int index, int preg)
+	{
+		LoadA(RAX, preg);
+		OpR(0, true, 0x85, RAX, RAX);
+		Jcc(CC_E, TARGET_BAIL - index);
+	}
+	bool Address(int index, int preg, int oreg, bool konst, int32_t &disp);
+	bool EmitInstruction(int index);
+	bool EmitRet(const VMOP *pc);
+	bool EmitCompare(int index, int cctrue);
+};
+
+//==========================================================================
+//
+// FJitCompiler :: Address
+//
+// Loads a pointer register into rax, bails out to the interpreter if it
+// is null and adds the offset. Constant offsets are returned in disp.
+//
+//==========================================================================
+
+bool FJitCompiler::Address(int index, int preg, int oreg, bool konst, int32_t &disp)
+{
+	if (konst && !KonstD(oreg)) return false;
+	NullCheck(index, preg);
+	if (konst)
+	{
+		disp = Func->KonstD[oreg];
+	}
+	else
+	{
+		OpM(0, true, 0x63, RCX, RBX, oreg * 4);	// movsxd rcx, d[oreg]
+		OpR(0, true, 0x03, RAX, RCX);
+		disp = 0;
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FJitCompiler :: EmitCompare
+//
+// The flags have been set up by the caller; branches to the JMP's target
+// if the condition matches the instruction's check bit.
+//
+//==========================================================================
+
+bool FJitCompiler::EmitCompare(int index, int cctrue)
+{
+	const VMOP *pc = &Func->Code[index];
+	if (index + 1 >= Func->CodeSize || pc[1].op != OP_JMP) return false;
+	int taken = index + 2 + pc[1].i24;
+	if (!JumpTarget(taken) || !JumpTarget(index + 2)) return false;
+	Jcc((pc->a & CMP_CHECK) ? cctrue : cctrue ^ 1, taken);
+	Jmp(index + 2);
+	return true;
+}
+
+//==========================================================================
+//
+// FJitCompiler :: EmitRet
+//
+//==========================================================================
+
+bool FJitCompiler::EmitRet(const VMOP *pc)
+{
+	int type = pc->b;
+	int retnum = pc->a & ~RET_FINAL;
+
+	if (type == REGT_NIL)
+	{
+		OpR(0, false, 0x33, RAX, RAX);
+		Jmp(TARGET_EXIT);
+		return true;
+	}
+	if (type & REGT_ADDROF) return false;
+	int count = (type & REGT_MULTIREG3) ? 3 : (type & REGT_MULTIREG2) ? 2 : 1;
+	bool konst = !!(type & REGT_KONST);
+	switch (type & REGT_TYPE)
+	{
+	case REGT_INT:
+		if (count != 1 || (konst && !KonstD(pc->c))) return false;
+		break;
+	case REGT_POINTER:
+		if (count != 1 || (konst && !KonstA(pc->c))) return false;
+		break;
+	case REGT_FLOAT:
+		if (konst && !KonstF(pc->c + count - 1)) return false;
+		break;
+	default:
+		return false;
+	}
+
+	OpRI(false, 7, R15, retnum);
+	unsigned skip = JccLocal(CC_LE);
+	OpM(0, true, 0x8B, RCX, R14, int32_t(retnum * sizeof(VMReturn) + offsetof(VMReturn, Location)));
+	switch (type & REGT_TYPE)
+	{
+	case REGT_INT:
+		if (konst)
+		{
+			MovMI(false, RCX, 0, Func->KonstD[pc->c]);
+		}
+		else
+		{
+			LoadD(RAX, pc->c);
+			OpM(0, false, 0x89, RAX, RCX, 0);
+		}
+		break;
+
+	case REGT_POINTER:
+		if (konst) MovRI64(RAX, Func->KonstA[pc->c].v);
+		else LoadA(RAX, pc->c);
+		OpM(0, true, 0x89, RAX, RCX, 0);
+		break;
+
+	case REGT_FLOAT:
+		for (int i = 0; i < count; i++)
+		{
+			if (konst)
+			{
+				MovRI64(RAX, &Func->KonstF[pc->c + i]);
+				OpM(0xF2, false, 0x0F10, XMM0, RAX, 0);
+			}
+			else
+			{
+				LoadF(XMM0, pc->c + i);
+			}
+			OpM(0xF2, false, 0x0F11, XMM0, RCX, i * 8);
+		}
+		break;
+	}
+	BindLocal(skip);
+	return true;
+}
+
+//==========================================================================
+//
+// FJitCompiler :: EmitInstruction
+//
+// Returns false without emitting anything if the instruction has to be
+// left to the interpreter.
+//
+//==========================================================================
+
+bool FJitCompiler::EmitInstruction(int index)
+{
+	const VMOP *pc = &Func->Code[index];
+	VMOP unfused;
+
+	// The instructions making up a superinstruction are still in place
+	// behind it, so only its first part needs to be translated.
+	switch (pc->op)
+	{
+	case OP_LBIT_EQK:	unfused = *pc; unfused.op = OP_LBIT; pc = &unfused; break;
+	case OP_LW_EQK:		unfused = *pc; unfused.op = OP_LW; pc = &unfused; break;
+	case OP_LO_EQAK:	unfused = *pc; unfused.op = OP_LO; pc = &unfused; break;
+	case OP_LP_EQAK:	unfused = *pc; unfused.op = OP_LP; pc = &unfused; break;
+	}
+
+	const int a = pc->a, B = pc->b, C = pc->c;
+	int32_t disp;
+
+	switch (pc->op)
+	{
+	case OP_NOP:
+		return true;
+
+	// Constants and moves
+	case OP_LI:
+		MovMI(false, RBX, a * 4, pc->i16);
+		return true;
+	case OP_LK:
+		if (!KonstD(pc->i16u)) return false;
+		MovMI(false, RBX, a * 4, Func->KonstD[pc->i16u]);
+		return true;
+	case OP_LKF:
+		if (!KonstF(pc->i16u)) return false;
+		FloatOpK(0x0F10, XMM0, pc->i16u);
+		StoreF(a, XMM0);
+		return true;
+	case OP_LKP:
+		if (!KonstA(pc->i16u)) return false;
+		MovRI64(RAX, Func->KonstA[pc->i16u].v);
+		StoreA(a, RAX);
+		return true;
+	case OP_MOVE:
+		LoadD(RAX, B);
+		StoreD(a, RAX);
+		return true;
+	case OP_MOVEF:
+		LoadF(XMM0, B);
+		StoreF(a, XMM0);
+		return true;
+	case OP_MOVEA:
+		LoadA(RAX, B);
+		StoreA(a, RAX);
+		return true;
+	case OP_MOVEV2:
+	case OP_MOVEV3:
+		for (int i = 0; i < (pc->op == OP_MOVEV2 ? 2 : 3); i++)
+		{
+			LoadF(XMM0, B + i);
+			StoreF(a + i, XMM0);
+		}
+		return true;
+
+	// Memory loads
+	case OP_LB: case OP_LB_R:
+	case OP_LH: case OP_LH_R:
+	case OP_LW: case OP_LW_R:
+	case OP_LBU: case OP_LBU_R:
+	case OP_LHU: case OP_LHU_R:
+	{
+		static const int ops[] = { 0x0FBE, 0x0FBF, 0x8B, 0x0FB6, 0x0FB7 };
+		int kind = (pc->op - OP_LB) / 2;
+		if (!Address(index, B, C, !((pc->op - OP_LB) & 1), disp)) return false;
+		OpM(0, false, ops[kind], RAX, RAX, disp);
+		StoreD(a, RAX);
+		return true;
+	}
+	case OP_LSP: case OP_LSP_R:
+		if (!Address(index, B, C, pc->op == OP_LSP, disp)) return false;
+		OpM(0xF3, false, 0x0F5A, XMM0, RAX, disp);	// cvtss2sd
+		StoreF(a, XMM0);
+		return true;
+	case OP_LDP: case OP_LDP_R:
+		if (!Address(index, B, C, pc->op == OP_LDP, disp)) return false;
+		OpM(0xF2, false, 0x0F10, XMM0, RAX, disp);
+		StoreF(a, XMM0);
+		return true;
+	case OP_LP: case OP_LP_R:
+		if (!Address(index, B, C, pc->op == OP_LP, disp)) return false;
+		OpM(0, true, 0x8B, RAX, RAX, disp);
+		StoreA(a, RAX);
+		return true;
+	case OP_LO: case OP_LO_R:
+	{
+		// Inline version of GC::ReadBarrier, including clearing the field.
+		if (!Address(index, B, C, pc->op == OP_LO, disp)) return false;
+		OpM(0, true, 0x8B, RDX, RAX, disp);
+		OpR(0, true, 0x85, RDX, RDX);
+		unsigned isnull = JccLocal(CC_E);
+		OpM(0, false, 0xF7, 0, RDX, int32_t(myoffsetof(DObject, ObjectFlags)));
+		Dword(OF_EuthanizeMe);
+		unsigned alive = JccLocal(CC_E);
+		MovMI(true, RAX, disp, 0);
+		OpR(0, false, 0x33, RDX, RDX);
+		BindLocal(isnull);
+		BindLocal(alive);
+		StoreA(a, RDX);
+		return true;
+	}
+	case OP_LV2: case OP_LV2_R:
+	case OP_LV3: case OP_LV3_R:
+	{
+		int count = (pc->op == OP_LV2 || pc->op == OP_LV2_R) ? 2 : 3;
+		if (!Address(index, B, C, pc->op == OP_LV2 || pc->op == OP_LV3, disp)) return false;
+		for (int i = 0; i < count; i++)
+		{
+			OpM(0xF2, false, 0x0F10, XMM0, RAX, disp + i * 8);
+			StoreF(a + i, XMM0);
+		}
+		return true;
+	}
+	case OP_LBIT:
+		NullCheck(index, B);
+		OpM(0, false, 0xF6, 0, RAX, 0);
+		Byte(C);
+		OpR(0, false, 0x0F95, 0, RCX);		// setne cl
+		OpR(0, false, 0x0FB6, RCX, RCX);	// movzx ecx, cl
+		StoreD(a, RCX);
+		return true;
+
+	// Memory stores
+	case OP_SB: case OP_SB_R:
+		if (!Address(index, a, C, pc->op == OP_SB, disp)) return false;
+		LoadD(RCX, B);
+		OpM(0, false, 0x88, RCX, RAX, disp);
+		return true;
+	case OP_SH: case OP_SH_R:
+		if (!Address(index, a, C, pc->op == OP_SH, disp)) return false;
+		LoadD(RCX, B);
+		OpM(0x66, false, 0x89, RCX, RAX, disp);
+		return true;
+	case OP_SW: case OP_SW_R:
+		if (!Address(index, a, C, pc->op == OP_SW, disp)) return false;
+		LoadD(RCX, B);
+		OpM(0, false, 0x89, RCX, RAX, disp);
+		return true;
+	case OP_SSP: case OP_SSP_R:
+		if (!Address(index, a, C, pc->op == OP_SSP, disp)) return false;
+		FloatOp(0x0F5A, XMM0, B);	// cvtsd2ss
+		OpM(0xF3, false, 0x0F11, XMM0, RAX, disp);
+		return true;
+	case OP_SDP: case OP_SDP_R:
+		if (!Address(index, a, C, pc->op == OP_SDP, disp)) return false;
+		LoadF(XMM0, B);
+		OpM(0xF2, false, 0x0F11, XMM0, RAX, disp);
+		return true;
+	case OP_SP: case OP_SP_R:
+		if (!Address(index, a, C, pc->op == OP_SP, disp)) return false;
+		LoadA(RCX, B);
+		OpM(0, true, 0x89, RCX, RAX, disp);
+		return true;
+	case OP_SV2: case OP_SV2_R:
+	case OP_SV3: case OP_SV3_R:
+	{
+		int count = (pc->op == OP_SV2 || pc->op == OP_SV2_R) ? 2 : 3;
+		if (!Address(index, a, C, pc->op == OP_SV2 || pc->op == OP_SV3, disp)) return false;
+		for (int i = 0; i < count; i++)
+		{
+			LoadF(XMM0, B + i);
+			OpM(0xF2, false, 0x0F11, XMM0, RAX, disp + i * 8);
+		}
+		return true;
+	}
+
+	// Integer math
+	case OP_ADD_RR: case OP_SUB_RR: case OP_AND_RR: case OP_OR_RR: case OP_XOR_RR: case OP_MUL_RR:
+	{
+		int op = pc->op == OP_ADD_RR ? 0x03 : pc->op == OP_SUB_RR ? 0x2B : pc->op == OP_AND_RR ? 0x23 :
+			pc->op == OP_OR_RR ? 0x0B : pc->op == OP_XOR_RR ? 0x33 : 0x0FAF;
+		LoadD(RAX, B);
+		OpM(0, false, op, RAX, RBX, C * 4);
+		StoreD(a, RAX);
+		return true;
+	}
+	case OP_ADD_RK: case OP_SUB_RK: case OP_AND_RK: case OP_OR_RK: case OP_XOR_RK:
+	{
+		if (!KonstD(C)) return false;
+		int ext = pc->op == OP_ADD_RK ? 0 : pc->op == OP_SUB_RK ? 5 : pc->op == OP_AND_RK ? 4 :
+			pc->op == OP_OR_RK ? 1 : 6;
+		LoadD(RAX, B);
+		OpRI(false, ext, RAX, Func->KonstD[C]);
+		StoreD(a, RAX);
+		return true;
+	}
+	case OP_MUL_RK:
+		if (!KonstD(C)) return false;
+		LoadD(RAX, B);
+		OpR(0, false, 0x69, RAX, RAX);
+		Dword(Func->KonstD[C]);
+		StoreD(a, RAX);
+		return true;
+	case OP_SUB_KR:
+		if (!KonstD(B)) return false;
+		MovRI(RAX, Func->KonstD[B]);
+		OpM(0, false, 0x2B, RAX, RBX, C * 4);
+		StoreD(a, RAX);
+		return true;
+	case OP_ADDI:
+		LoadD(RAX, B);
+		OpRI(false, 0, RAX, pc->cs);
+		StoreD(a, RAX);
+		return true;
+
+	case OP_SLL_RR: case OP_SRL_RR: case OP_SRA_RR:
+	case OP_SLL_KR: case OP_SRA_KR:
+	{
+		bool konst = pc->op == OP_SLL_KR || pc->op == OP_SRA_KR;
+		if (konst && !KonstD(B)) return false;
+		int ext = (pc->op == OP_SLL_RR || pc->op == OP_SLL_KR) ? 4 : pc->op == OP_SRL_RR ? 5 : 7;
+		if (konst) MovRI(RAX, Func->KonstD[B]);
+		else LoadD(RAX, B);
+		LoadD(RCX, C);
+		OpR(0, false, 0xD3, ext, RAX);
+		StoreD(a, RAX);
+		return true;
+	}
+	case OP_SLL_RI: case OP_SRL_RI: case OP_SRA_RI: case OP_SRL_KR:
+	{
+		// SRL_KR shifts by the C operand itself, the same as the interpreter.
+		bool konst = pc->op == OP_SRL_KR;
+		if (konst && !KonstD(B)) return false;
+		int ext = pc->op == OP_SLL_RI ? 4 : pc->op == OP_SRA_RI ? 7 : 5;
+		if (konst) MovRI(RAX, Func->KonstD[B]);
+		else LoadD(RAX, B);
+		OpR(0, false, 0xC1, ext, RAX);
+		Byte(C);
+		StoreD(a, RAX);
+		return true;
+	}
+
+	case OP_DIV_RR: case OP_DIV_RK: case OP_DIV_KR:
+	case OP_DIVU_RR: case OP_DIVU_RK: case OP_DIVU_KR:
+	case OP_MOD_RR: case OP_MOD_RK: case OP_MOD_KR:
+	case OP_MODU_RR: case OP_MODU_RK: case OP_MODU_KR:
+	{
+		int form = (pc->op - OP_DIV_RR) % 3;	// 0 = RR, 1 = RK, 2 = KR
+		int group = (pc->op - OP_DIV_RR) / 3;	// DIV, DIVU, MOD, MODU
+		bool isunsigned = group & 1;
+		if (form == 1 && !KonstD(C)) return false;
+		if (form == 2 && !KonstD(B)) return false;
+		if (form == 1)
+		{
+			// Division by a zero constant: the interpreter will throw.
+			if (Func->KonstD[C] == 0) return false;
+			MovRI(RCX, Func->KonstD[C]);
+		}
+		else
+		{
+			LoadD(RCX, C);
+			OpR(0, false, 0x85, RCX, RCX);
+			Jcc(CC_E, TARGET_BAIL - index);
+		}
+		if (form == 2) MovRI(RAX, Func->KonstD[B]);
+		else LoadD(RAX, B);
+		if (isunsigned)
+		{
+			OpR(0, false, 0x33, RDX, RDX);
+			OpR(0, false, 0xF7, 6, RCX);	// div ecx
+		}
+		else
+		{
+			Byte(0x99);						// cdq
+			OpR(0, false, 0xF7, 7, RCX);	// idiv ecx
+		}
+		StoreD(a, group >= 2 ? RDX : RAX);
+		return true;
+	}
+
+	case OP_MIN_RR: case OP_MIN_RK: case OP_MAX_RR: case OP_MAX_RK:
+	{
+		bool konst = pc->op == OP_MIN_RK || pc->op == OP_MAX_RK;
+		if (konst && !KonstD(C)) return false;
+		LoadD(RAX, B);
+		if (konst) MovRI(RCX, Func->KonstD[C]);
+		else LoadD(RCX, C);
+		OpR(0, false, 0x3B, RAX, RCX);
+		// cmovg for min, cmovl for max
+		OpR(0, false, (pc->op == OP_MIN_RR || pc->op == OP_MIN_RK) ? 0x0F4F : 0x0F4C, RAX, RCX);
+		StoreD(a, RAX);
+		return true;
+	}
+	case OP_ABS:
+		LoadD(RAX, B);
+		OpR(0, false, 0x8B, RCX, RAX);
+		OpR(0, false, 0xF7, 3, RAX);		// neg eax
+		OpR(0, false, 0x0F48, RAX, RCX);	// cmovs eax, ecx
+		StoreD(a, RAX);
+		return true;
+	case OP_NEG:
+	case OP_NOT:
+		LoadD(RAX, B);
+		OpR(0, false, 0xF7, pc->op == OP_NEG ? 3 : 2, RAX);
+		StoreD(a, RAX);
+		return true;
+
+	// Integer comparisons
+	case OP_EQ_R: case OP_EQ_K:
+	case OP_LT_RR: case OP_LT_RK: case OP_LT_KR:
+	case OP_LE_RR: case OP_LE_RK: case OP_LE_KR:
+	case OP_LTU_RR: case OP_LTU_RK: case OP_LTU_KR:
+	case OP_LEU_RR: case OP_LEU_RK: case OP_LEU_KR:
+	{
+		bool bkonst = pc->op == OP_LT_KR || pc->op == OP_LE_KR || pc->op == OP_LTU_KR || pc->op == OP_LEU_KR;
+		bool ckonst = pc->op == OP_EQ_K || pc->op == OP_LT_RK || pc->op == OP_LE_RK || pc->op == OP_LTU_RK || pc->op == OP_LEU_RK;
+		int cc = pc->op <= OP_EQ_K ? CC_E : pc->op <= OP_LT_KR ? CC_L : pc->op <= OP_LE_KR ? CC_LE : pc->op <= OP_LTU_KR ? CC_B : CC_BE;
+		if ((bkonst && !KonstD(B)) || (ckonst && !KonstD(C))) return false;
+		if (bkonst) MovRI(RAX, Func->KonstD[B]);
+		else LoadD(RAX, B);
+		if (ckonst) OpRI(false, 7, RAX, Func->KonstD[C]);
+		else OpM(0, false, 0x3B, RAX, RBX, C * 4);
+		if (!EmitCompare(index, cc))
+		{
+			Code.Resize(Labels[index]);
+			return false;
+		}
+		return true;
+	}
+
+	// Floating point math
+	case OP_ADDF_RR: case OP_SUBF_RR: case OP_MULF_RR: case OP_MINF_RR: case OP_MAXF_RR:
+	case OP_ADDF_RK: case OP_SUBF_RK: case OP_MULF_RK: case OP_MINF_RK: case OP_MAXF_RK:
+	{
+		bool konst = pc->op == OP_ADDF_RK || pc->op == OP_SUBF_RK || pc->op == OP_MULF_RK || pc->op == OP_MINF_RK || pc->op == OP_MAXF_RK;
+		int op = (pc->op == OP_ADDF_RR || pc->op == OP_ADDF_RK) ? 0x0F58 : (pc->op == OP_SUBF_RR || pc->op == OP_SUBF_RK) ? 0x0F5C :
+			(pc->op == OP_MULF_RR || pc->op == OP_MULF_RK) ? 0x0F59 : (pc->op == OP_MINF_RR || pc->op == OP_MINF_RK) ? 0x0F5D : 0x0F5F;
+		if (konst && !KonstF(C)) return false;
+		LoadF(XMM0, B);
+		if (konst) FloatOpK(op, XMM0, C);
+		else FloatOp(op, XMM0, C);
+		StoreF(a, XMM0);
+		return true;
+	}
+	case OP_SUBF_KR:
+		if (!KonstF(B)) return false;
+		FloatOpK(0x0F10, XMM0, B);
+		FloatOp(0x0F5C, XMM0, C);
+		StoreF(a, XMM0);
+		return true;
+	case OP_DIVF_RR: case OP_DIVF_RK: case OP_DIVF_KR:
+		if (pc->op == OP_DIVF_RK)
+		{
+			if (!KonstF(C) || Func->KonstF[C] == 0.) return false;
+			FloatOpK(0x0F10, XMM1, C);
+		}
+		else
+		{
+			if (pc->op == OP_DIVF_KR && !KonstF(B)) return false;
+			LoadF(XMM1, C);
+			OpR(0x66, false, 0x0F57, XMM0, XMM0);	// xorpd xmm0, xmm0
+			OpR(0x66, false, 0x0F2E, XMM1, XMM0);	// ucomisd xmm1, xmm0
+			unsigned unordered = JccLocal(CC_P);
+			Jcc(CC_E, TARGET_BAIL - index);
+			BindLocal(unordered);
+		}
+		if (pc->op == OP_DIVF_KR) FloatOpK(0x0F10, XMM0, B);
+		else LoadF(XMM0, B);
+		OpR(0xF2, false, 0x0F5E, XMM0, XMM1);
+		StoreF(a, XMM0);
+		return true;
+	case OP_FLOP:
+		if (C != FLOP_ABS && C != FLOP_NEG) return false;
+		OpM(0, true, 0x8B, RAX, R12, B * 8);
+		OpR(0, true, 0x0FBA, C == FLOP_ABS ? 6 : 7, RAX);	// btr / btc rax, 63
+		Byte(63);
+		OpM(0, true, 0x89, RAX, R12, a * 8);
+		return true;
+
+	// Floating point comparisons. Only the exact versions are handled.
+	case OP_EQF_R: case OP_EQF_K:
+	{
+		if (pc->a & CMP_APPROX) return false;
+		if (pc->op == OP_EQF_K && !KonstF(C)) return false;
+		if (index + 1 >= Func->CodeSize || pc[1].op != OP_JMP) return false;
+		int taken = index + 2 + pc[1].i24;
+		if (!JumpTarget(taken) || !JumpTarget(index + 2)) return false;
+		LoadF(XMM0, B);
+		if (pc->op == OP_EQF_K)
+		{
+			MovRI64(RAX, &Func->KonstF[C]);
+			OpM(0x66, false, 0x0F2E, XMM0, RAX, 0);
+		}
+		else
+		{
+			OpM(0x66, false, 0x0F2E, XMM0, R12, C * 8);
+		}
+		if (pc->a & CMP_CHECK)
+		{
+			Jcc(CC_P, index + 2);
+			Jcc(CC_E, taken);
+		}
+		else
+		{
+			Jcc(CC_P, taken);
+			Jcc(CC_NE, taken);
+		}
+		Jmp(index + 2);
+		return true;
+	}
+	case OP_LTF_RR: case OP_LTF_RK: case OP_LTF_KR:
+	case OP_LEF_RR: case OP_LEF_RK: case OP_LEF_KR:
+	{
+		if (pc->a & CMP_APPROX) return false;
+		bool bkonst = pc->op == OP_LTF_KR || pc->op == OP_LEF_KR;
+		bool ckonst = pc->op == OP_LTF_RK || pc->op == OP_LEF_RK;
+		if ((bkonst && !KonstF(B)) || (ckonst && !KonstF(C))) return false;
+		// Compare reversed so that unordered operands come out false.
+		if (ckonst) FloatOpK(0x0F10, XMM0, C);
+		else LoadF(XMM0, C);
+		if (bkonst)
+		{
+			MovRI64(RAX, &Func->KonstF[B]);
+			OpM(0x66, false, 0x0F2E, XMM0, RAX, 0);
+		}
+		else
+		{
+			OpM(0x66, false, 0x0F2E, XMM0, R12, B * 8);
+		}
+		if (!EmitCompare(index, pc->op <= OP_LTF_KR ? CC_A : CC_AE))
+		{
+			Code.Resize(Labels[index]);
+			return false;
+		}
+		return true;
+	}
+
+	// Vectors
+	case OP_NEGV2: case OP_NEGV3:
+		for (int i = 0; i < (pc->op == OP_NEGV2 ? 2 : 3); i++)
+		{
+			OpM(0, true, 0x8B, RAX, R12, (B + i) * 8);
+			OpR(0, true, 0x0FBA, 7, RAX);
+			Byte(63);
+			OpM(0, true, 0x89, RAX, R12, (a + i) * 8);
+		}
+		return true;
+	case OP_ADDV2_RR: case OP_SUBV2_RR: case OP_ADDV3_RR: case OP_SUBV3_RR:
+	{
+		int op = (pc->op == OP_ADDV2_RR || pc->op == OP_ADDV3_RR) ? 0x0F58 : 0x0F5C;
+		for (int i = 0; i < ((pc->op == OP_ADDV2_RR || pc->op == OP_SUBV2_RR) ? 2 : 3); i++)
+		{
+			LoadF(XMM0, B + i);
+			FloatOp(op, XMM0, C + i);
+			StoreF(a + i, XMM0);
+		}
+		return true;
+	}
+	case OP_MULVF2_RR: case OP_MULVF2_RK: case OP_MULVF3_RR: case OP_MULVF3_RK:
+	{
+		bool konst = pc->op == OP_MULVF2_RK || pc->op == OP_MULVF3_RK;
+		if (konst && !KonstF(C)) return false;
+		if (konst) FloatOpK(0x0F10, XMM1, C);
+		else LoadF(XMM1, C);
+		for (int i = 0; i < ((pc->op == OP_MULVF2_RR || pc->op == OP_MULVF2_RK) ? 2 : 3); i++)
+		{
+			LoadF(XMM0, B + i);
+			OpR(0xF2, false, 0x0F59, XMM0, XMM1);
+			StoreF(a + i, XMM0);
+		}
+		return true;
+	}
+
+	// Pointers
+	case OP_ADDA_RR: case OP_ADDA_RK:
+	{
+		if (pc->op == OP_ADDA_RK && !KonstD(C)) return false;
+		LoadA(RAX, B);
+		OpR(0, true, 0x85, RAX, RAX);
+		unsigned isnull = JccLocal(CC_E);
+		if (pc->op == OP_ADDA_RK)
+		{
+			OpRI(true, 0, RAX, Func->KonstD[C]);
+		}
+		else
+		{
+			OpM(0, true, 0x63, RCX, RBX, C * 4);
+			OpR(0, true, 0x03, RAX, RCX);
+		}
+		BindLocal(isnull);
+		StoreA(a, RAX);
+		return true;
+	}
+	case OP_SUBA:
+		LoadA(RAX, B);
+		OpM(0, true, 0x2B, RAX, R13, C * 8);
+		StoreD(a, RAX);
+		return true;
+	case OP_EQA_R: case OP_EQA_K:
+		if (pc->op == OP_EQA_K && !KonstA(C)) return false;
+		LoadA(RAX, B);
+		if (pc->op == OP_EQA_K)
+		{
+			MovRI64(RCX, Func->KonstA[C].v);
+			OpR(0, true, 0x3B, RAX, RCX);
+		}
+		else
+		{
+			OpM(0, true, 0x3B, RAX, R13, C * 8);
+		}
+		if (!EmitCompare(index, CC_E))
+		{
+			Code.Resize(Labels[index]);
+			return false;
+		}
+		return true;
+
+	// Conversions
+	case OP_CAST:
+		if (C == CAST_I2F)
+		{
+			OpM(0xF2, false, 0x0F2A, XMM0, RBX, B * 4);		// cvtsi2sd
+			StoreF(a, XMM0);
+			return true;
+		}
+		else if (C == CAST_F2I)
+		{
+			OpM(0xF2, false, 0x0F2C, RAX, R12, B * 8);		// cvttsd2si
+			StoreD(a, RAX);
+			return true;
+		}
+		return false;
+	case OP_CASTB:
+		if (C == CASTB_I)
+		{
+			OpM(0, false, 0x83, 7, RBX, B * 4);	// cmp dword [d + B], 0
+			Byte(0);
+		}
+		else if (C == CASTB_A)
+		{
+			OpM(0, true, 0x83, 7, R13, B * 8);
+			Byte(0);
+		}
+		else if (C == CASTB_F)
+		{
+			OpR(0x66, false, 0x0F57, XMM0, XMM0);
+			OpM(0x66, false, 0x0F2E, XMM0, R12, B * 8);
+			OpR(0, false, 0x0F9A, 0, RAX);		// setp al
+			OpR(0, false, 0x0F95, 0, RCX);		// setne cl
+			OpR(0, false, 0x0B, RCX, RAX);		// or ecx, eax
+			OpR(0, false, 0x0FB6, RCX, RCX);
+			StoreD(a, RCX);
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+		OpR(0, false, 0x0F95, 0, RCX);
+		OpR(0, false, 0x0FB6, RCX, RCX);
+		StoreD(a, RCX);
+		return true;
+
+	// Control flow
+	case OP_TEST:
+	case OP_TESTN:
+		if (!JumpTarget(index + 2)) return false;
+		LoadD(RAX, a);
+		if (pc->op == OP_TESTN) OpR(0, false, 0xF7, 3, RAX);
+		OpRI(false, 7, RAX, pc->i16u);
+		Jcc(CC_NE, index + 2);
+		return true;
+	case OP_JMP:
+		if (!JumpTarget(index + 1 + pc->i24)) return false;
+		Jmp(index + 1 + pc->i24);
+		return true;
+
+	case OP_RET:
+		if (!EmitRet(pc))
+		{
+			Code.Resize(Labels[index]);
+			return false;
+		}
+		break;
+	case OP_RETI:
+		OpRI(false, 7, R15, a & ~RET_FINAL);
+		{
+			unsigned skip = JccLocal(CC_LE);
+			OpM(0, true, 0x8B, RCX, R14, int32_t((a & ~RET_FINAL) * sizeof(VMReturn) + offsetof(VMReturn, Location)));
+			MovMI(false, RCX, 0, pc->i16);
+			BindLocal(skip);
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	// RET and RETI end up here.
+	if (a & RET_FINAL)
+	{
+		// return min(retnum + 1, numret)
+		MovRI(RAX, (a & ~RET_FINAL) + 1);
+		OpR(0, false, 0x3B, RAX, R15);
+		OpR(0, false, 0x0F4F, RAX, R15);	// cmovg eax, r15d
+		Jmp(TARGET_EXIT);
+	}
+	return true;
+}
+
+//==========================================================================
+//
+// FJitCompiler :: Compile
+//
+//==========================================================================
+
+bool FJitCompiler::Compile()
+{
+	// Saves rbx, r12-r15. All other used registers are volatile in both ABIs.
+	Byte(0x53);
+	Byte(0x41); Byte(0x54);
+	Byte(0x41); Byte(0x55);
+	Byte(0x41); Byte(0x56);
+	Byte(0x41); Byte(0x57);
+#ifdef _WIN32
+	OpR(0, true, 0x8B, RBX, RCX);
+	OpR(0, true, 0x8B, R12, RDX);
+	OpR(0, true, 0x8B, R13, R8);
+	OpR(0, true, 0x8B, R14, R9);
+	OpM(0, false, 0x8B, R15, RSP, 80);	// 5 pushes + return address + shadow space
+#else
+	OpR(0, true, 0x8B, RBX, RDI);
+	OpR(0, true, 0x8B, R12, RSI);
+	OpR(0, true, 0x8B, R13, RDX);
+	OpR(0, true, 0x8B, R14, RCX);
+	OpR(0, false, 0x8B, R15, R8);
+#endif
+
+	Labels.Resize(Func->CodeSize);
+	for (int i = 0; i < Func->CodeSize; i++)
+	{
+		Labels[i] = Code.Size();
+		if (EmitInstruction(i))
+		{
+			NativeCount++;
+		}
+		else
+		{
+			// There's no point in entering native code just to leave it again.
+			if (i == 0) return false;
+			Bail(i);
+		}
+	}
+	// Code never falls off the end but in case it does, let the interpreter have it.
+	Bail(Func->CodeSize - 1);
+
+	unsigned exitlabel = Code.Size();
+	Byte(0x41); Byte(0x5F);
+	Byte(0x41); Byte(0x5E);
+	Byte(0x41); Byte(0x5D);
+	Byte(0x41); Byte(0x5C);
+	Byte(0x5B);
+	Byte(0xC3);
+
+	// Out of line bailouts for failed null pointer and division checks.
+	TMap<int, unsigned> bailstubs;
+	for (unsigned i = 0; i < Fixups.Size(); i++)
+	{
+		int target = Fixups[i].Target;
+		unsigned dest;
+		if (target >= 0)
+		{
+			dest = Labels[target];
+		}
+		else if (target == TARGET_EXIT)
+		{
+			dest = exitlabel;
+		}
+		else
+		{
+			unsigned *stub = bailstubs.CheckKey(target);
+			if (stub == nullptr)
+			{
+				stub = &bailstubs[target];
+				*stub = Code.Size();
+				MovRI(RAX, -(TARGET_BAIL - target + 1));
+				Byte(0xE9);
+				Dword(int32_t(exitlabel - (Code.Size() + 4)));
+			}
+			dest = *stub;
+		}
+		int32_t rel = int32_t(dest - (Fixups[i].Pos + 4));
+		memcpy(&Code[Fixups[i].Pos], &rel, 4);
+	}
+	return true;
+}
+
+#endif
+
+//==========================================================================
+//
+// VMJitCompile
+//
+// Generates native code for a script function. Functions that cannot be
+// compiled simply keep running in the interpreter.
+//
+//==========================================================================
+
+bool VMJitCompile(VMScriptFunction *func)
+{
+	func->JitFunc = nullptr;
+#ifdef VM_JIT_X64
+	if (!vm_jit || func->Code == nullptr || func->CodeSize <= 0)
+	{
+		return false;
+	}
+	FJitCompiler compiler(func);
+	if (!compiler.Compile())
+	{
+		return false;
+	}
+	func->JitFunc = (VMJitFunc)JitMemory.Commit(&compiler.Code[0], compiler.Code.Size());
+	if (func->JitFunc == nullptr)
+	{
+		return false;
+	}
+	JitFunctions++;
+	JitInstructions += func->CodeSize;
+	JitNativeInstructions += compiler.NativeCount;
+	return true;
+#else
+	return false;
+#endif
+}
+
+ADD_STAT(vmjit)
+{
+	return FStringf("%d functions compiled, %d of %d instructions native", JitFunctions, JitNativeInstructions, JitInstructions);
+}
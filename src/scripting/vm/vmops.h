@@ -255,4 +255,13 @@ xx(SUBA,		sub,	RIRPRP,		NOP,	0, 0),		// dA = pB - pC
 xx(EQA_R,		beq,	CPRR,		NOP,	0, 0),			// if ((pB == pkC) != A) then pc++
 xx(EQA_K,		beq,	CPRK,		EQA_R,	4, REGT_POINTER),
 
+// Superinstructions. These are only created by VMFunctionBuilder's peephole pass, which
+// keeps the fused instructions in place behind them so that jumps into the sequence and
+// the line information stay valid.
+xx(LBIT_EQK,	lbit_beq,	RIRPI8,	NOP,	0, 0),		// LBIT, followed by EQ_K on its result and JMP
+xx(LW_EQK,		lw_beq,		RIRPKI,	NOP,	0, 0),		// LW, followed by EQ_K on its result and JMP
+xx(LO_EQAK,		lo_beq,		RPRPKI,	NOP,	0, 0),		// LO, followed by EQA_K on its result and JMP
+xx(LP_EQAK,		lp_beq,		RPRPKI,	NOP,	0, 0),		// LP, followed by EQA_K on its result and JMP
+xx(PARAM2,		param2,		__BCP,	NOP,	0, 0),		// PARAM, followed by another PARAM
+
 #undef xx
@@ -240,7 +240,7 @@ public:
 void I_InitSound ()
 {
 	/* Get command line options: */
-	nosound = !!Args->CheckParm ("-nosound");
+	nosound = !!Args->CheckParm ("-nosound") || !!Args->CheckParm ("-fastdemo");
 	nosfx = !!Args->CheckParm ("-nosfx");
 
 	GSnd = NULL;
@@ -40,6 +40,7 @@
 #include "m_swap.h"
 #include "w_wad.h"
 #include "v_text.h"
+#include "stats.h"
 #include "timidity/timidity.h"
 #include <errno.h>
 
@@ -334,20 +335,38 @@ TimidityWaveWriterMIDIDevice::~TimidityWaveWriterMIDIDevice()
 //
 // TimidityWaveWriterMIDIDevice :: Resume
 //
+// Renders the whole song and reports how much faster than real time the
+// synthesis ran. Writing the file is not included in the time.
+//
 //==========================================================================
 
 int TimidityWaveWriterMIDIDevice::Resume()
 {
 	float writebuffer[4096];
+	cycle_t rendertime;
+	size_t written = 0;
 
-	while (ServiceStream(writebuffer, sizeof(writebuffer)))
+	rendertime.Reset();
+	for (;;)
 	{
+		rendertime.Clock();
+		bool more = ServiceStream(writebuffer, sizeof(writebuffer));
+		rendertime.Unclock();
+		if (!more)
+		{
+			break;
+		}
 		if (File->Write(writebuffer, sizeof(writebuffer)) != sizeof(writebuffer))
 		{
 			Printf("Could not write entire wave file: %s\n", strerror(errno));
 			return 1;
 		}
+		written += sizeof(writebuffer);
 	}
+
+	double songtime = written / (Renderer->rate * 2 * sizeof(float));
+	double ms = rendertime.TimeMS();
+	Printf("Rendered %.1f s of audio in %.1f ms (%.1fx real time)\n", songtime, ms, ms > 0 ? songtime * 1000 / ms : 0.);
 	return 0;
 }
 
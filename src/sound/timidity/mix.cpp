@@ -24,6 +24,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef NO_SSE
+#include <xmmintrin.h>
+#endif
 
 #include "timidity.h"
 #include "templates.h"
@@ -426,52 +429,121 @@ static int update_signal(Voice *v)
 	return 0;
 }
 
-static void mix_mystery_signal(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
+/* The block mixers below add count samples at a constant volume. The SSE
+   versions do four samples per iteration with the same math as the plain
+   loops, so the output does not change. */
+
+static void mix_mystery(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
 {
 	final_volume_t 
 		left = v->left_mix, 
 		right = v->right_mix;
-	int cc;
 	sample_t s;
 
+#ifndef NO_SSE
+	const __m128 lr = _mm_setr_ps(left, right, left, right);
+	for (; count >= 4; count -= 4)
+	{
+		__m128 s4 = _mm_loadu_ps(sp);
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_mul_ps(_mm_unpacklo_ps(s4, s4), lr)));
+		_mm_storeu_ps(lp + 4, _mm_add_ps(_mm_loadu_ps(lp + 4), _mm_mul_ps(_mm_unpackhi_ps(s4, s4), lr)));
+		sp += 4;
+		lp += 8;
+	}
+#endif
+	while (count--)
+	{
+		s = *sp++;
+		lp[0] += s * left;
+		lp[1] += s * right;
+		lp += 2;
+	}
+}
+
+static void mix_single(const sample_t *sp, float *lp, final_volume_t amp, int count)
+{
+#ifndef NO_SSE
+	/* The other channel gets 0 added. For the right channel, the last vector
+	   would touch the float past the end, so always leave the last samples
+	   to the plain loop. */
+	const __m128 amp4 = _mm_set1_ps(amp);
+	const __m128 zero = _mm_setzero_ps();
+	for (; count > 4; count -= 4)
+	{
+		__m128 s4 = _mm_mul_ps(_mm_loadu_ps(sp), amp4);
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_unpacklo_ps(s4, zero)));
+		_mm_storeu_ps(lp + 4, _mm_add_ps(_mm_loadu_ps(lp + 4), _mm_unpackhi_ps(s4, zero)));
+		sp += 4;
+		lp += 8;
+	}
+#endif
+	while (count--)
+	{
+		lp[0] += *sp++ * amp;
+		lp += 2;
+	}
+}
+
+static void mix_single_left(const sample_t *sp, float *lp, Voice *v, int count)
+{
+	mix_single(sp, lp, v->left_mix, count);
+}
+static void mix_single_right(const sample_t *sp, float *lp, Voice *v, int count)
+{
+	mix_single(sp, lp + 1, v->right_mix, count);
+}
+
+static void mix_mono(const sample_t *sp, float *lp, Voice *v, int count)
+{
+	final_volume_t 
+		left = v->left_mix;
+
+#ifndef NO_SSE
+	const __m128 left4 = _mm_set1_ps(left);
+	for (; count >= 4; count -= 4)
+	{
+		_mm_storeu_ps(lp, _mm_add_ps(_mm_loadu_ps(lp), _mm_mul_ps(_mm_loadu_ps(sp), left4)));
+		sp += 4;
+		lp += 4;
+	}
+#endif
+	while (count--)
+	{
+		*lp++ += *sp++ * left;
+	}
+}
+
+/* The envelope and tremolo are only updated every control_ratio samples.
+   The signal mixers hand each stretch between two updates to the block
+   mixers above. */
+
+static void mix_mystery_signal(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
+{
+	int cc;
+
 	if (!(cc = v->control_counter))
 	{
 		cc = control_ratio;
 		if (update_signal(v))
 			return;	/* Envelope ran out */
-
-		left = v->left_mix;
-		right = v->right_mix;
 	}
 
 	while (count)
 	{
 		if (cc < count)
 		{
+			mix_mystery(control_ratio, sp, lp, v, cc);
+			sp += cc;
+			lp += cc * 2;
 			count -= cc;
-			while (cc--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
-			left = v->left_mix;
-			right = v->right_mix;
 		}
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				s = *sp++;
-				lp[0] += left * s;
-				lp[1] += right * s;
-				lp += 2;
-			}
+			mix_mystery(control_ratio, sp, lp, v, count);
 			return;
 		}
 	}
@@ -479,7 +551,6 @@ static void mix_mystery_signal(int32_t control_ratio, const sample_t *sp, float
 
 static void mix_single_signal(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, float *ampat, int count)
 {
-	final_volume_t amp;
 	int cc;
 
 	if (0 == (cc = v->control_counter))
@@ -488,31 +559,23 @@ static void mix_single_signal(int32_t control_ratio, const sample_t *sp, float *
 		if (update_signal(v))
 			return;		/* Envelope ran out */
 	}
-	amp = *ampat;
 
 	while (count)
 	{
 		if (cc < count)
 		{
+			mix_single(sp, lp, *ampat, cc);
+			sp += cc;
+			lp += cc * 2;
 			count -= cc;
-			while (cc--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
-			amp = *ampat;
 		}
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				lp[0] += *sp++ * amp;
-				lp += 2;
-			}
+			mix_single(sp, lp, *ampat, count);
 			return;
 		}
 	}
@@ -530,8 +593,6 @@ static void mix_single_right_signal(int32_t control_ratio, const sample_t *sp, f
 
 static void mix_mono_signal(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
 {
-	final_volume_t 
-		left = v->left_mix;
 	int cc;
 
 	if (!(cc = v->control_counter))
@@ -539,80 +600,29 @@ static void mix_mono_signal(int32_t control_ratio, const sample_t *sp, float *lp
 		cc = control_ratio;
 		if (update_signal(v))
 			return;	/* Envelope ran out */
-		left = v->left_mix;
 	}
 
 	while (count)
 	{
 		if (cc < count)
 		{
+			mix_mono(sp, lp, v, cc);
+			sp += cc;
+			lp += cc;
 			count -= cc;
-			while (cc--)
-			{
-				*lp++ += *sp++ * left;
-			}
 			cc = control_ratio;
 			if (update_signal(v))
 				return;	/* Envelope ran out */
-			left = v->left_mix;
 		}
 		else
 		{
 			v->control_counter = cc - count;
-			while (count--)
-			{
-				*lp++ += *sp++ * left;
-			}
+			mix_mono(sp, lp, v, count);
 			return;
 		}
 	}
 }
 
-static void mix_mystery(int32_t control_ratio, const sample_t *sp, float *lp, Voice *v, int count)
-{
-	final_volume_t 
-		left = v->left_mix, 
-		right = v->right_mix;
-	sample_t s;
-
-	while (count--)
-	{
-		s = *sp++;
-		lp[0] += s * left;
-		lp[1] += s * right;
-		lp += 2;
-	}
-}
-
-static void mix_single(const sample_t *sp, float *lp, final_volume_t amp, int count)
-{
-	while (count--)
-	{
-		lp[0] += *sp++ * amp;
-		lp += 2;
-	}
-}
-
-static void mix_single_left(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single(sp, lp, v->left_mix, count);
-}
-static void mix_single_right(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	mix_single(sp, lp + 1, v->right_mix, count);
-}
-
-static void mix_mono(const sample_t *sp, float *lp, Voice *v, int count)
-{
-	final_volume_t 
-		left = v->left_mix;
-
-	while (count--)
-	{
-		*lp++ += *sp++ * left;
-	}
-}
-
 /* Ramp a note out in c samples */
 static void ramp_out(const sample_t *sp, float *lp, Voice *v, int c)
 {
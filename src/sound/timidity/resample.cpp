@@ -24,6 +24,9 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#ifndef NO_SSE
+#include <emmintrin.h>
+#endif
 
 #include "timidity.h"
 #include "c_cvars.h"
@@ -39,6 +42,43 @@ namespace Timidity
 #define FINALINTERP if (ofs == le) *dest++ = src[ofs >> FRACTION_BITS];
 /* So it isn't interpolation. At least it's final. */
 
+/* Does RESAMPLATION count times, advancing ofs by incr each time. The SSE2
+   version produces four samples per iteration. It reads the same source
+   samples and does the same math in the same order, so the output is
+   identical. */
+static sample_t *resample_linear(sample_t *dest, const sample_t *src, int &ofs, int incr, int count)
+{
+#ifndef NO_SSE
+	if (count >= 4)
+	{
+		const __m128i fracmask = _mm_set1_epi32(FRACTION_MASK);
+		const __m128i incr4 = _mm_set1_epi32(incr * 4);
+		const __m128 scale = _mm_set1_ps(1.f / (1 << FRACTION_BITS));
+		__m128i ofs4 = _mm_setr_epi32(ofs, ofs + incr, ofs + incr * 2, ofs + incr * 3);
+		int o[4];
+
+		for (int n = count >> 2; n > 0; --n)
+		{
+			_mm_storeu_si128((__m128i *)o, _mm_srai_epi32(ofs4, FRACTION_BITS));
+			__m128 s1 = _mm_setr_ps(src[o[0]], src[o[1]], src[o[2]], src[o[3]]);
+			__m128 s2 = _mm_setr_ps(src[o[0] + 1], src[o[1] + 1], src[o[2] + 1], src[o[3] + 1]);
+			__m128 m = _mm_cvtepi32_ps(_mm_and_si128(ofs4, fracmask));
+			_mm_storeu_ps(dest, _mm_add_ps(s1, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(s2, s1), m), scale)));
+			ofs4 = _mm_add_epi32(ofs4, incr4);
+			dest += 4;
+		}
+		ofs += (count & ~3) * incr;
+		count &= 3;
+	}
+#endif
+	while (count--)
+	{
+		RESAMPLATION;
+		ofs += incr;
+	}
+	return dest;
+}
+
 /*************** resampling with fixed increment *****************/
 
 static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
@@ -73,11 +113,7 @@ static sample_t *rs_plain(sample_t *resample_buffer, Voice *v, int *countptr)
 		count -= i;
 	}
 
-	while (i--) 
-	{
-		RESAMPLATION;
-		ofs += incr;
-	}
+	dest = resample_linear(dest, src, ofs, incr, i);
 
 	if (ofs >= le) 
 	{
@@ -122,11 +158,7 @@ static sample_t *rs_loop(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 	}
 
 	vp->sample_offset=ofs; /* Update offset */
@@ -166,11 +198,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 	}
 
 	/* Then do the bidirectional looping */
@@ -188,11 +216,7 @@ static sample_t *rs_bidir(sample_t *resample_buffer, Voice *vp, int count)
 		{
 			count -= i;
 		}
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 		if (ofs >= le) 
 		{
 			/* fold the overshoot back in */
@@ -293,20 +317,37 @@ static sample_t *rs_vib_plain(sample_t *resample_buffer, float rate, Voice *vp,
 		count = *countptr;
 	int 
 		cc = vp->vibrato_control_counter;
+	int
+		i, toend;
+	bool
+		vibflag;
 
 	/* This has never been tested */
 
 	if (incr < 0) incr = -incr; /* In case we're coming out of a bidir loop */
 
-	while (count--)
+	while (count)
 	{
-		if (!cc--)
+		/* The sample that updates the vibrato does not count down cc */
+		vibflag = (cc == 0);
+		if (vibflag)
 		{
 			cc = vp->vibrato_control_ratio;
 			incr = update_vibrato(rate, vp, 0);
+			i = 1;
 		}
-		RESAMPLATION;
-		ofs += incr;
+		else
+		{
+			i = cc < count ? cc : count;
+		}
+		/* Stop right after the sample that reaches the end */
+		toend = ofs < le ? (le - ofs + incr - 1) / incr : 1;
+		if (i > toend)
+			i = toend;
+		if (!vibflag)
+			cc -= i;
+		count -= i;
+		dest = resample_linear(dest, src, ofs, incr, i);
 		if (ofs >= le)
 		{
 			FINALINTERP;
@@ -361,11 +402,7 @@ static sample_t *rs_vib_loop(sample_t *resample_buffer, float rate, Voice *vp, i
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -419,11 +456,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
@@ -452,11 +485,7 @@ static sample_t *rs_vib_bidir(sample_t *resample_buffer, float rate, Voice *vp,
 			cc -= i;
 		}
 		count -= i;
-		while (i--) 
-		{
-			RESAMPLATION;
-			ofs += incr;
-		}
+		dest = resample_linear(dest, src, ofs, incr, i);
 		if (vibflag) 
 		{
 			cc = vp->vibrato_control_ratio;
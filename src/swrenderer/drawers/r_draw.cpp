@@ -264,6 +264,7 @@ namespace swrenderer
 		}
 
 		FString DebugInfo() override { return "DepthColumnCommand"; }
+		bool LineRange(int &first_line, int &cnt) override { first_line = y; cnt = count; return true; }
 
 		void Execute(DrawerThread *thread) override
 		{
@@ -300,10 +301,11 @@ namespace swrenderer
 		}
 
 		FString DebugInfo() override { return "DepthSpanCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = y; count = 1; return true; }
 
 		void Execute(DrawerThread *thread) override
 		{
-			if (thread->skipped_by_thread(y))
+			if (thread->line_skipped_by_thread(y))
 				return;
 
 			auto zbuffer = PolyZBuffer::Instance();
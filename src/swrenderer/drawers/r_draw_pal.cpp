@@ -43,6 +43,7 @@
 #include "r_draw.h"
 #include "v_video.h"
 #include "r_draw_pal.h"
+#include "r_draw_pal_avx2.h"
 #include "swrenderer/viewport/r_viewport.h"
 #include "swrenderer/scene/r_light.h"
 
@@ -559,6 +560,9 @@ namespace swrenderer
 		int32_t frac = args.TextureVPos();
 		int32_t fracstep = args.TextureVStep();
 
+		// Lines past the end of the pass belong to another thread
+		count = MIN(count, thread->pass_end_y - args.DestY());
+
 		// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
 		int start_fade = 2; // How fast it should fade out
 		int fade_length = (1 << (24 - start_fade));
@@ -695,6 +699,9 @@ namespace swrenderer
 		int32_t frac = args.TextureVPos();
 		int32_t fracstep = args.TextureVStep();
 
+		// Lines past the end of the pass belong to another thread
+		count = MIN(count, thread->pass_end_y - args.DestY());
+
 		// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
 		int start_fade = 2; // How fast it should fade out
 		int fade_length = (1 << (24 - start_fade));
@@ -3167,4 +3174,69 @@ namespace swrenderer
 	{
 		return "DrawVoxelBlocks";
 	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	void SWPalDrawers::DrawWallAddColumn(const WallDrawerArgs &args)
+	{
+		if (args.dc_num_lights == 0)
+			PushDrawer<DrawWallAdd1PalCommand, DrawWallAdd1PalAVX2Command>(Queue, args);
+		else
+			PushDrawer<DrawWallAddClamp1PalCommand, DrawWallAddClamp1PalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawWallAddClampColumn(const WallDrawerArgs &args)
+	{
+		PushDrawer<DrawWallAddClamp1PalCommand, DrawWallAddClamp1PalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawAddColumn(const SpriteDrawerArgs &args)
+	{
+		PushDrawer<DrawColumnAddPalCommand, DrawColumnAddPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawTranslatedAddColumn(const SpriteDrawerArgs &args)
+	{
+		PushDrawer<DrawColumnTlatedAddPalCommand, DrawColumnTlatedAddPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawAddClampColumn(const SpriteDrawerArgs &args)
+	{
+		PushDrawer<DrawColumnAddClampPalCommand, DrawColumnAddClampPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args)
+	{
+		PushDrawer<DrawColumnAddClampTranslatedPalCommand, DrawColumnAddClampTranslatedPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpan(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanPalCommand, DrawSpanPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpanMasked(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanMaskedPalCommand, DrawSpanMaskedPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpanTranslucent(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanTranslucentPalCommand, DrawSpanTranslucentPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanMaskedTranslucentPalCommand, DrawSpanMaskedTranslucentPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpanAddClamp(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanAddClampPalCommand, DrawSpanAddClampPalAVX2Command>(Queue, args);
+	}
+
+	void SWPalDrawers::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
+	{
+		PushDrawer<DrawSpanMaskedAddClampPalCommand, DrawSpanMaskedAddClampPalAVX2Command>(Queue, args);
+	}
 }
@@ -16,6 +16,7 @@ namespace swrenderer
 	public:
 		PalWall1Command(const WallDrawerArgs &args);
 		FString DebugInfo() override { return "PalWallCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
 
 	protected:
 		inline static uint8_t AddLights(const DrawerLight *lights, int num_lights, float viewpos_z, uint8_t fg, uint8_t material);
@@ -35,6 +36,7 @@ namespace swrenderer
 	public:
 		PalSkyCommand(const SkyDrawerArgs &args);
 		FString DebugInfo() override { return "PalSkyCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
 
 	protected:
 		SkyDrawerArgs args;
@@ -48,6 +50,7 @@ namespace swrenderer
 	public:
 		PalColumnCommand(const SpriteDrawerArgs &args);
 		FString DebugInfo() override { return "PalColumnCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
 
 		SpriteDrawerArgs args;
 
@@ -79,6 +82,7 @@ namespace swrenderer
 		DrawFuzzColumnPalCommand(const SpriteDrawerArgs &args);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override { return "DrawFuzzColumnPalCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = _yl; count = _yh - _yl + 1; return true; }
 
 	private:
 		int _yl;
@@ -96,6 +100,7 @@ namespace swrenderer
 		DrawScaledFuzzColumnPalCommand(const SpriteDrawerArgs &drawerargs);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override { return "DrawScaledFuzzColumnPalCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = _yl; count = _yh - _yl + 1; return true; }
 
 	private:
 		int _x;
@@ -112,6 +117,7 @@ namespace swrenderer
 	public:
 		PalSpanCommand(const SpanDrawerArgs &args);
 		FString DebugInfo() override { return "PalSpanCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = _y; count = 1; return true; }
 
 	protected:
 		inline static uint8_t AddLights(const DrawerLight *lights, int num_lights, float viewpos_x, uint8_t fg, uint8_t material);
@@ -153,6 +159,7 @@ namespace swrenderer
 		DrawTiltedSpanPalCommand(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override { return "DrawTiltedSpanPalCommand"; }
+		bool LineRange(int &first_line, int &count) override { first_line = y; count = 1; return true; }
 
 	private:
 		void CalcTiltedLighting(double lval, double lend, int width, DrawerThread *thread);
@@ -211,6 +218,7 @@ namespace swrenderer
 		DrawParticleColumnPalCommand(uint8_t *dest, int dest_y, int pitch, int count, uint32_t fg, uint32_t alpha, uint32_t fracposx);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _dest_y; count = _count; return true; }
 
 	private:
 		uint8_t *_dest;
@@ -243,15 +251,8 @@ namespace swrenderer
 		void DrawWallColumn(const WallDrawerArgs &args) override { Queue->Push<DrawWall1PalCommand>(args); }
 		void DrawWallMaskedColumn(const WallDrawerArgs &args) override { Queue->Push<DrawWallMasked1PalCommand>(args); }
 
-		void DrawWallAddColumn(const WallDrawerArgs &args) override
-		{
-			if (args.dc_num_lights == 0)
-				Queue->Push<DrawWallAdd1PalCommand>(args);
-			else
-				Queue->Push<DrawWallAddClamp1PalCommand>(args);
-		}
-
-		void DrawWallAddClampColumn(const WallDrawerArgs &args) override { Queue->Push<DrawWallAddClamp1PalCommand>(args); }
+		void DrawWallAddColumn(const WallDrawerArgs &args) override;
+		void DrawWallAddClampColumn(const WallDrawerArgs &args) override;
 		void DrawWallSubClampColumn(const WallDrawerArgs &args) override { Queue->Push<DrawWallSubClamp1PalCommand>(args); }
 		void DrawWallRevSubClampColumn(const WallDrawerArgs &args) override { Queue->Push<DrawWallRevSubClamp1PalCommand>(args); }
 		void DrawSingleSkyColumn(const SkyDrawerArgs &args) override { Queue->Push<DrawSingleSky1PalCommand>(args); }
@@ -270,24 +271,24 @@ namespace swrenderer
 				Queue->Push<DrawFuzzColumnPalCommand>(args);
 			R_UpdateFuzzPos(args);
 		}
-		void DrawAddColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnAddPalCommand>(args); }
+		void DrawAddColumn(const SpriteDrawerArgs &args) override;
 		void DrawTranslatedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnTranslatedPalCommand>(args); }
-		void DrawTranslatedAddColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnTlatedAddPalCommand>(args); }
+		void DrawTranslatedAddColumn(const SpriteDrawerArgs &args) override;
 		void DrawShadedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnShadedPalCommand>(args); }
 		void DrawAddClampShadedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnAddClampShadedPalCommand>(args); }
-		void DrawAddClampColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnAddClampPalCommand>(args); }
-		void DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnAddClampTranslatedPalCommand>(args); }
+		void DrawAddClampColumn(const SpriteDrawerArgs &args) override;
+		void DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args) override;
 		void DrawSubClampColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnSubClampPalCommand>(args); }
 		void DrawSubClampTranslatedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnSubClampTranslatedPalCommand>(args); }
 		void DrawRevSubClampColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnRevSubClampPalCommand>(args); }
 		void DrawRevSubClampTranslatedColumn(const SpriteDrawerArgs &args) override { Queue->Push<DrawColumnRevSubClampTranslatedPalCommand>(args); }
 		void DrawVoxelBlocks(const SpriteDrawerArgs &args, const VoxelBlock *blocks, int blockcount) override { Queue->Push<DrawVoxelBlocksPalCommand>(args, blocks, blockcount); }
-		void DrawSpan(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanPalCommand>(args); }
-		void DrawSpanMasked(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanMaskedPalCommand>(args); }
-		void DrawSpanTranslucent(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanTranslucentPalCommand>(args); }
-		void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanMaskedTranslucentPalCommand>(args); }
-		void DrawSpanAddClamp(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanAddClampPalCommand>(args); }
-		void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) override { Queue->Push<DrawSpanMaskedAddClampPalCommand>(args); }
+		void DrawSpan(const SpanDrawerArgs &args) override;
+		void DrawSpanMasked(const SpanDrawerArgs &args) override;
+		void DrawSpanTranslucent(const SpanDrawerArgs &args) override;
+		void DrawSpanMaskedTranslucent(const SpanDrawerArgs &args) override;
+		void DrawSpanAddClamp(const SpanDrawerArgs &args) override;
+		void DrawSpanMaskedAddClamp(const SpanDrawerArgs &args) override;
 		void FillSpan(const SpanDrawerArgs &args) override { Queue->Push<FillSpanPalCommand>(args); }
 
 		void DrawTiltedSpan(const SpanDrawerArgs &args, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy, FDynamicColormap *basecolormap) override
@@ -0,0 +1,406 @@
+/*
+**  AVX2 drawer commands for the paletted software renderer
+**  Copyright (c) 2018 GZDoom maintainers
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+// Nothing in here may run before CPU.bAVX2 has been checked. AVX2 code generation is
+// only enabled after the includes, see r_draw_rgba_avx2.cpp.
+//
+// The output is identical to the scalar drawers in r_draw_pal.cpp. All lookup tables are
+// read with 32-bit gathers of the aligned dword containing the wanted byte, so no gather
+// reads past the end of a table whose size is a multiple of four.
+
+#ifndef NO_SSE
+
+#include <string.h>
+#include "templates.h"
+#include "doomdef.h"
+#include "v_video.h"
+#include "r_draw_rgba.h"
+#include "r_draw_pal_avx2.h"
+#include "swrenderer/viewport/r_viewport.h"
+#include <immintrin.h>
+
+EXTERN_CVAR(Bool, r_blendmethod)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace swrenderer
+{
+	namespace
+	{
+		enum class PalBlend { Opaque, Add, AddClamp };
+
+		FORCEINLINE __m256i Index8()
+		{
+			return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		}
+
+		// table[index] for eight indices
+		FORCEINLINE __m256i GatherBytes(const uint8_t *table, __m256i index)
+		{
+			__m256i dwords = _mm256_i32gather_epi32((const int *)table, _mm256_andnot_si256(_mm256_set1_epi32(3), index), 1);
+			__m256i shift = _mm256_slli_epi32(_mm256_and_si256(index, _mm256_set1_epi32(3)), 3);
+			return _mm256_and_si256(_mm256_srlv_epi32(dwords, shift), _mm256_set1_epi32(0xff));
+		}
+
+		FORCEINLINE __m256i LoadBytes(const uint8_t *src, int n)
+		{
+			if (n == 8)
+				return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+
+			uint8_t tmp[8] = { 0 };
+			memcpy(tmp, src, n);
+			return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)tmp));
+		}
+
+		FORCEINLINE void StoreBytes(uint8_t *dest, __m256i v, int n)
+		{
+			__m256i shuffle = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+			v = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(v, shuffle), _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1));
+			if (n == 8)
+			{
+				_mm_storel_epi64((__m128i *)dest, _mm256_castsi256_si128(v));
+			}
+			else
+			{
+				uint8_t tmp[8];
+				_mm_storel_epi64((__m128i *)tmp, _mm256_castsi256_si128(v));
+				memcpy(dest, tmp, n);
+			}
+		}
+
+		FORCEINLINE __m256i LoadColumn(const uint8_t *src, int pitch, int n)
+		{
+			int values[8] = { 0 };
+			for (int i = 0; i < n; i++)
+				values[i] = src[i * pitch];
+			return _mm256_loadu_si256((const __m256i *)values);
+		}
+
+		FORCEINLINE void StoreColumn(uint8_t *dest, int pitch, __m256i v, int n)
+		{
+			int values[8];
+			_mm256_storeu_si256((__m256i *)values, v);
+			for (int i = 0; i < n; i++)
+				dest[i * pitch] = values[i];
+		}
+
+		// Blends the palette colors fg and bg through the RGB32k table like the scalar drawers do
+		template<PalBlend Blend>
+		FORCEINLINE __m256i BlendColors(__m256i fg, __m256i bg, const uint32_t *fg2rgb, const uint32_t *bg2rgb)
+		{
+			__m256i a = _mm256_add_epi32(_mm256_i32gather_epi32((const int *)fg2rgb, fg, 4), _mm256_i32gather_epi32((const int *)bg2rgb, bg, 4));
+			if (Blend == PalBlend::Add)
+			{
+				a = _mm256_or_si256(a, _mm256_set1_epi32(0x1f07c1f));
+			}
+			else
+			{
+				__m256i b = _mm256_and_si256(a, _mm256_set1_epi32(0x40100400));
+				a = _mm256_or_si256(a, _mm256_set1_epi32(0x01f07c1f));
+				a = _mm256_and_si256(a, _mm256_set1_epi32(0x3fffffff));
+				b = _mm256_sub_epi32(b, _mm256_srli_epi32(b, 5));
+				a = _mm256_or_si256(a, b);
+			}
+			return GatherBytes(RGB32k.All, _mm256_and_si256(a, _mm256_srli_epi32(a, 15)));
+		}
+
+		struct PalSpanParams
+		{
+			const uint8_t *source;
+			const uint8_t *colormap;
+			uint8_t *dest;
+			int count;
+			uint32_t xfrac, yfrac, xstep, ystep;
+			uint32_t srcwidth, srcheight;
+			const uint32_t *fg2rgb;
+			const uint32_t *bg2rgb;
+		};
+
+		template<PalBlend Blend, bool Masked, bool Size64x64>
+		void DrawPalSpanSized(const PalSpanParams &p)
+		{
+			__m256i xfrac = _mm256_add_epi32(_mm256_set1_epi32(p.xfrac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(p.xstep)));
+			__m256i yfrac = _mm256_add_epi32(_mm256_set1_epi32(p.yfrac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(p.ystep)));
+			__m256i xstep = _mm256_set1_epi32(p.xstep * 8);
+			__m256i ystep = _mm256_set1_epi32(p.ystep * 8);
+			__m256i srcwidth = _mm256_set1_epi32(p.srcwidth);
+			__m256i srcheight = _mm256_set1_epi32(p.srcheight);
+
+			uint8_t *dest = p.dest;
+			for (int x = 0; x < p.count; x += 8)
+			{
+				int n = MIN(p.count - x, 8);
+
+				__m256i spot;
+				if (Size64x64)
+				{
+					spot = _mm256_add_epi32(_mm256_and_si256(_mm256_srli_epi32(xfrac, 32 - 6 - 6), _mm256_set1_epi32(63 * 64)), _mm256_srli_epi32(yfrac, 32 - 6));
+				}
+				else
+				{
+					__m256i u = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(xfrac, 16), srcwidth), 16);
+					__m256i v = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(yfrac, 16), srcheight), 16);
+					spot = _mm256_add_epi32(_mm256_mullo_epi32(u, srcheight), v);
+				}
+
+				__m256i texdata = GatherBytes(p.source, spot);
+				__m256i fg = GatherBytes(p.colormap, texdata);
+
+				__m256i bg = _mm256_setzero_si256();
+				if (Blend != PalBlend::Opaque || Masked)
+					bg = LoadBytes(dest + x, n);
+
+				__m256i outcolor;
+				if (Blend == PalBlend::Opaque)
+					outcolor = fg;
+				else
+					outcolor = BlendColors<Blend>(fg, bg, p.fg2rgb, p.bg2rgb);
+
+				if (Masked)
+					outcolor = _mm256_blendv_epi8(outcolor, bg, _mm256_cmpeq_epi32(texdata, _mm256_setzero_si256()));
+
+				StoreBytes(dest + x, outcolor, n);
+
+				xfrac = _mm256_add_epi32(xfrac, xstep);
+				yfrac = _mm256_add_epi32(yfrac, ystep);
+			}
+		}
+
+		template<PalBlend Blend, bool Masked>
+		void DrawPalSpan(const PalSpanParams &p)
+		{
+			if (p.srcwidth == 64 && p.srcheight == 64)
+				DrawPalSpanSized<Blend, Masked, true>(p);
+			else
+				DrawPalSpanSized<Blend, Masked, false>(p);
+		}
+
+		struct PalColumnParams
+		{
+			const uint8_t *source;
+			const uint8_t *colormap;
+			const uint8_t *translation;
+			uint8_t *dest;
+			int count;
+			int pitch;
+			uint32_t frac, fracstep;
+			int bits;
+			const uint32_t *fg2rgb;
+			const uint32_t *bg2rgb;
+		};
+
+		// Texture reads stay scalar as the column may end anywhere in the texture.
+		// Walls are masked and use an unsigned texture position, sprite columns a signed one.
+		template<PalBlend Blend, bool Wall, bool Translated>
+		void DrawPalColumn(const PalColumnParams &p)
+		{
+			uint8_t *dest = p.dest;
+			uint32_t frac = p.frac;
+			for (int y = 0; y < p.count; y += 8)
+			{
+				int n = MIN(p.count - y, 8);
+
+				int pix[8] = { 0 };
+				for (int i = 0; i < n; i++)
+				{
+					pix[i] = Wall ? p.source[frac >> p.bits] : p.source[(int32_t)frac >> p.bits];
+					frac += p.fracstep;
+				}
+
+				__m256i texdata = _mm256_loadu_si256((const __m256i *)pix);
+				__m256i fg = Translated ? GatherBytes(p.translation, texdata) : texdata;
+				fg = GatherBytes(p.colormap, fg);
+
+				__m256i bg = LoadColumn(dest, p.pitch, n);
+				__m256i outcolor = BlendColors<Blend>(fg, bg, p.fg2rgb, p.bg2rgb);
+				if (Wall)
+					outcolor = _mm256_blendv_epi8(outcolor, bg, _mm256_cmpeq_epi32(texdata, _mm256_setzero_si256()));
+
+				StoreColumn(dest, p.pitch, outcolor, n);
+				dest += p.pitch * 8;
+			}
+		}
+
+		/////////////////////////////////////////////////////////////////////////
+
+		void DrawPalSpanOpaque(const PalSpanParams &p) { DrawPalSpan<PalBlend::Opaque, false>(p); }
+		void DrawPalSpanMasked(const PalSpanParams &p) { DrawPalSpan<PalBlend::Opaque, true>(p); }
+		void DrawPalSpanAdd(const PalSpanParams &p) { DrawPalSpan<PalBlend::Add, false>(p); }
+		void DrawPalSpanMaskedAdd(const PalSpanParams &p) { DrawPalSpan<PalBlend::Add, true>(p); }
+		void DrawPalSpanAddClamp(const PalSpanParams &p) { DrawPalSpan<PalBlend::AddClamp, false>(p); }
+		void DrawPalSpanMaskedAddClamp(const PalSpanParams &p) { DrawPalSpan<PalBlend::AddClamp, true>(p); }
+
+		void DrawPalWallAdd(const PalColumnParams &p) { DrawPalColumn<PalBlend::Add, true, false>(p); }
+		void DrawPalWallAddClamp(const PalColumnParams &p) { DrawPalColumn<PalBlend::AddClamp, true, false>(p); }
+		void DrawPalColumnAdd(const PalColumnParams &p) { DrawPalColumn<PalBlend::Add, false, false>(p); }
+		void DrawPalColumnTranslatedAdd(const PalColumnParams &p) { DrawPalColumn<PalBlend::Add, false, true>(p); }
+		void DrawPalColumnAddClamp(const PalColumnParams &p) { DrawPalColumn<PalBlend::AddClamp, false, false>(p); }
+		void DrawPalColumnTranslatedAddClamp(const PalColumnParams &p) { DrawPalColumn<PalBlend::AddClamp, false, true>(p); }
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+namespace swrenderer
+{
+	namespace
+	{
+		// Returns false if the scalar drawer has to be used
+		bool SetupPalSpan(PalSpanParams &p, int x1, int x2, uint8_t *dest, const uint8_t *source, const uint8_t *colormap, uint32_t xfrac, uint32_t yfrac, uint32_t xstep, uint32_t ystep, int srcwidth, int srcheight, const uint32_t *fg2rgb, const uint32_t *bg2rgb, int num_dynlights, bool blended)
+		{
+			if (num_dynlights != 0 || (blended && r_blendmethod) || (srcwidth * srcheight) % 4 != 0)
+				return false;
+
+			p.source = source;
+			p.colormap = colormap;
+			p.dest = dest;
+			p.count = x2 - x1 + 1;
+			p.xfrac = xfrac;
+			p.yfrac = yfrac;
+			p.xstep = xstep;
+			p.ystep = ystep;
+			p.srcwidth = srcwidth;
+			p.srcheight = srcheight;
+			p.fg2rgb = fg2rgb;
+			p.bg2rgb = bg2rgb;
+			return true;
+		}
+
+		template<typename ArgsT>
+		bool SetupPalColumn(PalColumnParams &p, DrawerThread *thread, const ArgsT &args, int bits)
+		{
+			if (r_blendmethod)
+				return false;
+
+			int count = thread->count_for_thread(args.DestY(), args.Count());
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			p.count = count;
+			p.dest = thread->dest_for_thread(args.DestY(), pitch, args.Dest());
+			p.frac = args.TextureVPos() + args.TextureVStep() * thread->skipped_by_thread(args.DestY());
+			p.fracstep = args.TextureVStep() * thread->num_cores;
+			p.pitch = pitch * thread->num_cores;
+			p.bits = bits;
+			p.source = args.TexturePixels();
+			p.colormap = args.Colormap(args.Viewport());
+			p.translation = nullptr;
+			p.fg2rgb = args.SrcBlend();
+			p.bg2rgb = args.DestBlend();
+			return true;
+		}
+	}
+
+	#define PAL_SPAN_EXECUTE(Command, Base, Kernel, blended) \
+	void Command::Execute(DrawerThread *thread) \
+	{ \
+		if (thread->line_skipped_by_thread(_y)) \
+			return; \
+		PalSpanParams p; \
+		if (SetupPalSpan(p, _x1, _x2, _dest, _source, _colormap, _xfrac, _yfrac, _xstep, _ystep, _srcwidth, _srcheight, _srcblend, _destblend, _num_dynlights, blended)) \
+			Kernel(p); \
+		else \
+			Base::Execute(thread); \
+	}
+
+	PAL_SPAN_EXECUTE(DrawSpanPalAVX2Command, DrawSpanPalCommand, DrawPalSpanOpaque, false)
+	PAL_SPAN_EXECUTE(DrawSpanMaskedPalAVX2Command, DrawSpanMaskedPalCommand, DrawPalSpanMasked, false)
+	PAL_SPAN_EXECUTE(DrawSpanTranslucentPalAVX2Command, DrawSpanTranslucentPalCommand, DrawPalSpanAdd, true)
+	PAL_SPAN_EXECUTE(DrawSpanMaskedTranslucentPalAVX2Command, DrawSpanMaskedTranslucentPalCommand, DrawPalSpanMaskedAdd, true)
+	PAL_SPAN_EXECUTE(DrawSpanAddClampPalAVX2Command, DrawSpanAddClampPalCommand, DrawPalSpanAddClamp, true)
+	PAL_SPAN_EXECUTE(DrawSpanMaskedAddClampPalAVX2Command, DrawSpanMaskedAddClampPalCommand, DrawPalSpanMaskedAddClamp, true)
+
+	#undef PAL_SPAN_EXECUTE
+
+	void DrawWallAdd1PalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (!SetupPalColumn(p, thread, args, args.TextureFracBits()))
+			DrawWallAdd1PalCommand::Execute(thread);
+		else if (p.count > 0)
+			DrawPalWallAdd(p);
+	}
+
+	void DrawWallAddClamp1PalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (args.dc_num_lights != 0 || !SetupPalColumn(p, thread, args, args.TextureFracBits()))
+			DrawWallAddClamp1PalCommand::Execute(thread);
+		else if (p.count > 0)
+			DrawPalWallAddClamp(p);
+	}
+
+	void DrawColumnAddPalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (!SetupPalColumn(p, thread, args, FRACBITS))
+			DrawColumnAddPalCommand::Execute(thread);
+		else if (p.count > 0)
+			DrawPalColumnAdd(p);
+	}
+
+	void DrawColumnTlatedAddPalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (!SetupPalColumn(p, thread, args, FRACBITS))
+		{
+			DrawColumnTlatedAddPalCommand::Execute(thread);
+		}
+		else if (p.count > 0)
+		{
+			p.translation = args.TranslationMap();
+			DrawPalColumnTranslatedAdd(p);
+		}
+	}
+
+	void DrawColumnAddClampPalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (!SetupPalColumn(p, thread, args, FRACBITS))
+			DrawColumnAddClampPalCommand::Execute(thread);
+		else if (p.count > 0)
+			DrawPalColumnAddClamp(p);
+	}
+
+	void DrawColumnAddClampTranslatedPalAVX2Command::Execute(DrawerThread *thread)
+	{
+		PalColumnParams p;
+		if (!SetupPalColumn(p, thread, args, FRACBITS))
+		{
+			DrawColumnAddClampTranslatedPalCommand::Execute(thread);
+		}
+		else if (p.count > 0)
+		{
+			p.translation = args.TranslationMap();
+			DrawPalColumnTranslatedAddClamp(p);
+		}
+	}
+}
+
+#endif
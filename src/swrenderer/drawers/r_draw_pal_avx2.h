@@ -0,0 +1,46 @@
+#pragma once
+
+#include "r_draw_pal.h"
+
+namespace swrenderer
+{
+#ifndef NO_SSE
+
+	// AVX2 versions of the paletted span drawers and the translucent column drawers.
+	// The commands fall back to the scalar drawers for dynamic lights, r_blendmethod and
+	// textures whose size is not a multiple of four bytes.
+
+	class DrawSpanPalAVX2Command : public DrawSpanPalCommand { public: using DrawSpanPalCommand::DrawSpanPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanPalAVX2Command"; } };
+	class DrawSpanMaskedPalAVX2Command : public DrawSpanMaskedPalCommand { public: using DrawSpanMaskedPalCommand::DrawSpanMaskedPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanMaskedPalAVX2Command"; } };
+	class DrawSpanTranslucentPalAVX2Command : public DrawSpanTranslucentPalCommand { public: using DrawSpanTranslucentPalCommand::DrawSpanTranslucentPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanTranslucentPalAVX2Command"; } };
+	class DrawSpanMaskedTranslucentPalAVX2Command : public DrawSpanMaskedTranslucentPalCommand { public: using DrawSpanMaskedTranslucentPalCommand::DrawSpanMaskedTranslucentPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanMaskedTranslucentPalAVX2Command"; } };
+	class DrawSpanAddClampPalAVX2Command : public DrawSpanAddClampPalCommand { public: using DrawSpanAddClampPalCommand::DrawSpanAddClampPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanAddClampPalAVX2Command"; } };
+	class DrawSpanMaskedAddClampPalAVX2Command : public DrawSpanMaskedAddClampPalCommand { public: using DrawSpanMaskedAddClampPalCommand::DrawSpanMaskedAddClampPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawSpanMaskedAddClampPalAVX2Command"; } };
+
+	class DrawWallAdd1PalAVX2Command : public DrawWallAdd1PalCommand { public: using DrawWallAdd1PalCommand::DrawWallAdd1PalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawWallAdd1PalAVX2Command"; } };
+	class DrawWallAddClamp1PalAVX2Command : public DrawWallAddClamp1PalCommand { public: using DrawWallAddClamp1PalCommand::DrawWallAddClamp1PalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawWallAddClamp1PalAVX2Command"; } };
+
+	class DrawColumnAddPalAVX2Command : public DrawColumnAddPalCommand { public: using DrawColumnAddPalCommand::DrawColumnAddPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawColumnAddPalAVX2Command"; } };
+	class DrawColumnTlatedAddPalAVX2Command : public DrawColumnTlatedAddPalCommand { public: using DrawColumnTlatedAddPalCommand::DrawColumnTlatedAddPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawColumnTlatedAddPalAVX2Command"; } };
+	class DrawColumnAddClampPalAVX2Command : public DrawColumnAddClampPalCommand { public: using DrawColumnAddClampPalCommand::DrawColumnAddClampPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawColumnAddClampPalAVX2Command"; } };
+	class DrawColumnAddClampTranslatedPalAVX2Command : public DrawColumnAddClampTranslatedPalCommand { public: using DrawColumnAddClampTranslatedPalCommand::DrawColumnAddClampTranslatedPalCommand; void Execute(DrawerThread *thread) override; FString DebugInfo() override { return "DrawColumnAddClampTranslatedPalAVX2Command"; } };
+
+#else
+
+	typedef DrawSpanPalCommand DrawSpanPalAVX2Command;
+	typedef DrawSpanMaskedPalCommand DrawSpanMaskedPalAVX2Command;
+	typedef DrawSpanTranslucentPalCommand DrawSpanTranslucentPalAVX2Command;
+	typedef DrawSpanMaskedTranslucentPalCommand DrawSpanMaskedTranslucentPalAVX2Command;
+	typedef DrawSpanAddClampPalCommand DrawSpanAddClampPalAVX2Command;
+	typedef DrawSpanMaskedAddClampPalCommand DrawSpanMaskedAddClampPalAVX2Command;
+
+	typedef DrawWallAdd1PalCommand DrawWallAdd1PalAVX2Command;
+	typedef DrawWallAddClamp1PalCommand DrawWallAddClamp1PalAVX2Command;
+
+	typedef DrawColumnAddPalCommand DrawColumnAddPalAVX2Command;
+	typedef DrawColumnTlatedAddPalCommand DrawColumnTlatedAddPalAVX2Command;
+	typedef DrawColumnAddClampPalCommand DrawColumnAddClampPalAVX2Command;
+	typedef DrawColumnAddClampTranslatedPalCommand DrawColumnAddClampTranslatedPalAVX2Command;
+
+#endif
+}
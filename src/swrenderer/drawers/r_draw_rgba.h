@@ -84,6 +84,7 @@ namespace swrenderer
 		DrawFuzzColumnRGBACommand(const SpriteDrawerArgs &drawerargs);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _yl; count = _yh - _yl + 1; return true; }
 	};
 
 	class DrawScaledFuzzColumnRGBACommand : public DrawerCommand
@@ -100,6 +101,7 @@ namespace swrenderer
 		DrawScaledFuzzColumnRGBACommand(const SpriteDrawerArgs &drawerargs);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _yl; count = _yh - _yl + 1; return true; }
 	};
 
 	class FillSpanRGBACommand : public DrawerCommand
@@ -115,6 +117,7 @@ namespace swrenderer
 		FillSpanRGBACommand(const SpanDrawerArgs &drawerargs);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _y; count = 1; return true; }
 	};
 
 	class DrawFogBoundaryLineRGBACommand : public DrawerCommand
@@ -130,6 +133,7 @@ namespace swrenderer
 		DrawFogBoundaryLineRGBACommand(const SpanDrawerArgs &drawerargs);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _y; count = 1; return true; }
 	};
 
 	class DrawTiltedSpanRGBACommand : public DrawerCommand
@@ -157,6 +161,7 @@ namespace swrenderer
 		DrawTiltedSpanRGBACommand(const SpanDrawerArgs &drawerargs, const FVector3 &plane_sz, const FVector3 &plane_su, const FVector3 &plane_sv, bool plane_shade, int planeshade, float planelightfloat, fixed_t pviewx, fixed_t pviewy);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _y; count = 1; return true; }
 	};
 
 	class DrawColoredSpanRGBACommand : public DrawerCommand
@@ -173,6 +178,7 @@ namespace swrenderer
 
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _y; count = 1; return true; }
 	};
 
 	class ApplySpecialColormapRGBACommand : public DrawerCommand
@@ -218,6 +224,7 @@ namespace swrenderer
 		DrawParticleColumnRGBACommand(uint32_t *dest, int dest_y, int pitch, int count, uint32_t fg, uint32_t alpha, uint32_t fracposx);
 		void Execute(DrawerThread *thread) override;
 		FString DebugInfo() override;
+		bool LineRange(int &first_line, int &count) override { first_line = _dest_y; count = _count; return true; }
 
 	private:
 		uint32_t *_dest;
@@ -0,0 +1,1010 @@
+/*
+**  AVX2 drawer commands for the truecolor software renderer
+**  Copyright (c) 2018 GZDoom maintainers
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+// Nothing in here may run before CPU.bAVX2 has been checked. AVX2 code generation is
+// only enabled after the includes so that inline functions from the headers stay
+// usable on older CPUs.
+
+#ifndef NO_SSE
+
+#include <stddef.h>
+#include "templates.h"
+#include "doomdef.h"
+#include "v_video.h"
+#include "r_data/colormaps.h"
+#include "swrenderer/drawers/r_draw_rgba.h"
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+#include "swrenderer/viewport/r_viewport.h"
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace swrenderer
+{
+	namespace
+	{
+		// Eight pixels with 16 bits per channel, split over two registers.
+		// lo holds pixels 0, 1, 4 and 5, hi holds pixels 2, 3, 6 and 7. This is the layout
+		// _mm256_unpacklo/hi_epi8 produce from eight packed pixels and _mm256_packus_epi16 undoes.
+		struct Pixels8
+		{
+			__m256i lo, hi;
+		};
+
+		FORCEINLINE Pixels8 Unpack(__m256i c)
+		{
+			Pixels8 p;
+			p.lo = _mm256_unpacklo_epi8(c, _mm256_setzero_si256());
+			p.hi = _mm256_unpackhi_epi8(c, _mm256_setzero_si256());
+			return p;
+		}
+
+		FORCEINLINE __m256i Pack(Pixels8 p)
+		{
+			return _mm256_packus_epi16(p.lo, p.hi);
+		}
+
+		// Spreads one 32-bit value per pixel (below 65536) to all four channels of the pixel
+		FORCEINLINE Pixels8 Spread(__m256i v)
+		{
+			v = _mm256_or_si256(v, _mm256_slli_epi32(v, 16));
+			Pixels8 p;
+			p.lo = _mm256_unpacklo_epi32(v, v);
+			p.hi = _mm256_unpackhi_epi32(v, v);
+			return p;
+		}
+
+		// (red * 77 + green * 143 + blue * 37) >> 8 for each pixel, in pixel order
+		FORCEINLINE __m256i Intensity(Pixels8 c)
+		{
+			__m256i weights = _mm256_set1_epi64x(0x0000004d008f0025LL);
+			__m256i lo = _mm256_madd_epi16(c.lo, weights);
+			__m256i hi = _mm256_madd_epi16(c.hi, weights);
+			return _mm256_srli_epi32(_mm256_hadd_epi32(lo, hi), 8);
+		}
+
+		FORCEINLINE __m256i Index8()
+		{
+			return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		}
+
+		// Mask for the first n of eight lanes
+		FORCEINLINE __m256i LaneMask(int n)
+		{
+			return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), Index8());
+		}
+
+		// Light and colormap constants shared by all the drawers
+		struct ShadeSetup
+		{
+			__m256i mlight;
+			__m256i inv_desaturate;
+			__m256i shade_fade;
+			__m256i shade_light;
+			__m256i desaturate;
+			__m256i lightcontrib;
+		};
+
+		FORCEINLINE __m256i SetColor16(int a, int r, int g, int b)
+		{
+			return _mm256_set_epi16(a, r, g, b, a, r, g, b, a, r, g, b, a, r, g, b);
+		}
+
+		ShadeSetup SetupShade(const ShadeConstants &shade_constants, fixed_t lightlevel, uint32_t dynlight = 0)
+		{
+			ShadeSetup s;
+			int light = 256 - (lightlevel >> (FRACBITS - 8));
+			s.mlight = SetColor16(256, light, light, light);
+			if (!shade_constants.simple_shade)
+			{
+				int inv_desaturate = 256 - shade_constants.desaturate;
+				s.inv_desaturate = SetColor16(256, inv_desaturate, inv_desaturate, inv_desaturate);
+				s.shade_fade = SetColor16(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				s.shade_fade = _mm256_mullo_epi16(s.shade_fade, SetColor16(0, 256 - light, 256 - light, 256 - light));
+				s.shade_light = SetColor16(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue);
+				s.desaturate = _mm256_set1_epi32(shade_constants.desaturate);
+			}
+			else
+			{
+				s.inv_desaturate = _mm256_setzero_si256();
+				s.shade_fade = _mm256_setzero_si256();
+				s.shade_light = _mm256_setzero_si256();
+				s.desaturate = _mm256_setzero_si256();
+			}
+
+			// Sprites add the dynamic light directly to the light level
+			__m256i mdynlight = SetColor16(0, RPART(dynlight), GPART(dynlight), BPART(dynlight));
+			__m256i maxlight = _mm256_min_epi16(_mm256_add_epi16(s.mlight, mdynlight), _mm256_set1_epi16(256));
+			if (shade_constants.simple_shade)
+			{
+				s.mlight = maxlight;
+				s.lightcontrib = _mm256_setzero_si256();
+			}
+			else
+			{
+				s.lightcontrib = _mm256_sub_epi16(maxlight, s.mlight);
+			}
+			return s;
+		}
+
+		template<bool AdvancedShade>
+		FORCEINLINE Pixels8 Shade(Pixels8 fg, const ShadeSetup &s)
+		{
+			if (!AdvancedShade)
+			{
+				fg.lo = _mm256_srli_epi16(_mm256_mullo_epi16(fg.lo, s.mlight), 8);
+				fg.hi = _mm256_srli_epi16(_mm256_mullo_epi16(fg.hi, s.mlight), 8);
+			}
+			else
+			{
+				__m256i rgbmask = _mm256_set1_epi64x(0x0000ffffffffffffLL);
+				Pixels8 intensity = Spread(_mm256_mullo_epi32(Intensity(fg), s.desaturate));
+				intensity.lo = _mm256_and_si256(intensity.lo, rgbmask);
+				intensity.hi = _mm256_and_si256(intensity.hi, rgbmask);
+
+				fg.lo = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fg.lo, s.inv_desaturate), intensity.lo), 8);
+				fg.hi = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fg.hi, s.inv_desaturate), intensity.hi), 8);
+				fg.lo = _mm256_mullo_epi16(fg.lo, s.mlight);
+				fg.hi = _mm256_mullo_epi16(fg.hi, s.mlight);
+				fg.lo = _mm256_srli_epi16(_mm256_add_epi16(s.shade_fade, fg.lo), 8);
+				fg.hi = _mm256_srli_epi16(_mm256_add_epi16(s.shade_fade, fg.hi), 8);
+				fg.lo = _mm256_srli_epi16(_mm256_mullo_epi16(fg.lo, s.shade_light), 8);
+				fg.hi = _mm256_srli_epi16(_mm256_mullo_epi16(fg.hi, s.shade_light), 8);
+			}
+			return fg;
+		}
+
+		// Adds the dynamic lights. Spans step along x with L.y*L.y + L.z*L.z precomputed in y and the normal term in z.
+		// Walls step along z with L.x*L.x + L.y*L.y precomputed in x and the normal term in y.
+		template<bool SpanLights>
+		FORCEINLINE Pixels8 AddLights(Pixels8 material, Pixels8 fg, const DrawerLight *lights, int num_lights, __m256 viewpos)
+		{
+			__m256i lit_lo = _mm256_setzero_si256();
+			__m256i lit_hi = _mm256_setzero_si256();
+
+			for (int i = 0; i != num_lights; i++)
+			{
+				__m256 light_pos = _mm256_set1_ps(SpanLights ? lights[i].x : lights[i].z);
+				__m256 light_dist2 = _mm256_set1_ps(SpanLights ? lights[i].y : lights[i].x);
+				__m256 light_normal = _mm256_set1_ps(SpanLights ? lights[i].z : lights[i].y);
+				__m256 light_radius = _mm256_set1_ps(lights[i].radius);
+				__m256 m256 = _mm256_set1_ps(256.0f);
+
+				// L = light-pos
+				// dist = sqrt(dot(L, L))
+				// distance_attenuation = 1 - MIN(dist * (1/radius), 1)
+				__m256 L = _mm256_sub_ps(light_pos, viewpos);
+				__m256 dist2 = _mm256_add_ps(light_dist2, _mm256_mul_ps(L, L));
+				__m256 rcp_dist = _mm256_rsqrt_ps(dist2);
+				__m256 dist = _mm256_mul_ps(dist2, rcp_dist);
+				__m256 distance_attenuation = _mm256_sub_ps(m256, _mm256_min_ps(_mm256_mul_ps(dist, light_radius), m256));
+
+				// The simple light type
+				__m256 simple_attenuation = distance_attenuation;
+
+				// The point light type
+				// diffuse = dot(N,L) * attenuation
+				__m256 point_attenuation = _mm256_mul_ps(_mm256_mul_ps(light_normal, rcp_dist), distance_attenuation);
+
+				__m256 is_attenuated = _mm256_cmp_ps(light_normal, _mm256_setzero_ps(), _CMP_EQ_OQ);
+				__m256i attenuation = _mm256_cvtps_epi32(_mm256_blendv_ps(point_attenuation, simple_attenuation, is_attenuated));
+				attenuation = _mm256_max_epi32(attenuation, _mm256_set1_epi32(-32768));
+				attenuation = _mm256_min_epi32(attenuation, _mm256_set1_epi32(32767));
+				Pixels8 a = Spread(_mm256_and_si256(attenuation, _mm256_set1_epi32(0xffff)));
+
+				uint32_t color = lights[i].color;
+				__m256i light_color = SetColor16(APART(color), RPART(color), GPART(color), BPART(color));
+
+				lit_lo = _mm256_add_epi16(lit_lo, _mm256_srli_epi16(_mm256_mullo_epi16(light_color, a.lo), 8));
+				lit_hi = _mm256_add_epi16(lit_hi, _mm256_srli_epi16(_mm256_mullo_epi16(light_color, a.hi), 8));
+			}
+
+			lit_lo = _mm256_min_epi16(lit_lo, _mm256_set1_epi16(256));
+			lit_hi = _mm256_min_epi16(lit_hi, _mm256_set1_epi16(256));
+
+			fg.lo = _mm256_add_epi16(fg.lo, _mm256_srli_epi16(_mm256_mullo_epi16(material.lo, lit_lo), 8));
+			fg.hi = _mm256_add_epi16(fg.hi, _mm256_srli_epi16(_mm256_mullo_epi16(material.hi, lit_hi), 8));
+			fg.lo = _mm256_min_epi16(fg.lo, _mm256_set1_epi16(255));
+			fg.hi = _mm256_min_epi16(fg.hi, _mm256_set1_epi16(255));
+			return fg;
+		}
+
+		// (fg * A + bg * B) >> 8 per channel, where factors holds A in the low and B in the high 16 bits for each pixel
+		FORCEINLINE __m256i BlendFactors(Pixels8 fg, Pixels8 bg, __m256i factors)
+		{
+			__m256i f0 = _mm256_permutevar8x32_epi32(factors, _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4));
+			__m256i f1 = _mm256_permutevar8x32_epi32(factors, _mm256_setr_epi32(1, 1, 1, 1, 5, 5, 5, 5));
+			__m256i f2 = _mm256_permutevar8x32_epi32(factors, _mm256_setr_epi32(2, 2, 2, 2, 6, 6, 6, 6));
+			__m256i f3 = _mm256_permutevar8x32_epi32(factors, _mm256_setr_epi32(3, 3, 3, 3, 7, 7, 7, 7));
+
+			__m256i c0 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(fg.lo, bg.lo), f0), 8);
+			__m256i c1 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(fg.lo, bg.lo), f1), 8);
+			__m256i c2 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(fg.hi, bg.hi), f2), 8);
+			__m256i c3 = _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(fg.hi, bg.hi), f3), 8);
+
+			Pixels8 out;
+			out.lo = _mm256_packs_epi32(c0, c1);
+			out.hi = _mm256_packs_epi32(c2, c3);
+			return Pack(out);
+		}
+
+		FORCEINLINE __m256i Factors(__m256i a, __m256i b)
+		{
+			return _mm256_or_si256(_mm256_and_si256(a, _mm256_set1_epi32(0xffff)), _mm256_slli_epi32(b, 16));
+		}
+
+		// Texture alpha scaled by the source and dest alpha, as used by the add/sub/revsub blend modes
+		FORCEINLINE void AlphaFactors(__m256i texels, uint32_t srcalpha, uint32_t destalpha, __m256i &fgalpha, __m256i &bgalpha)
+		{
+			__m256i alpha = _mm256_srli_epi32(texels, 24);
+			alpha = _mm256_add_epi32(alpha, _mm256_srli_epi32(alpha, 7)); // 255->256
+			__m256i inv_alpha = _mm256_sub_epi32(_mm256_set1_epi32(256), alpha);
+			__m256i round = _mm256_set1_epi32(128);
+			bgalpha = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(destalpha), alpha), _mm256_slli_epi32(inv_alpha, 8)), round), 8);
+			fgalpha = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(srcalpha), alpha), round), 8);
+		}
+
+		// Bilinear filter of four samples. inv_a is the vertical and inv_b the horizontal weight, both 0-15.
+		FORCEINLINE __m256i Bilinear(__m256i p00, __m256i p01, __m256i p10, __m256i p11, __m256i inv_a, __m256i inv_b)
+		{
+			__m256i m16 = _mm256_set1_epi32(16);
+			__m256i a = _mm256_sub_epi32(m16, inv_a);
+			__m256i b = _mm256_sub_epi32(m16, inv_b);
+
+			Pixels8 w00 = Spread(_mm256_mullo_epi32(a, b));
+			Pixels8 w01 = Spread(_mm256_mullo_epi32(inv_a, b));
+			Pixels8 w10 = Spread(_mm256_mullo_epi32(a, inv_b));
+			Pixels8 w11 = Spread(_mm256_mullo_epi32(inv_a, inv_b));
+
+			Pixels8 c00 = Unpack(p00), c01 = Unpack(p01), c10 = Unpack(p10), c11 = Unpack(p11);
+			__m256i round = _mm256_set1_epi16(127);
+
+			Pixels8 out;
+			out.lo = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(c00.lo, w00.lo), _mm256_mullo_epi16(c01.lo, w01.lo)), _mm256_add_epi16(_mm256_mullo_epi16(c10.lo, w10.lo), _mm256_mullo_epi16(c11.lo, w11.lo)));
+			out.hi = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(c00.hi, w00.hi), _mm256_mullo_epi16(c01.hi, w01.hi)), _mm256_add_epi16(_mm256_mullo_epi16(c10.hi, w10.hi), _mm256_mullo_epi16(c11.hi, w11.hi)));
+			out.lo = _mm256_srli_epi16(_mm256_add_epi16(out.lo, round), 8);
+			out.hi = _mm256_srli_epi16(_mm256_add_epi16(out.hi, round), 8);
+			return Pack(out);
+		}
+
+		FORCEINLINE __m256i Gather(const uint32_t *source, __m256i index)
+		{
+			return _mm256_i32gather_epi32((const int *)source, index, 4);
+		}
+
+		// Reads the eight column pixels below dest
+		FORCEINLINE __m256i LoadColumn(const uint32_t *dest, __m256i offsets, int n)
+		{
+			if (n == 8)
+				return Gather(dest, offsets);
+			else
+				return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)dest, offsets, LaneMask(n), 4);
+		}
+
+		FORCEINLINE void StoreColumn(uint32_t *dest, int pitch, __m256i c, int n)
+		{
+			uint32_t out[8];
+			_mm256_storeu_si256((__m256i*)out, c);
+			for (int i = 0; i < n; i++)
+				dest[i * pitch] = out[i];
+		}
+
+		/////////////////////////////////////////////////////////////////////////
+
+		template<typename BlendT, bool AdvancedShade, bool LinearFilter>
+		void WallLoop(const WallDrawerArgs &args, DrawerThread *thread, const ShadeSetup &shade)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source = (const uint32_t*)args.TexturePixels();
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x80000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			int count = args.Count();
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+			int dest_y = args.DestY();
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpz = args.dc_viewpos.Z + args.dc_viewpos_step.Z * thread->skipped_by_thread(dest_y);
+			float stepvpz = args.dc_viewpos_step.Z * thread->num_cores;
+
+			count = thread->count_for_thread(dest_y, count);
+			if (count <= 0) return;
+			frac += thread->skipped_by_thread(dest_y) * fracstep;
+			dest = thread->dest_for_thread(dest_y, pitch, dest);
+			fracstep *= thread->num_cores;
+			pitch *= thread->num_cores;
+
+			if (LinearFilter)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m256i mfrac = _mm256_add_epi32(_mm256_set1_epi32(frac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(fracstep)));
+			__m256i mfracstep = _mm256_set1_epi32(fracstep * 8);
+			__m256i mheight = _mm256_set1_epi32(textureheight);
+			__m256i offsets = _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(pitch));
+			__m256 viewpos_z = _mm256_add_ps(_mm256_set1_ps(vpz), _mm256_mul_ps(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), _mm256_set1_ps(stepvpz)));
+			__m256 step_viewpos_z = _mm256_set1_ps(stepvpz * 8.0f);
+
+			for (int index = 0; index < count; index += 8)
+			{
+				int n = MIN(count - index, 8);
+				uint32_t *d = dest + index * pitch;
+
+				__m256i texels;
+				if (!LinearFilter)
+				{
+					__m256i sample_index = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(mfrac, FRACBITS), mheight), FRACBITS);
+					texels = Gather(source, sample_index);
+				}
+				else
+				{
+					__m256i frac_y0 = _mm256_mullo_epi32(_mm256_srli_epi32(mfrac, FRACBITS), mheight);
+					__m256i frac_y1 = _mm256_mullo_epi32(_mm256_srli_epi32(_mm256_add_epi32(mfrac, _mm256_set1_epi32(one)), FRACBITS), mheight);
+					__m256i y0 = _mm256_srli_epi32(frac_y0, FRACBITS);
+					__m256i y1 = _mm256_srli_epi32(frac_y1, FRACBITS);
+					__m256i inv_a = _mm256_and_si256(_mm256_srli_epi32(frac_y1, FRACBITS - 4), _mm256_set1_epi32(15));
+					texels = Bilinear(Gather(source, y0), Gather(source, y1), Gather(source2, y0), Gather(source2, y1), inv_a, _mm256_set1_epi32(texturefracx));
+				}
+
+				Pixels8 material = Unpack(texels);
+				Pixels8 fg = Shade<AdvancedShade>(material, shade);
+				if (num_lights != 0)
+					fg = AddLights<false>(material, fg, lights, num_lights, viewpos_z);
+
+				__m256i outcolor;
+				if (BlendT::Mode == (int)WallBlendModes::Opaque)
+				{
+					outcolor = Pack(fg);
+				}
+				else if (BlendT::Mode == (int)WallBlendModes::Masked)
+				{
+					__m256i bgcolor = LoadColumn(d, offsets, n);
+					outcolor = Pack(fg);
+					outcolor = _mm256_blendv_epi8(outcolor, bgcolor, _mm256_cmpeq_epi32(outcolor, _mm256_setzero_si256()));
+					outcolor = _mm256_or_si256(outcolor, _mm256_set1_epi32(0xff000000));
+				}
+				else
+				{
+					Pixels8 bg = Unpack(LoadColumn(d, offsets, n));
+					__m256i fgalpha, bgalpha;
+					AlphaFactors(texels, srcalpha, destalpha, fgalpha, bgalpha);
+					__m256i factors;
+					if (BlendT::Mode == (int)WallBlendModes::AddClamp)
+						factors = Factors(fgalpha, bgalpha);
+					else if (BlendT::Mode == (int)WallBlendModes::SubClamp)
+						factors = Factors(fgalpha, _mm256_sub_epi32(_mm256_setzero_si256(), bgalpha));
+					else
+						factors = Factors(_mm256_sub_epi32(_mm256_setzero_si256(), fgalpha), bgalpha);
+					outcolor = _mm256_or_si256(BlendFactors(fg, bg, factors), _mm256_set1_epi32(0xff000000));
+				}
+
+				StoreColumn(d, pitch, outcolor, n);
+
+				mfrac = _mm256_add_epi32(mfrac, mfracstep);
+				viewpos_z = _mm256_add_ps(viewpos_z, step_viewpos_z);
+			}
+		}
+
+		/////////////////////////////////////////////////////////////////////////
+
+		struct SpanTexture
+		{
+			uint32_t width;
+			uint32_t height;
+			uint32_t xone;
+			uint32_t yone;
+			uint32_t xstep;
+			uint32_t ystep;
+			uint32_t xfrac;
+			uint32_t yfrac;
+			const uint32_t *source;
+		};
+
+		template<bool LinearFilter, bool Size64x64>
+		FORCEINLINE __m256i SampleSpan(const SpanTexture &tex, __m256i xfrac, __m256i yfrac)
+		{
+			if (!LinearFilter && Size64x64)
+			{
+				__m256i sample_index = _mm256_add_epi32(_mm256_and_si256(_mm256_srli_epi32(xfrac, 32 - 6 - 6), _mm256_set1_epi32(63 * 64)), _mm256_srli_epi32(yfrac, 32 - 6));
+				return Gather(tex.source, sample_index);
+			}
+			else if (!LinearFilter)
+			{
+				__m256i x = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(xfrac, 16), _mm256_set1_epi32(tex.width)), 16);
+				__m256i y = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(yfrac, 16), _mm256_set1_epi32(tex.height)), 16);
+				return Gather(tex.source, _mm256_add_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32(tex.height)), y));
+			}
+			else
+			{
+				__m256i frac_x, frac_y, p00, p01, p10, p11;
+				if (Size64x64)
+				{
+					frac_x = _mm256_slli_epi32(_mm256_srli_epi32(xfrac, 16), 6);
+					frac_y = _mm256_slli_epi32(_mm256_srli_epi32(yfrac, 16), 6);
+					__m256i x0 = _mm256_srli_epi32(frac_x, 16);
+					__m256i y0 = _mm256_srli_epi32(frac_y, 16);
+					__m256i x1 = _mm256_and_si256(_mm256_add_epi32(x0, _mm256_set1_epi32(1)), _mm256_set1_epi32(0x3f));
+					__m256i y1 = _mm256_and_si256(_mm256_add_epi32(y0, _mm256_set1_epi32(1)), _mm256_set1_epi32(0x3f));
+					x0 = _mm256_slli_epi32(x0, 6);
+					x1 = _mm256_slli_epi32(x1, 6);
+					p00 = Gather(tex.source, _mm256_add_epi32(y0, x0));
+					p01 = Gather(tex.source, _mm256_add_epi32(y1, x0));
+					p10 = Gather(tex.source, _mm256_add_epi32(y0, x1));
+					p11 = Gather(tex.source, _mm256_add_epi32(y1, x1));
+				}
+				else
+				{
+					__m256i width = _mm256_set1_epi32(tex.width);
+					__m256i height = _mm256_set1_epi32(tex.height);
+					frac_x = _mm256_mullo_epi32(_mm256_srli_epi32(xfrac, 16), width);
+					frac_y = _mm256_mullo_epi32(_mm256_srli_epi32(yfrac, 16), height);
+					__m256i x0 = _mm256_srli_epi32(frac_x, 16);
+					__m256i y0 = _mm256_srli_epi32(frac_y, 16);
+					__m256i x1 = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(_mm256_add_epi32(xfrac, _mm256_set1_epi32(tex.xone)), 16), width), 16);
+					__m256i y1 = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(_mm256_add_epi32(yfrac, _mm256_set1_epi32(tex.yone)), 16), height), 16);
+					x0 = _mm256_mullo_epi32(x0, height);
+					x1 = _mm256_mullo_epi32(x1, height);
+					p00 = Gather(tex.source, _mm256_add_epi32(y0, x0));
+					p01 = Gather(tex.source, _mm256_add_epi32(y1, x0));
+					p10 = Gather(tex.source, _mm256_add_epi32(y0, x1));
+					p11 = Gather(tex.source, _mm256_add_epi32(y1, x1));
+				}
+
+				__m256i inv_b = _mm256_and_si256(_mm256_srli_epi32(frac_x, 12), _mm256_set1_epi32(15));
+				__m256i inv_a = _mm256_and_si256(_mm256_srli_epi32(frac_y, 12), _mm256_set1_epi32(15));
+				return Bilinear(p00, p01, p10, p11, inv_a, inv_b);
+			}
+		}
+
+		template<typename BlendT, bool AdvancedShade, bool LinearFilter, bool Size64x64>
+		void SpanLoop(const SpanDrawerArgs &args, SpanTexture tex, const ShadeSetup &shade)
+		{
+			using namespace DrawSpan32TModes;
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpx = args.dc_viewpos.X;
+			float stepvpx = args.dc_viewpos_step.X;
+			__m256 viewpos_x = _mm256_add_ps(_mm256_set1_ps(vpx), _mm256_mul_ps(_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f), _mm256_set1_ps(stepvpx)));
+			__m256 step_viewpos_x = _mm256_set1_ps(stepvpx * 8.0f);
+
+			int count = args.DestX2() - args.DestX1() + 1;
+			uint32_t *dest = (uint32_t*)args.Viewport()->GetDest(args.DestX1(), args.DestY());
+
+			if (LinearFilter)
+			{
+				tex.xfrac -= tex.xone / 2;
+				tex.yfrac -= tex.yone / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			__m256i xfrac = _mm256_add_epi32(_mm256_set1_epi32(tex.xfrac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(tex.xstep)));
+			__m256i yfrac = _mm256_add_epi32(_mm256_set1_epi32(tex.yfrac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(tex.ystep)));
+			__m256i xstep = _mm256_set1_epi32(tex.xstep * 8);
+			__m256i ystep = _mm256_set1_epi32(tex.ystep * 8);
+
+			for (int x = 0; x < count; x += 8)
+			{
+				int n = MIN(count - x, 8);
+				__m256i mask = LaneMask(n);
+
+				__m256i texels = SampleSpan<LinearFilter, Size64x64>(tex, xfrac, yfrac);
+
+				Pixels8 material = Unpack(texels);
+				Pixels8 fg = Shade<AdvancedShade>(material, shade);
+				if (num_lights != 0)
+					fg = AddLights<true>(material, fg, lights, num_lights, viewpos_x);
+
+				__m256i outcolor;
+				if (BlendT::Mode == (int)SpanBlendModes::Opaque)
+				{
+					outcolor = Pack(fg);
+				}
+				else
+				{
+					__m256i bgcolor = (n == 8) ? _mm256_loadu_si256((const __m256i*)(dest + x)) : _mm256_maskload_epi32((const int*)(dest + x), mask);
+					if (BlendT::Mode == (int)SpanBlendModes::Masked)
+					{
+						outcolor = Pack(fg);
+						outcolor = _mm256_blendv_epi8(outcolor, bgcolor, _mm256_cmpeq_epi32(outcolor, _mm256_setzero_si256()));
+					}
+					else if (BlendT::Mode == (int)SpanBlendModes::Translucent)
+					{
+						outcolor = BlendFactors(fg, Unpack(bgcolor), _mm256_set1_epi32(srcalpha | (destalpha << 16)));
+					}
+					else
+					{
+						__m256i fgalpha, bgalpha;
+						AlphaFactors(texels, srcalpha, destalpha, fgalpha, bgalpha);
+						__m256i factors;
+						if (BlendT::Mode == (int)SpanBlendModes::AddClamp)
+							factors = Factors(fgalpha, bgalpha);
+						else if (BlendT::Mode == (int)SpanBlendModes::SubClamp)
+							factors = Factors(fgalpha, _mm256_sub_epi32(_mm256_setzero_si256(), bgalpha));
+						else
+							factors = Factors(_mm256_sub_epi32(_mm256_setzero_si256(), fgalpha), bgalpha);
+						outcolor = BlendFactors(fg, Unpack(bgcolor), factors);
+					}
+					outcolor = _mm256_or_si256(outcolor, _mm256_set1_epi32(0xff000000));
+				}
+
+				if (n == 8)
+					_mm256_storeu_si256((__m256i*)(dest + x), outcolor);
+				else
+					_mm256_maskstore_epi32((int*)(dest + x), mask, outcolor);
+
+				xfrac = _mm256_add_epi32(xfrac, xstep);
+				yfrac = _mm256_add_epi32(yfrac, ystep);
+				viewpos_x = _mm256_add_ps(viewpos_x, step_viewpos_x);
+			}
+		}
+
+		/////////////////////////////////////////////////////////////////////////
+
+		template<typename BlendT, typename SamplerT, bool AdvancedShade, bool LinearFilter>
+		void SpriteLoop(const SpriteDrawerArgs &args, DrawerThread *thread, const ShadeSetup &shade)
+		{
+			using namespace DrawSprite32TModes;
+
+			const uint32_t *source = (const uint32_t*)args.TexturePixels();
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			const uint8_t *sourcepal = args.TexturePixels();
+			const uint8_t *colormap = nullptr;
+			const uint32_t *translation = nullptr;
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded || SamplerT::Mode == (int)SpriteSamplers::Translated)
+			{
+				colormap = args.Colormap(args.Viewport());
+				translation = (const uint32_t*)args.TranslationMap();
+			}
+
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x20000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			int count = args.Count();
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+			int dest_y = args.DestY();
+
+			count = thread->count_for_thread(dest_y, count);
+			if (count <= 0) return;
+			frac += thread->skipped_by_thread(dest_y) * fracstep;
+			dest = thread->dest_for_thread(dest_y, pitch, dest);
+			fracstep *= thread->num_cores;
+			pitch *= thread->num_cores;
+
+			if (LinearFilter)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+			uint32_t srccolor = args.SrcColorBgra();
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			uint32_t color = LightBgra::shade_bgra_simple(args.SolidColorBgra(), LightBgra::calc_light_multiplier(light));
+
+			__m256i mfrac = _mm256_add_epi32(_mm256_set1_epi32(frac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(fracstep)));
+			__m256i mfracstep = _mm256_set1_epi32(fracstep * 8);
+			__m256i mheight = _mm256_set1_epi32(textureheight);
+			__m256i offsets = _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(pitch));
+
+			for (int index = 0; index < count; index += 8)
+			{
+				int n = MIN(count - index, 8);
+				uint32_t *d = dest + index * pitch;
+
+				// Palette lookups past the end of the column may read outside the texture, so those are done per pixel
+				__m256i texels, shadealpha = _mm256_setzero_si256();
+				if (SamplerT::Mode == (int)SpriteSamplers::Shaded)
+				{
+					uint32_t alpha[8] = { 0 };
+					uint32_t f = frac + index * fracstep;
+					for (int i = 0; i < n; i++, f += fracstep)
+						alpha[i] = clamp<uint32_t>(colormap[sourcepal[f >> FRACBITS]], 0, 64) * 4;
+					shadealpha = _mm256_loadu_si256((const __m256i*)alpha);
+					texels = _mm256_set1_epi32(color);
+				}
+				else if (SamplerT::Mode == (int)SpriteSamplers::Translated)
+				{
+					uint32_t palindex[8] = { 0 };
+					uint32_t f = frac + index * fracstep;
+					for (int i = 0; i < n; i++, f += fracstep)
+						palindex[i] = sourcepal[f >> FRACBITS];
+					texels = Gather(translation, _mm256_loadu_si256((const __m256i*)palindex));
+				}
+				else if (SamplerT::Mode == (int)SpriteSamplers::Fill)
+				{
+					texels = _mm256_set1_epi32(srccolor);
+				}
+				else if (!LinearFilter)
+				{
+					__m256i sample_index = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(_mm256_slli_epi32(mfrac, 2), FRACBITS), mheight), FRACBITS);
+					texels = Gather(source, sample_index);
+				}
+				else
+				{
+					// Clamp to edge
+					__m256i maxfrac = _mm256_set1_epi32(1 << 30);
+					__m256i frac_y0 = _mm256_mullo_epi32(_mm256_srli_epi32(_mm256_min_epu32(mfrac, maxfrac), FRACBITS - 2), mheight);
+					__m256i frac_y1 = _mm256_mullo_epi32(_mm256_srli_epi32(_mm256_min_epu32(_mm256_add_epi32(mfrac, _mm256_set1_epi32(one)), maxfrac), FRACBITS - 2), mheight);
+					__m256i y0 = _mm256_srli_epi32(frac_y0, FRACBITS);
+					__m256i y1 = _mm256_srli_epi32(frac_y1, FRACBITS);
+					__m256i inv_a = _mm256_and_si256(_mm256_srli_epi32(frac_y1, FRACBITS - 4), _mm256_set1_epi32(15));
+					texels = Bilinear(Gather(source, y0), Gather(source, y1), Gather(source2, y0), Gather(source2, y1), inv_a, _mm256_set1_epi32(texturefracx));
+				}
+
+				Pixels8 fg = Unpack(texels);
+				if (AdvancedShade)
+				{
+					Pixels8 lit_dynlight;
+					lit_dynlight.lo = _mm256_srli_epi16(_mm256_mullo_epi16(fg.lo, shade.lightcontrib), 8);
+					lit_dynlight.hi = _mm256_srli_epi16(_mm256_mullo_epi16(fg.hi, shade.lightcontrib), 8);
+					fg = Shade<true>(fg, shade);
+					fg.lo = _mm256_min_epi16(_mm256_add_epi16(fg.lo, lit_dynlight.lo), _mm256_set1_epi16(255));
+					fg.hi = _mm256_min_epi16(_mm256_add_epi16(fg.hi, lit_dynlight.hi), _mm256_set1_epi16(255));
+				}
+				else
+				{
+					fg = Shade<false>(fg, shade);
+				}
+
+				__m256i outcolor;
+				if (BlendT::Mode == (int)SpriteBlendModes::Opaque)
+				{
+					outcolor = Pack(fg);
+				}
+				else
+				{
+					Pixels8 bg = Unpack(LoadColumn(d, offsets, n));
+					__m256i factors;
+					if (BlendT::Mode == (int)SpriteBlendModes::Shaded)
+					{
+						factors = Factors(shadealpha, _mm256_sub_epi32(_mm256_set1_epi32(256), shadealpha));
+					}
+					else if (BlendT::Mode == (int)SpriteBlendModes::AddClampShaded)
+					{
+						factors = Factors(shadealpha, _mm256_set1_epi32(256));
+					}
+					else
+					{
+						__m256i fgalpha, bgalpha;
+						AlphaFactors(texels, srcalpha, destalpha, fgalpha, bgalpha);
+						if (BlendT::Mode == (int)SpriteBlendModes::AddClamp)
+							factors = Factors(fgalpha, bgalpha);
+						else if (BlendT::Mode == (int)SpriteBlendModes::SubClamp)
+							factors = Factors(fgalpha, _mm256_sub_epi32(_mm256_setzero_si256(), bgalpha));
+						else
+							factors = Factors(_mm256_sub_epi32(_mm256_setzero_si256(), fgalpha), bgalpha);
+					}
+					outcolor = _mm256_or_si256(BlendFactors(fg, bg, factors), _mm256_set1_epi32(0xff000000));
+				}
+
+				StoreColumn(d, pitch, outcolor, n);
+
+				mfrac = _mm256_add_epi32(mfrac, mfracstep);
+			}
+		}
+		/////////////////////////////////////////////////////////////////////////
+
+		template<typename BlendT>
+		void ExecuteWall(const WallDrawerArgs &args, DrawerThread *thread)
+		{
+			bool is_nearest_filter = (args.TexturePixels2() == nullptr);
+			auto shade_constants = args.ColormapConstants();
+			ShadeSetup shade = SetupShade(shade_constants, args.Light());
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+					WallLoop<BlendT, false, false>(args, thread, shade);
+				else
+					WallLoop<BlendT, false, true>(args, thread, shade);
+			}
+			else
+			{
+				if (is_nearest_filter)
+					WallLoop<BlendT, true, false>(args, thread, shade);
+				else
+					WallLoop<BlendT, true, true>(args, thread, shade);
+			}
+		}
+
+		template<typename BlendT>
+		void ExecuteSpan(const SpanDrawerArgs &args, DrawerThread *thread)
+		{
+			if (thread->line_skipped_by_thread(args.DestY())) return;
+
+			SpanTexture tex;
+			tex.width = args.TextureWidth();
+			tex.height = args.TextureHeight();
+			tex.xstep = args.TextureUStep();
+			tex.ystep = args.TextureVStep();
+			tex.xfrac = args.TextureUPos();
+			tex.yfrac = args.TextureVPos();
+			tex.source = (const uint32_t*)args.TexturePixels();
+
+			double lod = args.TextureLOD();
+			bool mipmapped = args.MipmappedTexture();
+
+			bool magnifying = lod < 0.0;
+			if (r_mipmap && mipmapped)
+			{
+				int level = (int)lod;
+				while (level > 0)
+				{
+					if (tex.width <= 2 || tex.height <= 2)
+						break;
+
+					tex.source += tex.width * tex.height;
+					tex.width = MAX<uint32_t>(tex.width / 2, 1);
+					tex.height = MAX<uint32_t>(tex.height / 2, 1);
+					level--;
+				}
+			}
+
+			tex.xone = (0x80000000u / tex.width) << 1;
+			tex.yone = (0x80000000u / tex.height) << 1;
+
+			bool is_nearest_filter = (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
+			bool is_64x64 = tex.width == 64 && tex.height == 64;
+
+			auto shade_constants = args.ColormapConstants();
+			ShadeSetup shade = SetupShade(shade_constants, args.Light());
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						SpanLoop<BlendT, false, false, true>(args, tex, shade);
+					else
+						SpanLoop<BlendT, false, false, false>(args, tex, shade);
+				}
+				else
+				{
+					if (is_64x64)
+						SpanLoop<BlendT, false, true, true>(args, tex, shade);
+					else
+						SpanLoop<BlendT, false, true, false>(args, tex, shade);
+				}
+			}
+			else
+			{
+				if (is_nearest_filter)
+				{
+					if (is_64x64)
+						SpanLoop<BlendT, true, false, true>(args, tex, shade);
+					else
+						SpanLoop<BlendT, true, false, false>(args, tex, shade);
+				}
+				else
+				{
+					if (is_64x64)
+						SpanLoop<BlendT, true, true, true>(args, tex, shade);
+					else
+						SpanLoop<BlendT, true, true, false>(args, tex, shade);
+				}
+			}
+		}
+
+		template<typename BlendT, typename SamplerT>
+		void ExecuteSprite(const SpriteDrawerArgs &args, DrawerThread *thread)
+		{
+			using namespace DrawSprite32TModes;
+
+			auto shade_constants = args.ColormapConstants();
+			ShadeSetup shade = SetupShade(shade_constants, args.Light(), args.DynamicLight());
+
+			// No linear filtering for translated, shaded or fill
+			bool is_nearest_filter = SamplerT::Mode != (int)SpriteSamplers::Texture || args.TexturePixels2() == nullptr;
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+					SpriteLoop<BlendT, SamplerT, false, false>(args, thread, shade);
+				else
+					SpriteLoop<BlendT, SamplerT, false, true>(args, thread, shade);
+			}
+			else
+			{
+				if (is_nearest_filter)
+					SpriteLoop<BlendT, SamplerT, true, false>(args, thread, shade);
+				else
+					SpriteLoop<BlendT, SamplerT, true, true>(args, thread, shade);
+			}
+		}
+
+		template<bool DoubleSky>
+		void ExecuteSky(const SkyDrawerArgs &args, DrawerThread *thread)
+		{
+			uint32_t *dest = (uint32_t *)args.Dest();
+			int count = args.Count();
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			const uint32_t *source0 = (const uint32_t *)args.FrontTexturePixels();
+			const uint32_t *source1 = (const uint32_t *)args.BackTexturePixels();
+			int textureheight0 = args.FrontTextureHeight();
+			uint32_t maxtextureheight1 = DoubleSky ? args.BackTextureHeight() - 1 : 0;
+
+			int32_t frac = args.TextureVPos();
+			int32_t fracstep = args.TextureVStep();
+
+			uint32_t solid_top = args.SolidTopColor();
+			uint32_t solid_bottom = args.SolidBottomColor();
+			bool fadeSky = args.FadeSky();
+
+			// Lines past the end of the pass belong to another thread
+			count = MIN(count, thread->pass_end_y - args.DestY());
+
+			// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
+			int start_fade = 2; // How fast it should fade out
+			int fade_length = (1 << (24 - start_fade));
+			int start_fadetop_y = (-frac) / fracstep;
+			int end_fadetop_y = (fade_length - frac) / fracstep;
+			int start_fadebottom_y = ((2 << 24) - fade_length - frac) / fracstep;
+			int end_fadebottom_y = ((2 << 24) - frac) / fracstep;
+			start_fadetop_y = clamp(start_fadetop_y, 0, count);
+			end_fadetop_y = clamp(end_fadetop_y, 0, count);
+			start_fadebottom_y = clamp(start_fadebottom_y, 0, count);
+			end_fadebottom_y = clamp(end_fadebottom_y, 0, count);
+
+			int num_cores = thread->num_cores;
+			int skipped = thread->skipped_by_thread(args.DestY());
+			dest = thread->dest_for_thread(args.DestY(), pitch, dest);
+			frac += fracstep * skipped;
+			count = thread->count_for_thread(args.DestY(), count);
+			if (count <= 0) return;
+
+			__m256i index = _mm256_add_epi32(_mm256_set1_epi32(skipped), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(num_cores)));
+			__m256i indexstep = _mm256_set1_epi32(num_cores * 8);
+			__m256i mfrac = _mm256_add_epi32(_mm256_set1_epi32(frac), _mm256_mullo_epi32(Index8(), _mm256_set1_epi32(fracstep * num_cores)));
+			__m256i mfracstep = _mm256_set1_epi32(fracstep * num_cores * 8);
+			__m256i mheight = _mm256_set1_epi32(textureheight0);
+			pitch *= num_cores;
+
+			Pixels8 solid_top_fill = Unpack(_mm256_set1_epi32(solid_top));
+
+			for (int i = 0; i < count; i += 8)
+			{
+				int n = MIN(count - i, 8);
+
+				__m256i sample_index = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(_mm256_slli_epi32(mfrac, 8), FRACBITS), mheight), FRACBITS);
+				__m256i fg = Gather(source0, sample_index);
+				if (DoubleSky)
+				{
+					__m256i sample_index2 = _mm256_min_epu32(sample_index, _mm256_set1_epi32(maxtextureheight1));
+					__m256i transparent = _mm256_cmpeq_epi32(fg, _mm256_setzero_si256());
+					fg = _mm256_mask_i32gather_epi32(fg, (const int *)source1, sample_index2, transparent, 4);
+				}
+
+				if (fadeSky)
+				{
+					// Fade towards the top color at both ends, then pick the band each line is in
+					__m256i alpha_top = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(mfrac, 16 - start_fade), _mm256_setzero_si256()), _mm256_set1_epi32(256));
+					__m256i alpha_bottom = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(_mm256_sub_epi32(_mm256_set1_epi32(2 << 24), mfrac), 16 - start_fade), _mm256_setzero_si256()), _mm256_set1_epi32(256));
+					Pixels8 c = Unpack(fg);
+					__m256i fadetop = BlendFactors(c, solid_top_fill, Factors(alpha_top, _mm256_sub_epi32(_mm256_set1_epi32(256), alpha_top)));
+					__m256i fadebottom = BlendFactors(c, solid_top_fill, Factors(alpha_bottom, _mm256_sub_epi32(_mm256_set1_epi32(256), alpha_bottom)));
+
+					__m256i out = _mm256_set1_epi32(solid_bottom);
+					out = _mm256_blendv_epi8(out, fadebottom, _mm256_cmpgt_epi32(_mm256_set1_epi32(end_fadebottom_y), index));
+					out = _mm256_blendv_epi8(out, fg, _mm256_cmpgt_epi32(_mm256_set1_epi32(start_fadebottom_y), index));
+					out = _mm256_blendv_epi8(out, fadetop, _mm256_cmpgt_epi32(_mm256_set1_epi32(end_fadetop_y), index));
+					out = _mm256_blendv_epi8(out, _mm256_set1_epi32(solid_top), _mm256_cmpgt_epi32(_mm256_set1_epi32(start_fadetop_y), index));
+					fg = out;
+				}
+
+				StoreColumn(dest + i * pitch, pitch, fg, n);
+
+				index = _mm256_add_epi32(index, indexstep);
+				mfrac = _mm256_add_epi32(mfrac, mfracstep);
+			}
+		}
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	// The drawer classes are declared without AVX2 code generation, so their Execute
+	// functions only forward to the AVX2 code above.
+
+	template<typename BlendT>
+	void DrawWall32AVX2T<BlendT>::Execute(DrawerThread *thread)
+	{
+		ExecuteWall<BlendT>(args, thread);
+	}
+
+	template<typename BlendT>
+	void DrawSpan32AVX2T<BlendT>::Execute(DrawerThread *thread)
+	{
+		ExecuteSpan<BlendT>(args, thread);
+	}
+
+	template<typename BlendT, typename SamplerT>
+	void DrawSprite32AVX2T<BlendT, SamplerT>::Execute(DrawerThread *thread)
+	{
+		ExecuteSprite<BlendT, SamplerT>(args, thread);
+	}
+
+	template<bool DoubleSky>
+	void DrawSky32AVX2T<DoubleSky>::Execute(DrawerThread *thread)
+	{
+		ExecuteSky<DoubleSky>(args, thread);
+	}
+
+	/////////////////////////////////////////////////////////////////////////////
+
+	template class DrawWall32AVX2T<DrawWall32TModes::OpaqueWall>;
+	template class DrawWall32AVX2T<DrawWall32TModes::MaskedWall>;
+	template class DrawWall32AVX2T<DrawWall32TModes::AddClampWall>;
+	template class DrawWall32AVX2T<DrawWall32TModes::SubClampWall>;
+	template class DrawWall32AVX2T<DrawWall32TModes::RevSubClampWall>;
+
+	template class DrawSpan32AVX2T<DrawSpan32TModes::OpaqueSpan>;
+	template class DrawSpan32AVX2T<DrawSpan32TModes::MaskedSpan>;
+	template class DrawSpan32AVX2T<DrawSpan32TModes::TranslucentSpan>;
+	template class DrawSpan32AVX2T<DrawSpan32TModes::AddClampSpan>;
+	template class DrawSpan32AVX2T<DrawSpan32TModes::SubClampSpan>;
+	template class DrawSpan32AVX2T<DrawSpan32TModes::RevSubClampSpan>;
+
+	template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TextureSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TextureSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TextureSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TextureSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::FillSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::FillSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::FillSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::FillSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::ShadedSprite, DrawSprite32TModes::ShadedSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampShadedSprite, DrawSprite32TModes::ShadedSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TranslatedSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TranslatedSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TranslatedSampler>;
+	template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TranslatedSampler>;
+
+	template class DrawSky32AVX2T<false>;
+	template class DrawSky32AVX2T<true>;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
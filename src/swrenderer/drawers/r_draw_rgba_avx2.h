@@ -0,0 +1,211 @@
+/*
+**  AVX2 drawer commands for the truecolor software renderer
+**  Copyright (c) 2018 GZDoom maintainers
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+*/
+
+#pragma once
+
+#ifdef NO_SSE
+#include "r_draw_wall32.h"
+#include "r_draw_sprite32.h"
+#include "r_draw_span32.h"
+#include "r_draw_sky32.h"
+#else
+#include "r_draw_wall32_sse2.h"
+#include "r_draw_sprite32_sse2.h"
+#include "r_draw_span32_sse2.h"
+#include "r_draw_sky32_sse2.h"
+#endif
+
+// Use the AVX2 drawers when the CPU supports them
+EXTERN_CVAR(Bool, r_avx2drawers)
+
+namespace swrenderer
+{
+#ifndef NO_SSE
+
+	// The Execute functions live in r_draw_rgba_avx2.cpp, the only file compiled with AVX2 code generation.
+	// Only push these commands after checking CPU.bAVX2.
+
+	template<typename BlendT>
+	class DrawWall32AVX2T : public DrawerCommand
+	{
+	protected:
+		WallDrawerArgs args;
+
+	public:
+		DrawWall32AVX2T(const WallDrawerArgs &drawerargs) : args(drawerargs) { }
+
+		void Execute(DrawerThread *thread) override;
+		FString DebugInfo() override { return "DrawWall32AVX2T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
+	};
+
+	template<typename BlendT>
+	class DrawSpan32AVX2T : public DrawerCommand
+	{
+	protected:
+		SpanDrawerArgs args;
+
+	public:
+		DrawSpan32AVX2T(const SpanDrawerArgs &drawerargs) : args(drawerargs) { }
+
+		void Execute(DrawerThread *thread) override;
+		FString DebugInfo() override { return "DrawSpan32AVX2T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = 1; return true; }
+		int PixelCount() override { return args.DestX2() - args.DestX1() + 1; }
+	};
+
+	template<typename BlendT, typename SamplerT>
+	class DrawSprite32AVX2T : public DrawerCommand
+	{
+	protected:
+		SpriteDrawerArgs args;
+
+	public:
+		DrawSprite32AVX2T(const SpriteDrawerArgs &drawerargs) : args(drawerargs) { }
+
+		void Execute(DrawerThread *thread) override;
+		FString DebugInfo() override { return "DrawSprite32AVX2T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
+	};
+
+	template<bool DoubleSky>
+	class DrawSky32AVX2T : public DrawerCommand
+	{
+	protected:
+		SkyDrawerArgs args;
+
+	public:
+		DrawSky32AVX2T(const SkyDrawerArgs &args) : args(args) { }
+
+		void Execute(DrawerThread *thread) override;
+		FString DebugInfo() override { return DoubleSky ? "DrawSkyDouble32AVX2Command" : "DrawSkySingle32AVX2Command"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
+	};
+
+	typedef DrawWall32AVX2T<DrawWall32TModes::OpaqueWall> DrawWall32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::MaskedWall> DrawWallMasked32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::AddClampWall> DrawWallAddClamp32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::SubClampWall> DrawWallSubClamp32AVX2Command;
+	typedef DrawWall32AVX2T<DrawWall32TModes::RevSubClampWall> DrawWallRevSubClamp32AVX2Command;
+
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::OpaqueSpan> DrawSpan32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::MaskedSpan> DrawSpanMasked32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::TranslucentSpan> DrawSpanTranslucent32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::AddClampSpan> DrawSpanAddClamp32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::SubClampSpan> DrawSpanSubClamp32AVX2Command;
+	typedef DrawSpan32AVX2T<DrawSpan32TModes::RevSubClampSpan> DrawSpanRevSubClamp32AVX2Command;
+
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TextureSampler> DrawSprite32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteAddClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteSubClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TextureSampler> DrawSpriteRevSubClamp32AVX2Command;
+
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::FillSampler> FillSprite32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::FillSampler> FillSpriteAddClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::FillSampler> FillSpriteSubClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::FillSampler> FillSpriteRevSubClamp32AVX2Command;
+
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::ShadedSprite, DrawSprite32TModes::ShadedSampler> DrawSpriteShaded32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::AddClampShadedSprite, DrawSprite32TModes::ShadedSampler> DrawSpriteAddClampShaded32AVX2Command;
+
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslated32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedAddClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedSubClamp32AVX2Command;
+	typedef DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TranslatedSampler> DrawSpriteTranslatedRevSubClamp32AVX2Command;
+
+	typedef DrawSky32AVX2T<false> DrawSkySingle32AVX2Command;
+	typedef DrawSky32AVX2T<true> DrawSkyDouble32AVX2Command;
+
+	extern template class DrawWall32AVX2T<DrawWall32TModes::OpaqueWall>;
+	extern template class DrawWall32AVX2T<DrawWall32TModes::MaskedWall>;
+	extern template class DrawWall32AVX2T<DrawWall32TModes::AddClampWall>;
+	extern template class DrawWall32AVX2T<DrawWall32TModes::SubClampWall>;
+	extern template class DrawWall32AVX2T<DrawWall32TModes::RevSubClampWall>;
+
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::OpaqueSpan>;
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::MaskedSpan>;
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::TranslucentSpan>;
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::AddClampSpan>;
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::SubClampSpan>;
+	extern template class DrawSpan32AVX2T<DrawSpan32TModes::RevSubClampSpan>;
+
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TextureSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TextureSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TextureSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TextureSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::FillSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::FillSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::FillSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::FillSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::ShadedSprite, DrawSprite32TModes::ShadedSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampShadedSprite, DrawSprite32TModes::ShadedSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::OpaqueSprite, DrawSprite32TModes::TranslatedSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::AddClampSprite, DrawSprite32TModes::TranslatedSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::SubClampSprite, DrawSprite32TModes::TranslatedSampler>;
+	extern template class DrawSprite32AVX2T<DrawSprite32TModes::RevSubClampSprite, DrawSprite32TModes::TranslatedSampler>;
+
+	extern template class DrawSky32AVX2T<false>;
+	extern template class DrawSky32AVX2T<true>;
+
+#else
+
+	// No AVX2 on this target. CPU.bAVX2 is never set, but the dispatch still needs the names.
+
+	typedef DrawWall32Command DrawWall32AVX2Command;
+	typedef DrawWallMasked32Command DrawWallMasked32AVX2Command;
+	typedef DrawWallAddClamp32Command DrawWallAddClamp32AVX2Command;
+	typedef DrawWallSubClamp32Command DrawWallSubClamp32AVX2Command;
+	typedef DrawWallRevSubClamp32Command DrawWallRevSubClamp32AVX2Command;
+
+	typedef DrawSpan32Command DrawSpan32AVX2Command;
+	typedef DrawSpanMasked32Command DrawSpanMasked32AVX2Command;
+	typedef DrawSpanTranslucent32Command DrawSpanTranslucent32AVX2Command;
+	typedef DrawSpanAddClamp32Command DrawSpanAddClamp32AVX2Command;
+	typedef DrawSpanSubClamp32Command DrawSpanSubClamp32AVX2Command;
+	typedef DrawSpanRevSubClamp32Command DrawSpanRevSubClamp32AVX2Command;
+
+	typedef DrawSprite32Command DrawSprite32AVX2Command;
+	typedef DrawSpriteAddClamp32Command DrawSpriteAddClamp32AVX2Command;
+	typedef DrawSpriteSubClamp32Command DrawSpriteSubClamp32AVX2Command;
+	typedef DrawSpriteRevSubClamp32Command DrawSpriteRevSubClamp32AVX2Command;
+
+	typedef FillSprite32Command FillSprite32AVX2Command;
+	typedef FillSpriteAddClamp32Command FillSpriteAddClamp32AVX2Command;
+	typedef FillSpriteSubClamp32Command FillSpriteSubClamp32AVX2Command;
+	typedef FillSpriteRevSubClamp32Command FillSpriteRevSubClamp32AVX2Command;
+
+	typedef DrawSpriteShaded32Command DrawSpriteShaded32AVX2Command;
+	typedef DrawSpriteAddClampShaded32Command DrawSpriteAddClampShaded32AVX2Command;
+
+	typedef DrawSpriteTranslated32Command DrawSpriteTranslated32AVX2Command;
+	typedef DrawSpriteTranslatedAddClamp32Command DrawSpriteTranslatedAddClamp32AVX2Command;
+	typedef DrawSpriteTranslatedSubClamp32Command DrawSpriteTranslatedSubClamp32AVX2Command;
+	typedef DrawSpriteTranslatedRevSubClamp32Command DrawSpriteTranslatedRevSubClamp32AVX2Command;
+
+	typedef DrawSkySingle32Command DrawSkySingle32AVX2Command;
+	typedef DrawSkyDouble32Command DrawSkyDouble32AVX2Command;
+
+#endif
+}
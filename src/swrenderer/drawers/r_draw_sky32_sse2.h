@@ -50,6 +50,9 @@ namespace swrenderer
 			uint32_t solid_bottom = args.SolidBottomColor();
 			bool fadeSky = args.FadeSky();
 
+			// Lines past the end of the pass belong to another thread
+			count = MIN(count, thread->pass_end_y - args.DestY());
+
 			// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
 			int start_fade = 2; // How fast it should fade out
 			int fade_length = (1 << (24 - start_fade));
@@ -155,6 +158,8 @@ namespace swrenderer
 		}
 		
 		FString DebugInfo() override { return "DrawSkySingle32Command"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
 	};
 	
 	class DrawSkyDouble32Command : public DrawerCommand
@@ -182,6 +187,9 @@ namespace swrenderer
 			uint32_t solid_bottom = args.SolidBottomColor();
 			bool fadeSky = args.FadeSky();
 			
+			// Lines past the end of the pass belong to another thread
+			count = MIN(count, thread->pass_end_y - args.DestY());
+
 			// Find bands for top solid color, top fade, center textured, bottom fade, bottom solid color:
 			int start_fade = 2; // How fast it should fade out
 			int fade_length = (1 << (24 - start_fade));
@@ -310,5 +318,7 @@ namespace swrenderer
 		}
 		
 		FString DebugInfo() override { return "DrawSkyDouble32Command"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
 	};
 }
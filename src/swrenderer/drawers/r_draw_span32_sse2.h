@@ -514,6 +514,8 @@ namespace swrenderer
 		}
 
 		FString DebugInfo() override { return "DrawSpan32T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = 1; return true; }
+		int PixelCount() override { return args.DestX2() - args.DestX1() + 1; }
 	};
 
 	typedef DrawSpan32T<DrawSpan32TModes::OpaqueSpan> DrawSpan32Command;
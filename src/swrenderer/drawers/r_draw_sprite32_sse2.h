@@ -444,6 +444,8 @@ namespace swrenderer
 		}
 
 		FString DebugInfo() override { return "DrawSprite32T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
 	};
 
 	typedef DrawSprite32T<DrawSprite32TModes::CopySprite, DrawSprite32TModes::TextureSampler> DrawSpriteCopy32Command;
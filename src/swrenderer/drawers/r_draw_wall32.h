@@ -332,6 +332,8 @@ namespace swrenderer
 		}
 
 		FString DebugInfo() override { return "DrawWall32T"; }
+		bool LineRange(int &first_line, int &count) override { first_line = args.DestY(); count = args.Count(); return true; }
+		int PixelCount() override { return args.Count(); }
 	};
 
 	typedef DrawWall32T<DrawWall32TModes::OpaqueWall> DrawWall32Command;
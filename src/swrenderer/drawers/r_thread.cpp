@@ -33,13 +33,16 @@
 #include "r_thread.h"
 #include "swrenderer/r_memory.h"
 #include "swrenderer/r_renderthread.h"
+#include "stats.h"
 #include <chrono>
+#include <algorithm>
 
 #ifdef WIN32
 void PeekThreadedErrorPane();
 #endif
 
 CVAR(Bool, r_multithreaded, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+CVAR(Int, r_bandheight, 32, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 /////////////////////////////////////////////////////////////////////////////
 
@@ -124,9 +127,37 @@ void DrawerThreads::WorkerMain(DrawerThread *thread)
 		start_lock.unlock();
 
 		// Do the work:
-		for (auto& command : list->commands)
+		if (list->BandHeight > 0)
 		{
-			command->Execute(thread);
+			// Every command of a band is executed as if this was the only thread, clipped to the band
+			int core = thread->core;
+			int num_cores = thread->num_cores;
+			thread->core = 0;
+			thread->num_cores = 1;
+			// Bands below the last binned command only exist implicitly and hold just the unbinned commands
+			size_t num_bands = list->bands.size();
+			if (!list->unbinned_commands.empty())
+				num_bands = (MAXHEIGHT + list->BandHeight - 1) / list->BandHeight;
+			for (size_t band = core; band < num_bands; band += num_cores)
+			{
+				thread->pass_start_y = (int)band * list->BandHeight;
+				thread->pass_end_y = thread->pass_start_y + list->BandHeight;
+				for (auto& command : band < list->bands.size() ? list->bands[band] : list->unbinned_commands)
+				{
+					command->Execute(thread);
+				}
+			}
+			thread->core = core;
+			thread->num_cores = num_cores;
+			thread->pass_start_y = 0;
+			thread->pass_end_y = MAXHEIGHT;
+		}
+		else
+		{
+			for (auto& command : list->commands)
+			{
+				command->Execute(thread);
+			}
 		}
 
 		// Notify main thread that we finished:
@@ -186,7 +217,112 @@ DrawerCommandQueue::DrawerCommandQueue(RenderMemory *frameMemory) : FrameMemory(
 {
 }
 
+void DrawerCommandQueue::Clear()
+{
+	commands.clear();
+	for (auto &band : bands)
+		band.clear();
+	unbinned_commands.clear();
+
+	int height = BinnedRender ? *r_bandheight : 0;
+	BandHeight = height > 0 ? clamp(height, 8, MAXHEIGHT) : 0;
+}
+
+void DrawerCommandQueue::Bin(DrawerCommand *command)
+{
+	int first_line, count;
+	if (command->LineRange(first_line, count))
+	{
+		int last_line = MIN(first_line + count, MAXHEIGHT) - 1;
+		first_line = MAX(first_line, 0);
+		if (last_line < first_line)
+			return;
+
+		size_t first_band = first_line / BandHeight;
+		size_t last_band = last_line / BandHeight;
+		if (last_band >= bands.size())
+		{
+			// New bands start out with the commands that go to every band
+			size_t old_size = bands.size();
+			bands.resize(last_band + 1);
+			for (size_t i = old_size; i < bands.size(); i++)
+				bands[i] = unbinned_commands;
+		}
+		for (size_t i = first_band; i <= last_band; i++)
+			bands[i].push_back(command);
+	}
+	else
+	{
+		unbinned_commands.push_back(command);
+		for (auto &band : bands)
+			band.push_back(command);
+	}
+}
+
 void *DrawerCommandQueue::AllocMemory(size_t size)
 {
 	return FrameMemory->AllocMemory<uint8_t>((int)size);
 }
+
+/////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	struct DrawerBenchEntry
+	{
+		FString Name;
+		int Commands = 0;
+		double Pixels = 0.0;
+		cycle_t Time;
+	};
+
+	TMap<FString, DrawerBenchEntry> DrawerBenchEntries;
+}
+
+bool DrawerBenchmark::Active = false;
+
+void DrawerBenchmark::Begin()
+{
+	DrawerBenchEntries.Clear();
+	Active = true;
+}
+
+void DrawerBenchmark::Execute(DrawerCommand *command, DrawerThread *thread)
+{
+	FString name = command->DebugInfo();
+	DrawerBenchEntry &entry = DrawerBenchEntries[name];
+	entry.Name = name;
+	entry.Commands++;
+	entry.Pixels += command->PixelCount();
+	entry.Time.Clock();
+	command->Execute(thread);
+	entry.Time.Unclock();
+}
+
+void DrawerBenchmark::End(int frames)
+{
+	Active = false;
+
+	TArray<DrawerBenchEntry *> entries;
+	TMap<FString, DrawerBenchEntry>::Iterator it(DrawerBenchEntries);
+	TMap<FString, DrawerBenchEntry>::Pair *pair;
+	while (it.NextPair(pair))
+		entries.Push(&pair->Value);
+	std::sort(entries.begin(), entries.end(), [](DrawerBenchEntry *a, DrawerBenchEntry *b) { return a->Time.Time() > b->Time.Time(); });
+
+	Printf("Drawer benchmark, %d frames:\n", frames);
+	Printf("%-32s %10s %12s %10s %10s\n", "drawer", "commands", "pixels", "ms/frame", "Mpix/s");
+	double totalms = 0.0;
+	for (DrawerBenchEntry *entry : entries)
+	{
+		double ms = entry->Time.TimeMS();
+		totalms += ms;
+		if (entry->Pixels > 0.0 && ms > 0.0)
+			Printf("%-32s %10d %12.0f %10.3f %10.1f\n", entry->Name.GetChars(), entry->Commands / frames, entry->Pixels / frames, ms / frames, entry->Pixels / (ms * 1000.0));
+		else
+			Printf("%-32s %10d %12s %10.3f %10s\n", entry->Name.GetChars(), entry->Commands / frames, "-", ms / frames, "-");
+	}
+	Printf("Total drawer time: %.3f ms/frame\n", totalms / frames);
+
+	DrawerBenchEntries.Clear();
+}
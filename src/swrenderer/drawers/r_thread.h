@@ -32,6 +32,9 @@
 // Use multiple threads when drawing
 EXTERN_CVAR(Bool, r_multithreaded)
 
+// Height of the screen bands drawer threads are binned into (0 = scanline interleave)
+EXTERN_CVAR(Int, r_bandheight)
+
 // Worker data for each thread executing drawer commands
 class DrawerThread
 {
@@ -45,25 +48,31 @@ public:
 	// Number of active threads
 	int num_cores = 1;
 
+	// Range of lines to process this pass
+	int pass_start_y = 0;
+	int pass_end_y = MAXHEIGHT;
+
 	// Working buffer used by the tilted (sloped) span drawer
 	const uint8_t *tiltlighting[MAXWIDTH];
 
 	// Checks if a line is rendered by this thread
 	bool line_skipped_by_thread(int line)
 	{
-		return line % num_cores != core;
+		return line < pass_start_y || line >= pass_end_y || line % num_cores != core;
 	}
 
 	// The number of lines to skip to reach the first line to be rendered by this thread
 	int skipped_by_thread(int first_line)
 	{
-		int core_skip = (num_cores - (first_line - core) % num_cores) % num_cores;
-		return core_skip;
+		int pass_skip = MAX(pass_start_y - first_line, 0);
+		int core_skip = (num_cores - (first_line + pass_skip - core) % num_cores) % num_cores;
+		return pass_skip + core_skip;
 	}
 
 	// The number of lines to be rendered by this thread
 	int count_for_thread(int first_line, int count)
 	{
+		count = MIN(count, pass_end_y - first_line);
 		int c = (count - skipped_by_thread(first_line) + num_cores - 1) / num_cores;
 		return MAX(c, 0);
 	}
@@ -90,6 +99,24 @@ public:
 
 	virtual void Execute(DrawerThread *thread) = 0;
 	virtual FString DebugInfo() = 0;
+
+	// Lines the command draws to, used to bin it into screen bands.
+	// Commands returning false are executed for every band.
+	virtual bool LineRange(int &first_line, int &count) { return false; }
+
+	// Number of pixels written by the command, used by the drawer benchmark
+	virtual int PixelCount() { return 0; }
+};
+
+// Times each drawer command while bench_drawers is running
+class DrawerBenchmark
+{
+public:
+	static bool Active;
+
+	static void Begin();
+	static void End(int frames);
+	static void Execute(DrawerCommand *command, DrawerThread *thread);
 };
 
 void VectoredTryCatch(void *data, void(*tryBlock)(void *data), void(*catchBlock)(void *data, const char *reason, bool fatal));
@@ -140,34 +167,65 @@ class DrawerCommandQueue
 public:
 	DrawerCommandQueue(RenderMemory *memoryAllocator);
 	
-	void Clear() { commands.clear(); }
+	void Clear();
 	
 	// Queue command to be executed by drawer worker threads
 	template<typename T, typename... Types>
 	void Push(Types &&... args)
 	{
 		DrawerThreads *threads = DrawerThreads::Instance();
-		if (ThreadedRender && r_multithreaded)
+		if (ThreadedRender && r_multithreaded && !DrawerBenchmark::Active)
 		{
 			void *ptr = AllocMemory(sizeof(T));
 			T *command = new (ptr)T(std::forward<Types>(args)...);
 			commands.push_back(command);
+			if (BandHeight > 0)
+				Bin(command);
 		}
 		else
 		{
 			T command(std::forward<Types>(args)...);
-			command.Execute(&threads->single_core_thread);
+			if (!DrawerBenchmark::Active)
+				command.Execute(&threads->single_core_thread);
+			else
+				DrawerBenchmark::Execute(&command, &threads->single_core_thread);
 		}
 	}
 	
 	bool ThreadedRender = true;
+
+	// Bin commands into bands of r_bandheight lines, each owned by a single worker
+	bool BinnedRender = false;
 	
 private:
 	// Allocate memory valid for the duration of a command execution
 	void *AllocMemory(size_t size);
+
+	// Add command to the lists of the bands it touches
+	void Bin(DrawerCommand *command);
 	
 	std::vector<DrawerCommand *> commands;
+
+	int BandHeight = 0;
+	std::vector<std::vector<DrawerCommand *>> bands;
+	std::vector<DrawerCommand *> unbinned_commands;
 	RenderMemory *FrameMemory;
 	
 	friend class DrawerThreads;
 };
+
+namespace swrenderer
+{
+	// True when the AVX2 drawer commands are enabled and supported by the CPU
+	bool UseAVX2Drawers();
+
+	// Queues the AVX2 version of a drawer command when UseAVX2Drawers allows it
+	template<typename Command, typename AVX2Command, typename ArgsT>
+	void PushDrawer(const DrawerCommandQueuePtr &queue, const ArgsT &args)
+	{
+		if (UseAVX2Drawers())
+			queue->Push<AVX2Command>(args);
+		else
+			queue->Push<Command>(args);
+	}
+}
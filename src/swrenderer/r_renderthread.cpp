@@ -64,6 +64,7 @@ namespace swrenderer
 		Viewport.reset(new RenderViewport());
 		Light.reset(new LightVisibility());
 		DrawQueue.reset(new DrawerCommandQueue(FrameMemory.get()));
+		DrawQueue->BinnedRender = true;
 		OpaquePass.reset(new RenderOpaquePass(this));
 		TranslucentPass.reset(new RenderTranslucentPass(this));
 		SpriteList.reset(new VisibleSpriteList());
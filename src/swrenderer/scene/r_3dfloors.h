@@ -93,6 +93,10 @@ namespace swrenderer
 		HeightLevel *height_cur = nullptr;
 		int CurrentSkybox = 0;
 
+		// Incremented for every line portal so that fake floor clips are started over.
+		// Kept per thread as the global validcount is not safe to use from the scene threads.
+		int validCount = 0;
+
 	private:
 		int height_max = -1;
 		TArray<HeightStack> toplist;
@@ -332,7 +332,34 @@ namespace swrenderer
 
 	// Checks BSP node/subtree bounding box.
 	// Returns true if some part of the bbox might be visible.
-	bool RenderOpaquePass::CheckBBox(float *bspcoord)
+	bool RenderOpaquePass::CheckBBox(node_t *bsp, int side)
+	{
+		// The shared results are only valid for the main view of the frame
+		RenderPortal *renderportal = Thread->Portal.get();
+		SharedBSPCulling *shared = (renderportal->CurrentPortal == nullptr && !renderportal->CurrentPortalInSkybox) ? Thread->Scene->BSPCulling() : nullptr;
+
+		SharedBSPCulling::BoxResult result;
+		int sx1, sx2;
+		if (!shared || !shared->Lookup(bsp, side, result, sx1, sx2))
+		{
+			result = ProjectBBox(bsp->bbox[side], sx1, sx2);
+			if (shared)
+				shared->Store(bsp, side, result, sx1, sx2);
+		}
+
+		if (result == SharedBSPCulling::BoxCulled)
+			return false;
+		else if (result == SharedBSPCulling::BoxVisible)
+			return true;
+
+		// Find the first clippost that touches the source post
+		//	(adjacent pixels are touching).
+
+		return Thread->ClipSegments->IsVisible(sx1, sx2);
+	}
+
+	// Projects a bounding box to the screen columns it covers
+	SharedBSPCulling::BoxResult RenderOpaquePass::ProjectBBox(float *bspcoord, int &sx1, int &sx2)
 	{
 		static const int checkcoord[12][4] =
 		{
@@ -355,7 +382,6 @@ namespace swrenderer
 
 		double	 			x1, y1, x2, y2;
 		double				rx1, ry1, rx2, ry2;
-		int					sx1, sx2;
 
 		// Find the corners of the box
 		// that define the edges from current viewpoint.
@@ -375,7 +401,7 @@ namespace swrenderer
 
 		boxpos = (boxy << 2) + boxx;
 		if (boxpos == 5)
-			return true;
+			return SharedBSPCulling::BoxVisible;
 
 		x1 = bspcoord[checkcoord[boxpos][0]] - Thread->Viewport->viewpoint.Pos.X;
 		y1 = bspcoord[checkcoord[boxpos][1]] - Thread->Viewport->viewpoint.Pos.Y;
@@ -386,7 +412,7 @@ namespace swrenderer
 
 		// Sitting on a line?
 		if (y1 * (x1 - x2) + x1 * (y2 - y1) >= -EQUAL_EPSILON)
-			return true;
+			return SharedBSPCulling::BoxVisible;
 
 		rx1 = x1 * Thread->Viewport->viewpoint.Sin - y1 * Thread->Viewport->viewpoint.Cos;
 		rx2 = x2 * Thread->Viewport->viewpoint.Sin - y2 * Thread->Viewport->viewpoint.Cos;
@@ -405,34 +431,31 @@ namespace swrenderer
 
 		if (rx1 >= -ry1)
 		{
-			if (rx1 > ry1) return false;	// left edge is off the right side
-			if (ry1 == 0) return false;
+			if (rx1 > ry1) return SharedBSPCulling::BoxCulled;	// left edge is off the right side
+			if (ry1 == 0) return SharedBSPCulling::BoxCulled;
 			sx1 = xs_RoundToInt(viewport->CenterX + rx1 * viewport->CenterX / ry1);
 		}
 		else
 		{
-			if (rx2 < -ry2) return false;	// wall is off the left side
-			if (rx1 - rx2 - ry2 + ry1 == 0) return false;	// wall does not intersect view volume
+			if (rx2 < -ry2) return SharedBSPCulling::BoxCulled;	// wall is off the left side
+			if (rx1 - rx2 - ry2 + ry1 == 0) return SharedBSPCulling::BoxCulled;	// wall does not intersect view volume
 			sx1 = 0;
 		}
 
 		if (rx2 <= ry2)
 		{
-			if (rx2 < -ry2) return false;	// right edge is off the left side
-			if (ry2 == 0) return false;
+			if (rx2 < -ry2) return SharedBSPCulling::BoxCulled;	// right edge is off the left side
+			if (ry2 == 0) return SharedBSPCulling::BoxCulled;
 			sx2 = xs_RoundToInt(viewport->CenterX + rx2 * viewport->CenterX / ry2);
 		}
 		else
 		{
-			if (rx1 > ry1) return false;	// wall is off the right side
-			if (ry2 - ry1 - rx2 + rx1 == 0) return false;	// wall does not intersect view volume
+			if (rx1 > ry1) return SharedBSPCulling::BoxCulled;	// wall is off the right side
+			if (ry2 - ry1 - rx2 + rx1 == 0) return SharedBSPCulling::BoxCulled;	// wall does not intersect view volume
 			sx2 = viewwidth;
 		}
 
-		// Find the first clippost that touches the source post
-		//	(adjacent pixels are touching).
-
-		return Thread->ClipSegments->IsVisible(sx1, sx2);
+		return SharedBSPCulling::BoxRange;
 	}
 
 	void RenderOpaquePass::AddPolyobjs(subsector_t *sub)
@@ -635,9 +658,9 @@ namespace swrenderer
 				if (clip3d->fakeFloor->fakeFloor->alpha == 0) continue;
 				if (clip3d->fakeFloor->fakeFloor->flags & FF_THISINSIDE && clip3d->fakeFloor->fakeFloor->flags & FF_INVERTSECTOR) continue;
 				clip3d->fakeAlpha = MIN<fixed_t>(Scale(clip3d->fakeFloor->fakeFloor->alpha, OPAQUE, 255), OPAQUE);
-				if (clip3d->fakeFloor->validcount != validcount)
+				if (clip3d->fakeFloor->validcount != clip3d->validCount)
 				{
-					clip3d->fakeFloor->validcount = validcount;
+					clip3d->fakeFloor->validcount = clip3d->validCount;
 					clip3d->NewClip();
 				}
 				double fakeHeight = clip3d->fakeFloor->fakeFloor->top.plane->ZatPoint(frontsector->centerspot);
@@ -698,9 +721,9 @@ namespace swrenderer
 				if (!(clip3d->fakeFloor->fakeFloor->flags & FF_THISINSIDE) && (clip3d->fakeFloor->fakeFloor->flags & (FF_SWIMMABLE | FF_INVERTSECTOR)) == (FF_SWIMMABLE | FF_INVERTSECTOR)) continue;
 				clip3d->fakeAlpha = MIN<fixed_t>(Scale(clip3d->fakeFloor->fakeFloor->alpha, OPAQUE, 255), OPAQUE);
 
-				if (clip3d->fakeFloor->validcount != validcount)
+				if (clip3d->fakeFloor->validcount != clip3d->validCount)
 				{
-					clip3d->fakeFloor->validcount = validcount;
+					clip3d->fakeFloor->validcount = clip3d->validCount;
 					clip3d->NewClip();
 				}
 				double fakeHeight = clip3d->fakeFloor->fakeFloor->bottom.plane->ZatPoint(frontsector->centerspot);
@@ -809,9 +832,9 @@ namespace swrenderer
 						tempsec = *clip3d->fakeFloor->fakeFloor->model;
 						tempsec.floorplane = *clip3d->fakeFloor->fakeFloor->top.plane;
 						tempsec.ceilingplane = *clip3d->fakeFloor->fakeFloor->bottom.plane;
-						if (clip3d->fakeFloor->validcount != validcount)
+						if (clip3d->fakeFloor->validcount != clip3d->validCount)
 						{
-							clip3d->fakeFloor->validcount = validcount;
+							clip3d->fakeFloor->validcount = clip3d->validCount;
 							clip3d->NewClip();
 						}
 						renderline.Render(line, InSubsector, frontsector, &tempsec, floorplane, ceilingplane, foggy, basecolormap); // fake
@@ -871,7 +894,7 @@ namespace swrenderer
 
 			// Possibly divide back space (away from the viewer).
 			side ^= 1;
-			if (!CheckBBox(bsp->bbox[side]))
+			if (!CheckBBox(bsp, side))
 				return;
 
 			node = bsp->children[side];
@@ -989,9 +1012,15 @@ namespace swrenderer
 
 	bool RenderOpaquePass::IsPotentiallyVisible(AActor *thing)
 	{
+		if (thing == nullptr)
+			return false;
+
+		// Line portals decide the camera visibility per thread instead of changing its render flags
+		RenderPortal *renderportal = Thread->Portal.get();
+		bool invisible = (thing == Thread->Viewport->viewpoint.camera && renderportal->CurrentPortal) ? renderportal->CameraInvisible : !!(thing->renderflags & RF_INVISIBLE);
+
 		// Don't waste time projecting sprites that are definitely not visible.
-		if (thing == nullptr ||
-			(thing->renderflags & RF_INVISIBLE) ||
+		if (invisible ||
 			!thing->RenderStyle.IsVisible(thing->Alpha) ||
 			!thing->IsVisibleToPlayer() ||
 			!thing->IsInsideVisibleAngles())
@@ -1007,7 +1036,6 @@ namespace swrenderer
 
 		// [ZZ] Or less definitely not visible (hue)
 		// [ZZ] 10.01.2016: don't try to clip stuff inside a skybox against the current portal.
-		RenderPortal *renderportal = Thread->Portal.get();
 		if (!renderportal->CurrentPortalInSkybox && renderportal->CurrentPortal && !!P_PointOnLineSidePrecise(thing->Pos(), renderportal->CurrentPortal->dst))
 			return false;
 
@@ -1130,4 +1158,67 @@ namespace swrenderer
 
 		return true;
 	}
+
+	/////////////////////////////////////////////////////////////////////////
+
+	void SharedBSPCulling::BeginFrame()
+	{
+		unsigned int count = level.nodes.Size() * 2;
+		if (count > NumBoxes)
+		{
+			Boxes.reset(new std::atomic<uint64_t>[count]);
+			NumBoxes = count;
+			for (unsigned int i = 0; i < NumBoxes; i++)
+				Boxes[i].store(0, std::memory_order_relaxed);
+			FrameNumber = 0;
+		}
+
+		FrameNumber++;
+		if (FrameNumber == 0)
+		{
+			for (unsigned int i = 0; i < NumBoxes; i++)
+				Boxes[i].store(0, std::memory_order_relaxed);
+			FrameNumber = 1;
+		}
+	}
+
+	int SharedBSPCulling::BoxIndex(const node_t *node, int side) const
+	{
+		// Polyobject BSPs are not part of the level node list
+		if (level.nodes.Size() == 0 || node < &level.nodes[0] || node >= &level.nodes[0] + level.nodes.Size())
+			return -1;
+
+		unsigned int index = (unsigned int)(node - &level.nodes[0]) * 2 + side;
+		return index < NumBoxes ? (int)index : -1;
+	}
+
+	bool SharedBSPCulling::Lookup(const node_t *node, int side, BoxResult &result, int &sx1, int &sx2) const
+	{
+		int index = BoxIndex(node, side);
+		if (index == -1)
+			return false;
+
+		// Each entry is [frame number:32][result:2][sx1:15][sx2:15]
+		uint64_t entry = Boxes[index].load(std::memory_order_relaxed);
+		if ((uint32_t)(entry >> 32) != FrameNumber)
+			return false;
+
+		result = (BoxResult)((entry >> 30) & 3);
+		sx1 = (int)((entry >> 15) & 0x7fff);
+		sx2 = (int)(entry & 0x7fff);
+		return true;
+	}
+
+	void SharedBSPCulling::Store(const node_t *node, int side, BoxResult result, int sx1, int sx2)
+	{
+		int index = BoxIndex(node, side);
+		if (index == -1)
+			return;
+
+		if (result != BoxRange)
+			sx1 = sx2 = 0;
+
+		uint64_t entry = ((uint64_t)FrameNumber << 32) | ((uint64_t)result << 30) | ((uint64_t)(sx1 & 0x7fff) << 15) | (uint64_t)(sx2 & 0x7fff);
+		Boxes[index].store(entry, std::memory_order_relaxed);
+	}
 }
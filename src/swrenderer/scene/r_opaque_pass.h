@@ -27,6 +27,8 @@
 #include "swrenderer/line/r_line.h"
 #include "swrenderer/scene/r_3dfloors.h"
 #include <set>
+#include <atomic>
+#include <memory>
 
 struct FVoxelDef;
 
@@ -58,6 +60,31 @@ namespace swrenderer
 		int renderflags;
 	};
 
+	// Screen space extents of the BSP node bounding boxes as seen from the main view.
+	// Every scene thread walks the same BSP from the same viewpoint, so each box is projected
+	// by whichever thread reaches it first and the result is reused by the other threads.
+	class SharedBSPCulling
+	{
+	public:
+		enum BoxResult
+		{
+			BoxCulled,
+			BoxVisible,
+			BoxRange
+		};
+
+		void BeginFrame();
+		bool Lookup(const node_t *node, int side, BoxResult &result, int &sx1, int &sx2) const;
+		void Store(const node_t *node, int side, BoxResult result, int sx1, int sx2);
+
+	private:
+		int BoxIndex(const node_t *node, int side) const;
+
+		std::unique_ptr<std::atomic<uint64_t>[]> Boxes;
+		unsigned int NumBoxes = 0;
+		uint32_t FrameNumber = 0;
+	};
+
 	class RenderOpaquePass
 	{
 	public:
@@ -80,7 +107,8 @@ namespace swrenderer
 		void RenderBSPNode(void *node);
 		void RenderSubsector(subsector_t *sub);
 
-		bool CheckBBox(float *bspcoord);
+		bool CheckBBox(node_t *bsp, int side);
+		SharedBSPCulling::BoxResult ProjectBBox(float *bspcoord, int &sx1, int &sx2);
 		void AddPolyobjs(subsector_t *sub);
 		void FakeDrawLoop(subsector_t *sub, VisiblePlane *floorplane, VisiblePlane *ceilingplane, bool foggy, FDynamicColormap *basecolormap);
 
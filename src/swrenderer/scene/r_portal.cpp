@@ -330,9 +330,8 @@ namespace swrenderer
 		DAngle startang = viewpoint.Angles.Yaw;
 		DVector3 startpos = viewpoint.Pos;
 		DVector3 savedpath[2] = { viewpoint.Path[0], viewpoint.Path[1] };
-		ActorRenderFlags savedvisibility = viewpoint.camera ? viewpoint.camera->renderflags & RF_INVISIBLE : ActorRenderFlags::FromInt(0);
-		
-		viewpoint.camera->renderflags &= ~RF_INVISIBLE;
+		bool savedinvisible = CameraInvisible;
+		CameraInvisible = false;
 
 		CurrentPortalUniq++;
 
@@ -389,7 +388,7 @@ namespace swrenderer
 
 					if (dist1 + dist2 < distp + 1)
 					{
-						viewpoint.camera->renderflags |= RF_INVISIBLE;
+						CameraInvisible = true;
 					}
 				}
 			}
@@ -403,7 +402,7 @@ namespace swrenderer
 
 		CopyStackedViewParameters();
 
-		validcount++;
+		Thread->Clip3D->validCount++;
 		PortalDrawseg* prevpds = CurrentPortal;
 		CurrentPortal = pds;
 
@@ -434,7 +433,7 @@ namespace swrenderer
 
 		Thread->OpaquePass->RenderScene();
 		Thread->Clip3D->ResetClip(); // reset clips (floor/ceiling)
-		if (!savedvisibility && viewpoint.camera) viewpoint.camera->renderflags &= ~RF_INVISIBLE;
+		CameraInvisible = savedinvisible;
 
 		Thread->PlaneList->Render();
 		RenderPlanePortals();
@@ -531,6 +530,7 @@ namespace swrenderer
 		MirrorFlags = 0;
 		CurrentPortal = nullptr;
 		CurrentPortalUniq = 0;
+		CameraInvisible = false;
 		WallPortals.Clear();
 		SectorPortalsInSkyBox.clear();
 	}
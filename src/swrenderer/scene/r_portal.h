@@ -51,6 +51,7 @@ namespace swrenderer
 		PortalDrawseg* CurrentPortal = nullptr;
 		int CurrentPortalUniq = 0;
 		bool CurrentPortalInSkybox = false;
+		bool CameraInvisible = false; // Hides the camera actor inside the current line portal
 
 		// These are copies of the main parameters used when drawing stacked sectors.
 		// When you change the main parameters, you should copy them here too *unless*
@@ -66,9 +66,18 @@ void PeekThreadedErrorPane();
 EXTERN_CVAR(Bool, r_shadercolormaps)
 EXTERN_CVAR(Int, r_clearbuffer)
 
-CVAR(Bool, r_scene_multithreaded, false, 0);
+CVAR(Bool, r_scene_multithreaded, true, 0);
 CVAR(Bool, r_models, false, 0);
 
+static int BenchDrawerFrames;
+
+// Renders the current view N times on a single thread and reports the time spent in each drawer
+CCMD(bench_drawers)
+{
+	int frames = argv.argc() > 1 ? atoi(argv[1]) : 100;
+	BenchDrawerFrames = clamp(frames, 1, 10000);
+}
+
 namespace swrenderer
 {
 	cycle_t WallCycles, PlaneCycles, MaskedCycles, DrawerWaitCycles;
@@ -76,6 +85,7 @@ namespace swrenderer
 	RenderScene::RenderScene()
 	{
 		Threads.push_back(std::unique_ptr<RenderThread>(new RenderThread(this)));
+		SharedCulling.reset(new SharedBSPCulling());
 	}
 
 	RenderScene::~RenderScene()
@@ -128,6 +138,25 @@ namespace swrenderer
 		DrawerWaitCycles.Clock();
 		DrawerThreads::WaitForWorkers();
 		DrawerWaitCycles.Unclock();
+
+		if (BenchDrawerFrames > 0)
+		{
+			int frames = BenchDrawerFrames;
+			BenchDrawerFrames = 0;
+			BenchmarkDrawers(player, frames);
+		}
+	}
+
+	void RenderScene::BenchmarkDrawers(player_t *player, int frames)
+	{
+		// Commands execute as they are queued so that each one can be timed on its own
+		DrawerBenchmark::Begin();
+		for (int i = 0; i < frames; i++)
+		{
+			RenderActorView(player->mo);
+			DrawerThreads::WaitForWorkers();
+		}
+		DrawerBenchmark::End(frames);
 	}
 
 	void RenderScene::RenderActorView(AActor *actor, bool dontmaplines)
@@ -199,7 +228,7 @@ namespace swrenderer
 		if (numThreads == 0)
 			numThreads = 4;
 
-		if (!r_scene_multithreaded || !r_multithreaded)
+		if (!r_scene_multithreaded || !r_multithreaded || DrawerBenchmark::Active)
 			numThreads = 1;
 
 		if (numThreads != (int)Threads.size())
@@ -208,14 +237,21 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		// Camera textures get equal slices so that they do not disturb the balance of the main view
+		bool evenSlices = MainThread()->Viewport->RenderingToCanvas();
+		if (!evenSlices)
+			BalanceSlices(numThreads);
+
+		SharedCulling->BeginFrame();
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
 		for (int i = 0; i < numThreads; i++)
 		{
 			*Threads[i]->Viewport = *MainThread()->Viewport;
 			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			Threads[i]->X1 = evenSlices ? viewwidth * i / numThreads : SliceEdges[i];
+			Threads[i]->X2 = evenSlices ? viewwidth * (i + 1) / numThreads : SliceEdges[i + 1];
 		}
 		run_id++;
 		start_lock.unlock();
@@ -252,8 +288,57 @@ namespace swrenderer
 		MainThread()->X2 = viewwidth;
 	}
 
+	void RenderScene::BalanceSlices(int numThreads)
+	{
+		// Start over with equal slices whenever the layout changes
+		if ((int)SliceEdges.size() != numThreads + 1 || SliceEdges.back() != viewwidth)
+		{
+			SliceEdges.resize(numThreads + 1);
+			for (int i = 0; i <= numThreads; i++)
+				SliceEdges[i] = viewwidth * i / numThreads;
+			for (auto &thread : Threads)
+				thread->SliceTime = 0.0;
+			return;
+		}
+
+		double totalTime = 0.0;
+		for (int i = 0; i < numThreads; i++)
+			totalTime += Threads[i]->SliceTime;
+		if (totalTime <= 0.0)
+			return;
+
+		// Assume the time of each slice in the last frame was spread evenly over its columns and
+		// place the new edges where the accumulated time reaches equal shares of the total.
+		std::vector<int> balanced(numThreads + 1);
+		int slice = 0;
+		double sliceStartTime = 0.0;
+		for (int i = 1; i < numThreads; i++)
+		{
+			double target = totalTime * i / numThreads;
+			while (slice < numThreads - 1 && sliceStartTime + Threads[slice]->SliceTime < target)
+			{
+				sliceStartTime += Threads[slice]->SliceTime;
+				slice++;
+			}
+
+			double sliceTime = Threads[slice]->SliceTime;
+			double t = sliceTime > 0.0 ? clamp((target - sliceStartTime) / sliceTime, 0.0, 1.0) : 0.5;
+			double x = SliceEdges[slice] + (SliceEdges[slice + 1] - SliceEdges[slice]) * t;
+
+			// Only move half way there to dampen oscillation caused by frame to frame noise
+			balanced[i] = xs_RoundToInt((SliceEdges[i] + x) * 0.5);
+		}
+
+		// Keep every slice wide enough that its fixed setup cost does not dominate
+		int minWidth = viewwidth / (numThreads * 4);
+		for (int i = 1; i < numThreads; i++)
+			SliceEdges[i] = clamp(balanced[i], SliceEdges[i - 1] + minWidth, viewwidth - (numThreads - i) * minWidth);
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
+		auto startTime = std::chrono::steady_clock::now();
+
 		thread->DrawQueue->Clear();
 		thread->FrameMemory->Clear();
 		thread->Clip3D->Cleanup();
@@ -296,6 +381,9 @@ namespace swrenderer
 				NetUpdate();
 		}
 
+		if (!thread->Viewport->RenderingToCanvas())
+			thread->SliceTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
 		DrawerThreads::Execute(thread->DrawQueue);
 	}
 
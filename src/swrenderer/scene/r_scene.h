@@ -37,6 +37,7 @@ namespace swrenderer
 	extern cycle_t WallCycles, PlaneCycles, MaskedCycles, DrawerWaitCycles;
 
 	class RenderThread;
+	class SharedBSPCulling;
 	
 	class RenderScene
 	{
@@ -56,12 +57,15 @@ namespace swrenderer
 		bool DontMapLines() const { return dontmaplines; }
 
 		RenderThread *MainThread() { return Threads.front().get(); }
+		SharedBSPCulling *BSPCulling() { return SharedCulling.get(); }
 
 	private:
 		void RenderActorView(AActor *actor, bool dontmaplines = false);
 		void RenderThreadSlices();
 		void RenderThreadSlice(RenderThread *thread);
+		void BalanceSlices(int numThreads);
 		void RenderPSprites();
+		void BenchmarkDrawers(player_t *player, int frames);
 
 		void StartThreads(size_t numThreads);
 		void StopThreads();
@@ -70,6 +74,8 @@ namespace swrenderer
 		int clearcolor = 0;
 
 		std::vector<std::unique_ptr<RenderThread>> Threads;
+		std::vector<int> SliceEdges;
+		std::unique_ptr<SharedBSPCulling> SharedCulling;
 		std::mutex start_mutex;
 		std::condition_variable start_condition;
 		bool shutdown_flag = false;
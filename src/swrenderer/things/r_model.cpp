@@ -194,6 +194,7 @@ namespace swrenderer
 		args.SetTransform(transform);
 		args.SetFaceCullCCW(true);
 		args.SetClipPlane(0, PolyClipPlane());
+		ClipToSlice(args, *transform);
 		args.SetStyle(TriBlendMode::TextureOpaque);
 
 		if (Thread->Viewport->RenderTarget->IsBgra())
@@ -232,6 +233,7 @@ namespace swrenderer
 		args.SetTransform(transform);
 		args.SetFaceCullCCW(true);
 		args.SetClipPlane(0, PolyClipPlane());
+		ClipToSlice(args, *transform);
 		args.SetStyle(TriBlendMode::TextureOpaque);
 
 		if (Thread->Viewport->RenderTarget->IsBgra())
@@ -245,6 +247,29 @@ namespace swrenderer
 		args.DrawElements(Thread->DrawQueue, VertexBuffer, IndexBuffer + offset / sizeof(unsigned int), numIndices);
 	}
 
+	// Sprites and decals skip the columns outside the thread's slice in DrawMaskedColumn.
+	// Models go through the triangle drawer, so they get clipped by two planes at the slice edges.
+	void SWModelRenderer::ClipToSlice(PolyDrawArgs &args, const TriMatrix &objectToClip)
+	{
+		if (Thread->X1 <= 0 && Thread->X2 >= viewwidth)
+			return;
+
+		// A screen column x is where x_clip / w_clip == 2 * x / viewwidth - 1.
+		float left = 2.0f * Thread->X1 / viewwidth - 1.0f;
+		float right = 2.0f * Thread->X2 / viewwidth - 1.0f;
+
+		// The clip distances are computed from the untransformed vertices, so the planes need to be moved to object space.
+		const float *m = objectToClip.matrix;
+		float l[4], r[4];
+		for (int col = 0; col < 4; col++)
+		{
+			l[col] = m[0 + col * 4] - left * m[3 + col * 4];
+			r[col] = right * m[3 + col * 4] - m[0 + col * 4];
+		}
+		args.SetClipPlane(1, PolyClipPlane(l[0], l[1], l[2], l[3]));
+		args.SetClipPlane(2, PolyClipPlane(r[0], r[1], r[2], r[3]));
+	}
+
 	double SWModelRenderer::GetTimeFloat()
 	{
 		return (double)screen->FrameTime * (double)TICRATE / 1000.0;
@@ -120,8 +120,10 @@ namespace swrenderer
 		// calculate edges of the shape
 		double psize = particle->size / 8.0;
 
-		x1 = MAX<int>(renderportal->WindowLeft, thread->Viewport->viewwindow.centerx + xs_RoundToInt((tx - psize) * xscale));
-		x2 = MIN<int>(renderportal->WindowRight, thread->Viewport->viewwindow.centerx + xs_RoundToInt((tx + psize) * xscale));
+		int texx1 = thread->Viewport->viewwindow.centerx + xs_RoundToInt((tx - psize) * xscale);
+		int texx2 = thread->Viewport->viewwindow.centerx + xs_RoundToInt((tx + psize) * xscale);
+		x1 = MAX<int>(renderportal->WindowLeft, texx1);
+		x2 = MIN<int>(renderportal->WindowRight, texx2);
 
 		if (x1 >= x2)
 			return;
@@ -212,6 +214,8 @@ namespace swrenderer
 		vis->y2 = y2;
 		vis->x1 = x1;
 		vis->x2 = x2;
+		vis->texx1 = texx1;
+		vis->texx2 = texx2;
 		vis->Translation = 0;
 		vis->startfrac = 255 & (particle->color >> 24);
 		vis->pic = NULL;
@@ -251,8 +255,10 @@ namespace swrenderer
 
 		spacing = viewport->RenderTarget->GetPitch();
 
-		uint32_t fracstepx = PARTICLE_TEXTURE_SIZE * FRACUNIT / countbase;
-		uint32_t fracposx = fracstepx / 2;
+		// Texture coordinates come from the unclipped extent so that a particle cut by a
+		// portal window or a scene slice boundary lines up with its other half
+		uint32_t fracstepx = PARTICLE_TEXTURE_SIZE * FRACUNIT / (texx2 - texx1);
+		uint32_t fracposx = fracstepx / 2 + fracstepx * (x1 - texx1);
 
 		RenderTranslucentPass *translucentPass = thread->TranslucentPass.get();
 
@@ -22,6 +22,7 @@ namespace swrenderer
 		fixed_t xscale = 0;
 		fixed_t	startfrac = 0; // horizontal position of x1
 		int y1 = 0, y2 = 0;
+		int texx1 = 0, texx2 = 0; // horizontal extent before clipping to the portal window
 
 		uint32_t Translation = 0;
 		uint32_t FillColor = 0;
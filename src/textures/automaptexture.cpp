@@ -134,7 +134,7 @@ void FAutomapTexture::Unload ()
 void FAutomapTexture::MakeTexture ()
 {
 	int x, y;
-	FMemLump data = Wads.ReadLump (SourceLump);
+	FMemLump data = Wads.MapLump (SourceLump);
 	const uint8_t *indata = (const uint8_t *)data.GetMem();
 
 	Pixels = new uint8_t[Width * Height];
@@ -202,7 +202,7 @@ const uint8_t *FIMGZTexture::GetPixels ()
 
 void FIMGZTexture::MakeTexture ()
 {
-	FMemLump lump = Wads.ReadLump (SourceLump);
+	FMemLump lump = Wads.MapLump (SourceLump);
 	const ImageHeader *imgz = (const ImageHeader *)lump.GetMem();
 	const uint8_t *data = (const uint8_t *)&imgz[1];
 
@@ -947,12 +947,12 @@ void FTextureManager::AddTexturesLumps (int lump1, int lump2, int patcheslump)
 
 	if (lump1 >= 0)
 	{
-		FMemLump texdir = Wads.ReadLump (lump1);
+		FMemLump texdir = Wads.MapLump (lump1);
 		AddTexturesLump (texdir.GetMem(), Wads.LumpLength (lump1), lump1, patcheslump, firstdup, true);
 	}
 	if (lump2 >= 0)
 	{
-		FMemLump texdir = Wads.ReadLump (lump2);
+		FMemLump texdir = Wads.MapLump (lump2);
 		AddTexturesLump (texdir.GetMem(), Wads.LumpLength (lump2), lump2, patcheslump, firstdup, false);
 	}
 }
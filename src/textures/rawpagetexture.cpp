@@ -255,7 +255,7 @@ const uint8_t *FRawPageTexture::GetPixels ()
 
 void FRawPageTexture::MakeTexture ()
 {
-	FMemLump lump = Wads.ReadLump (SourceLump);
+	FMemLump lump = Wads.MapLump (SourceLump);
 	const uint8_t *source = (const uint8_t *)lump.GetMem();
 	const uint8_t *source_p = source;
 	uint8_t *dest_p;
@@ -58,6 +58,9 @@
 #include "md5.h"
 #include "doomstat.h"
 #include "vm.h"
+#include "c_console.h"
+#include "parallel_for.h"
+#include <exception>
 
 // MACROS ------------------------------------------------------------------
 
@@ -72,6 +75,27 @@ struct FWadCollection::LumpRecord
 	FResourceLump *lump;
 };
 
+// A file whose directory has already been read on a worker thread.
+// It owns the reader and resource file until AddFile takes them, so that
+// nothing leaks when the batch is abandoned because one file failed.
+struct FPreparedWadFile
+{
+	bool Ready = false;
+	FileReader *Reader = NULL;
+	FResourceFile *ResFile = NULL;
+	FCapturedOutput Output;
+	std::exception_ptr Error;
+
+	FPreparedWadFile() = default;
+	FPreparedWadFile(const FPreparedWadFile &) = delete;
+	FPreparedWadFile &operator=(const FPreparedWadFile &) = delete;
+	~FPreparedWadFile()
+	{
+		if (ResFile != NULL) delete ResFile;	// this also deletes the reader
+		else delete Reader;
+	}
+};
+
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 extern bool nospriterename;
 
@@ -80,6 +104,8 @@ extern bool nospriterename;
 // PRIVATE FUNCTION PROTOTYPES ---------------------------------------------
 
 static void PrintLastError ();
+static FileReader *OpenWadReader(const char *filename);
+static void PrepareFile(const char *filename, FPreparedWadFile &prepared);
 
 // PUBLIC DATA DEFINITIONS -------------------------------------------------
 
@@ -172,10 +198,22 @@ void FWadCollection::InitMultipleFiles (TArray<FString> &filenames)
 	DeleteAll();
 	numfiles = 0;
 
+	// Reading the archive directories is independent for each file, so it
+	// gets done for all of them at once. The results are added in order
+	// afterward so that lump numbering is not affected.
+	TArray<FPreparedWadFile> prepared;
+	if (filenames.Size() > 1)
+	{
+		prepared.Resize(filenames.Size());
+		parallel_for((int)filenames.Size(), [&](int i)
+		{
+			PrepareFile(filenames[i], prepared[i]);
+		});
+	}
+
 	for(unsigned i=0;i<filenames.Size(); i++)
 	{
-		int baselump = NumLumps;
-		AddFile (filenames[i]);
+		AddFile (filenames[i], NULL, prepared.Size() > 0 ? &prepared[i] : NULL);
 	}
 
 	NumLumps = LumpInfo.Size();
@@ -195,6 +233,44 @@ void FWadCollection::InitMultipleFiles (TArray<FString> &filenames)
 	InitHashChains ();
 	LumpInfo.ShrinkToFit();
 	Files.ShrinkToFit();
+	PrefetchStartupLumps();
+}
+
+//==========================================================================
+//
+// PrefetchStartupLumps
+//
+// Starts decompressing the lumps that get parsed during startup in the
+// background, so the main thread finds them ready when it gets to them.
+// Only definition lumps that are read completely on every startup are
+// included, since anything prefetched stays in memory.
+//
+//==========================================================================
+
+void FWadCollection::PrefetchStartupLumps()
+{
+	static const char *const startuplumps[] =
+	{
+		"MAPINFO", "ZMAPINFO", "DECORATE", "ZSCRIPT", "TEXTURES", "SNDINFO",
+		"LANGUAGE", "GLDEFS", "ANIMDEFS", "FONTDEFS", "KEYCONF", NULL
+	};
+
+	for (unsigned i = 0; i < NumLumps; i++)
+	{
+		FResourceLump *lump = LumpInfo[i].lump;
+
+		if (lump->Namespace == ns_global)
+		{
+			for (int j = 0; startuplumps[j] != NULL; j++)
+			{
+				if (!strcmp(lump->Name, startuplumps[j]))
+				{
+					lump->Prefetch();
+					break;
+				}
+			}
+		}
+	}
 }
 
 //-----------------------------------------------------------------------
@@ -215,6 +291,67 @@ int FWadCollection::AddExternalFile(const char *filename)
 	return LumpInfo.Size()-1;	// later
 }
 
+//==========================================================================
+//
+// OpenWadReader
+//
+// Files that stay open for the whole session get mapped into memory so
+// that their uncompressed lumps can be accessed without copying.
+// 32 bit builds would run out of address space with large mod sets.
+//
+//==========================================================================
+
+static FileReader *OpenWadReader(const char *filename)
+{
+	if (sizeof(void *) >= 8)
+	{
+		MappedFileReader *mapped = new MappedFileReader;
+		if (mapped->Open(filename)) return mapped;
+		delete mapped;
+	}
+	return new FileReader(filename);
+}
+
+//==========================================================================
+//
+// PrepareFile
+//
+// Opens a file and reads its directory. This runs on worker threads, so
+// all output is captured for AddFile to print later. Anything that cannot
+// be opened is left alone so that AddFile can report it as usual.
+//
+//==========================================================================
+
+static void PrepareFile(const char *filename, FPreparedWadFile &prepared)
+{
+	bool isdir;
+
+	if (!DirEntryExists(filename, &isdir) || isdir)
+	{
+		return;
+	}
+	try
+	{
+		prepared.Reader = OpenWadReader(filename);
+	}
+	catch (CRecoverableError &)
+	{
+		return;
+	}
+
+	C_CaptureOutput(&prepared.Output);
+	try
+	{
+		prepared.ResFile = FResourceFile::OpenResourceFile(filename, prepared.Reader);
+	}
+	catch (...)
+	{
+		prepared.Error = std::current_exception();
+	}
+	C_CaptureOutput(NULL);
+	prepared.Ready = true;
+}
+
 //==========================================================================
 //
 // W_AddFile
@@ -225,12 +362,20 @@ int FWadCollection::AddExternalFile(const char *filename)
 // [RH] Removed reload hack
 //==========================================================================
 
-void FWadCollection::AddFile (const char *filename, FileReader *wadinfo)
+void FWadCollection::AddFile (const char *filename, FileReader *wadinfo, FPreparedWadFile *prepared)
 {
 	int startlump;
 	bool isdir = false;
 
-	if (wadinfo == NULL)
+	if (prepared != NULL && !prepared->Ready)
+	{
+		prepared = NULL;
+	}
+	if (prepared != NULL)
+	{
+		wadinfo = prepared->Reader;
+	}
+	else if (wadinfo == NULL)
 	{
 		// Does this exist? If so, is it a directory?
 		if (!DirEntryExists(filename, &isdir))
@@ -244,7 +389,7 @@ void FWadCollection::AddFile (const char *filename, FileReader *wadinfo)
 		{
 			try
 			{
-				wadinfo = new FileReader(filename);
+				wadinfo = OpenWadReader(filename);
 			}
 			catch (CRecoverableError &err)
 			{ // Didn't find file
@@ -260,7 +405,18 @@ void FWadCollection::AddFile (const char *filename, FileReader *wadinfo)
 
 	FResourceFile *resfile;
 	
-	if (!isdir)
+	if (prepared != NULL)
+	{
+		C_ReplayOutput(prepared->Output);
+		if (prepared->Error) std::rethrow_exception(prepared->Error);
+		resfile = prepared->ResFile;
+		if (resfile != NULL)
+		{
+			prepared->ResFile = NULL;
+			prepared->Reader = NULL;
+		}
+	}
+	else if (!isdir)
 		resfile = FResourceFile::OpenResourceFile(filename, wadinfo);
 	else
 		resfile = FResourceFile::OpenDirectory(filename);
@@ -1295,6 +1451,40 @@ FMemLump FWadCollection::ReadLump (int lump)
 	return FMemLump(FString(ELumpNum(lump)));
 }
 
+//==========================================================================
+//
+// MapLump
+//
+// Like ReadLump, but if the lump's data is permanently held in memory, e.g.
+// because its file is memory mapped, the returned FMemLump points directly
+// at it. In that case the data is read-only and not null-terminated, so
+// this must only be used for binary lumps whose size is taken from GetSize.
+//
+//==========================================================================
+
+FMemLump FWadCollection::MapLump (int lump)
+{
+	if ((unsigned)lump >= (unsigned)LumpInfo.Size())
+	{
+		I_Error ("W_MapLump: %u >= NumLumps", lump);
+	}
+
+	FResourceLump *l = LumpInfo[lump].lump;
+	if (l->LumpSize > 0)
+	{
+		const char *data = (const char *)l->CacheLump();
+		if (l->RefCount < 0)
+		{
+			// Such a cache is never released and lives as long as the collection.
+			return FMemLump(data, l->LumpSize);
+		}
+		FMemLump copy(FString(data, l->LumpSize));
+		l->ReleaseCache();
+		return copy;
+	}
+	return ReadLump(lump);
+}
+
 DEFINE_ACTION_FUNCTION(_Wads, ReadLump)
 {
 	PARAM_PROLOGUE;
@@ -1639,22 +1829,32 @@ char *FWadLump::Gets(char *strbuf, int len)
 // FMemLump -----------------------------------------------------------------
 
 FMemLump::FMemLump ()
+: View(NULL), ViewSize(0)
 {
 }
 
 FMemLump::FMemLump (const FMemLump &copy)
 {
 	Block = copy.Block;
+	View = copy.View;
+	ViewSize = copy.ViewSize;
 }
 
 FMemLump &FMemLump::operator = (const FMemLump &copy)
 {
 	Block = copy.Block;
+	View = copy.View;
+	ViewSize = copy.ViewSize;
 	return *this;
 }
 
 FMemLump::FMemLump (const FString &source)
-: Block (source)
+: Block (source), View(NULL), ViewSize(0)
+{
+}
+
+FMemLump::FMemLump (const char *view, size_t size)
+: View(view), ViewSize(size)
 {
 }
 
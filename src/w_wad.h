@@ -115,18 +115,25 @@ public:
 	FMemLump (const FMemLump &copy);
 	FMemLump &operator= (const FMemLump &copy);
 	~FMemLump ();
-	void *GetMem () { return Block.Len() == 0 ? NULL : (void *)Block.GetChars(); }
-	size_t GetSize () { return Block.Len(); }
-	FString GetString () { return Block; }
+	void *GetMem () { return View != NULL ? (void *)View : Block.Len() == 0 ? NULL : (void *)Block.GetChars(); }
+	size_t GetSize () { return View != NULL ? ViewSize : Block.Len(); }
+	FString GetString () { return View != NULL ? FString(View, ViewSize) : Block; }
 
 private:
 	FMemLump (const FString &source);
+	FMemLump (const char *view, size_t size);
 
 	FString Block;
 
+	// Set if this points directly at a memory mapped lump instead of owning a copy.
+	const char *View;
+	size_t ViewSize;
+
 	friend class FWadCollection;
 };
 
+struct FPreparedWadFile;
+
 class FWadCollection
 {
 public:
@@ -138,7 +145,7 @@ public:
 	void SetIwadNum(int x) { IwadIndex = x; }
 
 	void InitMultipleFiles (TArray<FString> &filenames);
-	void AddFile (const char *filename, FileReader *wadinfo = NULL);
+	void AddFile (const char *filename, FileReader *wadinfo = NULL, FPreparedWadFile *prepared = NULL);
 	int CheckIfWadLoaded (const char *name);
 
 	const char *GetWadName (int wadnum) const;
@@ -175,6 +182,8 @@ public:
 	void ReadLump (int lump, void *dest);
 	FMemLump ReadLump (int lump);
 	FMemLump ReadLump (const char *name) { return ReadLump (GetNumForName (name)); }
+	FMemLump MapLump (int lump);
+	FMemLump MapLump (const char *name) { return MapLump (GetNumForName (name)); }
 
 	FWadLump OpenLumpNum (int lump);
 	FWadLump OpenLumpName (const char *name) { return OpenLumpNum (GetNumForName (name)); }
@@ -234,6 +243,7 @@ private:
 	void RenameSprites();
 	void RenameNerve();
 	void FixMacHexen();
+	void PrefetchStartupLumps();
 	void DeleteAll();
 };
 
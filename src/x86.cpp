@@ -70,12 +70,38 @@ void DumpCPUInfo(const CPUInfo *cpu)
 #define __cpuid(output, func) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
 	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func));
 #endif
+
+// Same as above, but with a sub-leaf in ECX
+#if defined(__i386__) && defined(__PIC__)
+#define __cpuidex(output, func, subfunc) \
+	__asm__ __volatile__("xchgl\t%%ebx, %1\n\t" \
+						 "cpuid\n\t" \
+						 "xchgl\t%%ebx, %1\n\t" \
+		: "=a" ((output)[0]), "=r" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) \
+		: "a" (func), "c" (subfunc));
+#else
+#define __cpuidex(output, func, subfunc) __asm__ __volatile__("cpuid" : "=a" ((output)[0]),\
+	"=b" ((output)[1]), "=c" ((output)[2]), "=d" ((output)[3]) : "a" (func), "c" (subfunc));
+#endif
+
+// Returns the low half of XCR0. Encoded by hand for assemblers that predate XSAVE.
+static inline unsigned int ReadXCR0()
+{
+	unsigned int lo, hi;
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0));
+	return lo;
+}
+#else
+static inline unsigned int ReadXCR0()
+{
+	return (unsigned int)_xgetbv(0);
+}
 #endif
 
 void CheckCPUID(CPUInfo *cpu)
 {
 	int foo[4];
-	unsigned int maxext;
+	unsigned int maxstd, maxext;
 
 	memset(cpu, 0, sizeof(*cpu));
 
@@ -127,6 +153,7 @@ haveid:
 
 	// Get vendor ID
 	__cpuid(foo, 0);
+	maxstd = (unsigned int)foo[0];
 	cpu->dwVendorID[0] = foo[1];
 	cpu->dwVendorID[1] = foo[3];
 	cpu->dwVendorID[2] = foo[2];
@@ -163,6 +190,18 @@ haveid:
 		cpu->Model |= (foo[0] >> 12) & 0xF0;
 	}
 
+	// AVX needs both the CPU and the OS, which must save the YMM state on context switches.
+	if ((foo[2] & (1 << 27)) && (foo[2] & (1 << 28)) && (ReadXCR0() & 6) == 6)
+	{
+		cpu->bAVX = true;
+
+		if (maxstd >= 7)
+		{
+			__cpuidex(foo, 7, 0);
+			cpu->bAVX2 = (foo[1] & (1 << 5)) != 0;
+		}
+	}
+
 	// Check for extended functions.
 	__cpuid(foo, 0x80000000);
 	maxext = (unsigned int)foo[0];
@@ -249,6 +288,8 @@ void DumpCPUInfo(const CPUInfo *cpu)
 		if (cpu->bSSSE3)		Printf(" SSSE3");
 		if (cpu->bSSE41)		Printf(" SSE4.1");
 		if (cpu->bSSE42)		Printf(" SSE4.2");
+		if (cpu->bAVX)			Printf(" AVX");
+		if (cpu->bAVX2)			Printf(" AVX2");
 		if (cpu->b3DNow)		Printf(" 3DNow!");
 		if (cpu->b3DNowPlus)	Printf(" 3DNow!+");
 		Printf ("\n");
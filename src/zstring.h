@@ -75,28 +75,8 @@ struct FStringData
 		return (const char *)(this + 1);
 	}
 
-	char *AddRef()
-	{
-		if (RefCount < 0)
-		{
-			return (char *)(MakeCopy() + 1);
-		}
-		else
-		{
-			RefCount++;
-			return (char *)(this + 1);
-		}
-	}
-
-	void Release()
-	{
-		assert (RefCount != 0);
-
-		if (--RefCount <= 0)
-		{
-			Dealloc();
-		}
-	}
+	char *AddRef();
+	void Release();
 
 	FStringData *MakeCopy();
 
@@ -329,7 +309,6 @@ protected:
 
 	void ResetToNull()
 	{
-		NullString.RefCount++;
 		Chars = &NullString.Nothing[0];
 	}
 
@@ -409,6 +388,31 @@ bool operator >  (FName, const FString &) = delete;
 bool operator <= (FName, const FString &) = delete;
 bool operator >= (FName, const FString &) = delete;
 
+// The null string's reference count is never touched so that empty strings
+// can be created and destroyed on multiple threads at once.
+inline char *FStringData::AddRef()
+{
+	if (RefCount < 0)
+	{
+		return (char *)(MakeCopy() + 1);
+	}
+	else
+	{
+		if (this != (FStringData *)&FString::NullString) RefCount++;
+		return (char *)(this + 1);
+	}
+}
+
+inline void FStringData::Release()
+{
+	assert (RefCount != 0);
+
+	if (this != (FStringData *)&FString::NullString && --RefCount <= 0)
+	{
+		Dealloc();
+	}
+}
+
 class FStringf : public FString
 {
 public: